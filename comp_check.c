@@ -0,0 +1,1608 @@
+/******************************************
+* Student name: Danny Perov
+* Student ID: 318810637
+* Course Exercise Group: 05
+* Exercise name: Exercise 1
+******************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "compare.h"
+
+//Checking the fast comparators against the byte-wise ones.
+#define SELF_CHECK_THREADS 8
+#define SELF_CHECK_MAX_LENGTH (2 * READ_BUFFER_SIZE + 64)
+#define SELF_CHECK_ROOM 64
+#define SELF_CHECK_MUTATIONS 11
+#define SELF_CHECK_GENERATED 5
+#define SELF_CHECK_ABS_EPSILON 0
+#define SELF_CHECK_REL_EPSILON 1e-6
+#define CHECK_REFERENCES 2
+#define COMPARATOR_COUNT 31
+#define OFFSET_UNKNOWN -2
+
+//Correct outputs the self check compresses, to check the decoders too.
+#define DECODER_NONE 0
+#define DECODER_ZSTD 1
+#define DECODER_LZ4 2
+#define DECODER_KINDS 3
+
+//An edge case with its texts' lengths, so the texts may hold null bytes.
+#define EDGE_CASE(name, text1, text2) \
+        {name, text1, sizeof(text1) - 1, text2, sizeof(text2) - 1}
+
+//Holds the files of a case the self check compares.
+typedef struct {
+
+    //The correct output, compressed for a comparator that reads a decoder.
+    char *fileName1;
+
+    //The student's output.
+    char *fileName2;
+
+    //The correct outputs searched together, a decoy before the first file.
+    char *references[CHECK_REFERENCES];
+
+    //Threads to compare with.
+    int threadCount;
+
+    //Offset of the first difference the comparator found, -1 if none,
+    //OFFSET_UNKNOWN if the comparator does not find it.
+    long long offset;
+} CheckCase;
+
+//Holds a comparator the self check runs, the first ones are the oracles.
+typedef struct {
+
+    //Name in the summary.
+    char *name;
+
+    //Index of the oracle the comparator must agree with, its own for an
+    //oracle.
+    int oracle;
+
+    //Decoder the correct output is read through, DECODER_NONE for none.
+    int decoder;
+
+    //The comparison. Fills the case's offset if the comparator finds it.
+    int (*compare)(CheckCase *);
+} Comparator;
+
+//Holds a line the lines oracle sorts.
+typedef struct {
+
+    //The line's first byte in the loaded file.
+    unsigned char *text;
+
+    //The line's length without the newline.
+    long length;
+} Line;
+
+//Holds a pair of texts the self check always compares.
+typedef struct {
+
+    //What the case checks.
+    char *name;
+
+    //The texts and their lengths.
+    char *text1;
+    long length1;
+    char *text2;
+    long length2;
+} EdgeCase;
+
+/**
+ * function name: RunSelfCheck.
+ * The input: amount of random cases, seed.
+ * The output: 0 if every comparator agreed with its oracle, else
+ * COMPARE_FAILED.
+ * The function operation: Writes the edge cases and the random cases to
+ * files, compresses the correct output with zstd and lz4 when they are
+ * installed, and runs every comparator on them. A verdict that differs
+ * from the oracle's, or an offset that differs from the first one found
+ * against that oracle, is printed and the case's files are kept. Prints
+ * how long every comparator took and how many times faster than its oracle
+ * it is.
+*/
+int RunSelfCheck(int caseCount, unsigned int seed);
+
+/**
+ * function name: MakeCase.
+ * The input: case index, threads of the case, seed, texts and lengths to
+ * fill.
+ * The output: what the case checks.
+ * The function operation: The first cases are the edge cases, then cases
+ * with a difference at a read buffer's boundary and tokens that fill the
+ * token buffer. The rest are a random text and a random mutation of it.
+*/
+char *MakeCase(int caseIndex, int threadCount, unsigned int *seed,
+               unsigned char *text1, long *length1, unsigned char *text2,
+               long *length2);
+
+/**
+ * function name: MakeDecoy.
+ * The input: student's text and length, decoy and length to fill, threads
+ * of the case, seed.
+ * The output: void.
+ * The function operation: Makes the correct output searched before the
+ * case's one. It is a copy of the student's text, a copy with a changed
+ * byte, a prefix of it or an unrelated text.
+*/
+void MakeDecoy(unsigned char *text2, long length2, unsigned char *decoy,
+               long *decoyLength, int threadCount, unsigned int *seed);
+
+/**
+ * function name: InsertText.
+ * The input: text, its length, position, string to insert.
+ * The output: void.
+ * The function operation: Moves the text from the position on and copies
+ * the string in.
+*/
+void InsertText(unsigned char *text, long *length, long position,
+                char *insert);
+
+/**
+ * function name: RandomText.
+ * The input: text to fill, seed.
+ * The output: the text's length.
+ * The function operation: Mostly short texts, some longer than two read
+ * buffers.
+*/
+long RandomText(unsigned char *text, unsigned int *seed);
+
+/**
+ * function name: RandomByte.
+ * The input: seed.
+ * The output: a byte.
+ * The function operation: Picks letters of both cases, digits, every kind
+ * of whitespace, high bytes, punctuation and null bytes.
+*/
+unsigned char RandomByte(unsigned int *seed);
+
+/**
+ * function name: PickPosition.
+ * The input: text length, threads of the case, seed.
+ * The output: a position in the text, 0 for an empty one.
+ * The function operation: Picks a random position, one next to a chunk's
+ * or a read buffer's boundary, or the first or last byte.
+*/
+long PickPosition(long length, int threadCount, unsigned int *seed);
+
+/**
+ * function name: WriteCase.
+ * The input: file path, text, length.
+ * The output: void.
+ * The function operation: Writes the text over the file.
+*/
+void WriteCase(char *fileName, unsigned char *text, long length);
+
+/**
+ * function name: CompressCase.
+ * The input: file path, compressor, compressed file path.
+ * The output: 1 if the file was compressed, else 0.
+ * The function operation: Runs the compressor from the file to the
+ * compressed file. Fails when the compressor is not installed.
+*/
+int CompressCase(char *fileName, char *command, char *compressedName);
+
+/**
+ * function name: NowMicros.
+ * The input: void.
+ * The output: monotonic time in microseconds.
+ * The function operation: Reads the monotonic clock.
+*/
+long long NowMicros(void);
+
+/**
+ * function name: IsLoadedTokensEqual.
+ * The input: file path, file path, boolean compare numbers.
+ * The output: 1 if the files have the same tokens, else 0.
+ * The function operation: Loads both files and compares their tokens
+ * whole. Tokens that do not fit the token buffer are never compared as
+ * numbers, like in the streaming comparison.
+*/
+int IsLoadedTokensEqual(char *fileName1, char *fileName2, int isNumeric);
+
+/**
+ * function name: IsLoadedLinesEqual.
+ * The input: file path, file path.
+ * The output: 1 if the files have the same lines in any order, else 0.
+ * The function operation: Loads both files, sorts their lines and compares
+ * them one by one.
+*/
+int IsLoadedLinesEqual(char *fileName1, char *fileName2);
+
+/**
+ * function name: SplitLines.
+ * The input: text, length, amount of lines to fill.
+ * The output: the text's lines.
+ * The function operation: Splits the text at the newlines. A last line
+ * without a newline is a line too unless it is empty.
+*/
+Line *SplitLines(unsigned char *text, long long length, long *count);
+
+/**
+ * function name: CompareLines.
+ * The input: line, line.
+ * The output: negative, 0 or positive as the first line sorts before, with
+ * or after the second.
+ * The function operation: Compares the common length's bytes, then the
+ * lengths.
+*/
+int CompareLines(const void *line1, const void *line2);
+
+/**
+ * function name: CheckIdenticalBytes.
+ * The input: case.
+ * The output: 1 if the files are identical, else 0.
+ * The function operation: Runs the byte-wise identity check.
+*/
+int CheckIdenticalBytes(CheckCase *checkCase);
+
+/**
+ * function name: CheckSimilarBytes.
+ * The input: case.
+ * The output: 1 if the files are similar, else 0.
+ * The function operation: Runs the byte-wise similarity check.
+*/
+int CheckSimilarBytes(CheckCase *checkCase);
+
+/**
+ * function name: CheckDecoyBytes.
+ * The input: case.
+ * The output: index of the first identical correct output, -1 if none is.
+ * The function operation: Runs the byte-wise identity check on every
+ * correct output in turn.
+*/
+int CheckDecoyBytes(CheckCase *checkCase);
+
+/**
+ * function name: CheckSimilarDecoyBytes.
+ * The input: case.
+ * The output: index of the first similar correct output, -1 if none is.
+ * The function operation: Runs the byte-wise similarity check on every
+ * correct output in turn.
+*/
+int CheckSimilarDecoyBytes(CheckCase *checkCase);
+
+/**
+ * function name: CheckTokenDecoyOracle.
+ * The input: case.
+ * The output: index of the first correct output with the same tokens, -1 if
+ * none has.
+ * The function operation: Compares the loaded files' tokens with every
+ * correct output in turn.
+*/
+int CheckTokenDecoyOracle(CheckCase *checkCase);
+
+/**
+ * function name: CheckTokenOracle.
+ * The input: case.
+ * The output: 1 if the files have the same tokens, else 0.
+ * The function operation: Compares the loaded files' tokens.
+*/
+int CheckTokenOracle(CheckCase *checkCase);
+
+/**
+ * function name: CheckNumericOracle.
+ * The input: case.
+ * The output: 1 if the files have the same tokens or close numbers, else 0.
+ * The function operation: Compares the loaded files' tokens as numbers.
+*/
+int CheckNumericOracle(CheckCase *checkCase);
+
+/**
+ * function name: CheckLinesOracle.
+ * The input: case.
+ * The output: 1 if the files have the same lines in any order, else 0.
+ * The function operation: Compares the loaded files' sorted lines.
+*/
+int CheckLinesOracle(CheckCase *checkCase);
+
+/**
+ * function name: CheckSinglePass.
+ * The input: case, whose offset is filled.
+ * The output: 1 if the files are identical, else 0.
+ * The function operation: Runs the single pass with one correct output.
+*/
+int CheckSinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckReferenceChunks.
+ * The input: case, whose offset is filled.
+ * The output: 1 if the files are identical, else 0.
+ * The function operation: Runs the chunked search with one correct output.
+*/
+int CheckReferenceChunks(CheckCase *checkCase);
+
+/**
+ * function name: CheckIdenticalChunks.
+ * The input: case, whose offset is filled.
+ * The output: 1 if the files are identical, else 0.
+ * The function operation: Runs the chunked identity check.
+*/
+int CheckIdenticalChunks(CheckCase *checkCase);
+
+/**
+ * function name: CheckSimilarChunks.
+ * The input: case.
+ * The output: 1 if the files are similar, else 0.
+ * The function operation: Runs the chunked similarity check.
+*/
+int CheckSimilarChunks(CheckCase *checkCase);
+
+/**
+ * function name: CheckDecoySinglePass.
+ * The input: case, whose offset is filled.
+ * The output: index of the identical correct output, -1 if none is.
+ * The function operation: Runs the single pass with the decoy and the
+ * correct output.
+*/
+int CheckDecoySinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckDecoyChunks.
+ * The input: case, whose offset is filled.
+ * The output: index of the identical correct output, -1 if none is.
+ * The function operation: Runs the chunked search with the decoy and the
+ * correct output.
+*/
+int CheckDecoyChunks(CheckCase *checkCase);
+
+/**
+ * function name: CheckTokenMode.
+ * The input: case.
+ * The output: 1 if the files have the same tokens, else 0.
+ * The function operation: Runs the token mode.
+*/
+int CheckTokenMode(CheckCase *checkCase);
+
+/**
+ * function name: CheckNumericMode.
+ * The input: case.
+ * The output: 1 if the files have the same tokens or close numbers, else 0.
+ * The function operation: Runs the numeric mode.
+*/
+int CheckNumericMode(CheckCase *checkCase);
+
+/**
+ * function name: CheckLinesMode.
+ * The input: case.
+ * The output: 1 if the files have the same lines in any order, else 0.
+ * The function operation: Runs the lines mode.
+*/
+int CheckLinesMode(CheckCase *checkCase);
+
+/**
+ * function name: CheckSimilarSinglePass.
+ * The input: case.
+ * The output: 1 if the files are similar, else 0.
+ * The function operation: Runs the similar single pass with one correct
+ * output.
+*/
+int CheckSimilarSinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckSimilarDecoySinglePass.
+ * The input: case.
+ * The output: index of the first similar correct output, -1 if none is.
+ * The function operation: Runs the similar single pass with the decoy and
+ * the correct output.
+*/
+int CheckSimilarDecoySinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckTokenSinglePass.
+ * The input: case.
+ * The output: 1 if the files have the same tokens, else 0.
+ * The function operation: Runs the token mode's single pass with one
+ * correct output.
+*/
+int CheckTokenSinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckTokenDecoySinglePass.
+ * The input: case.
+ * The output: index of the first correct output with the same tokens, -1 if
+ * none has.
+ * The function operation: Runs the token mode's single pass with the decoy
+ * and the correct output.
+*/
+int CheckTokenDecoySinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckNumericSinglePass.
+ * The input: case.
+ * The output: 1 if the files have the same tokens or close numbers, else 0.
+ * The function operation: Runs the numeric mode's single pass with one
+ * correct output.
+*/
+int CheckNumericSinglePass(CheckCase *checkCase);
+
+/**
+ * function name: CheckLinesSinglePass.
+ * The input: case.
+ * The output: 1 if the files have the same lines in any order, else 0.
+ * The function operation: Runs the lines mode's single pass with one
+ * correct output.
+*/
+int CheckLinesSinglePass(CheckCase *checkCase);
+
+//The comparators the self check runs. The byte-wise ones and the loaded
+//files' ones are the oracles, every other one is checked against one.
+static Comparator comparators[COMPARATOR_COUNT] = {
+        {"identical byte-wise", 0, DECODER_NONE, CheckIdenticalBytes},
+        {"similar byte-wise", 1, DECODER_NONE, CheckSimilarBytes},
+        {"decoy byte-wise", 2, DECODER_NONE, CheckDecoyBytes},
+        {"token loaded", 3, DECODER_NONE, CheckTokenOracle},
+        {"numeric loaded", 4, DECODER_NONE, CheckNumericOracle},
+        {"lines loaded", 5, DECODER_NONE, CheckLinesOracle},
+        {"similar decoy byte-wise", 6, DECODER_NONE, CheckSimilarDecoyBytes},
+        {"token decoy loaded", 7, DECODER_NONE, CheckTokenDecoyOracle},
+        {"identical one pass", 0, DECODER_NONE, CheckSinglePass},
+        {"identical references chunked", 0, DECODER_NONE, CheckReferenceChunks},
+        {"identical chunked", 0, DECODER_NONE, CheckIdenticalChunks},
+        {"similar chunked", 1, DECODER_NONE, CheckSimilarChunks},
+        {"decoy one pass", 2, DECODER_NONE, CheckDecoySinglePass},
+        {"decoy chunked", 2, DECODER_NONE, CheckDecoyChunks},
+        {"token mode", 3, DECODER_NONE, CheckTokenMode},
+        {"numeric mode", 4, DECODER_NONE, CheckNumericMode},
+        {"lines mode", 5, DECODER_NONE, CheckLinesMode},
+        {"identical one pass zstd", 0, DECODER_ZSTD, CheckSinglePass},
+        {"similar byte-wise zstd", 1, DECODER_ZSTD, CheckSimilarBytes},
+        {"decoy one pass zstd", 2, DECODER_ZSTD, CheckDecoySinglePass},
+        {"identical one pass lz4", 0, DECODER_LZ4, CheckSinglePass},
+        {"token mode lz4", 3, DECODER_LZ4, CheckTokenMode},
+        {"lines mode lz4", 5, DECODER_LZ4, CheckLinesMode},
+        {"similar one pass", 1, DECODER_NONE, CheckSimilarSinglePass},
+        {"similar decoy one pass", 6, DECODER_NONE,
+         CheckSimilarDecoySinglePass},
+        {"token one pass", 3, DECODER_NONE, CheckTokenSinglePass},
+        {"token decoy one pass", 7, DECODER_NONE, CheckTokenDecoySinglePass},
+        {"numeric one pass", 4, DECODER_NONE, CheckNumericSinglePass},
+        {"lines one pass", 5, DECODER_NONE, CheckLinesSinglePass},
+        {"similar decoy one pass zstd", 6, DECODER_ZSTD,
+         CheckSimilarDecoySinglePass},
+        {"token decoy one pass lz4", 7, DECODER_LZ4,
+         CheckTokenDecoySinglePass}};
+
+//The compressors of the decoders the self check reads through, and the
+//suffixes the decoders are picked by.
+static char *compressors[DECODER_KINDS] = {0, "zstd", "lz4"};
+static char *suffixes[DECODER_KINDS]    = {"", ".zst", ".lz4"};
+
+//The pairs the self check compares before the random ones.
+static EdgeCase edgeCases[] = {
+        EDGE_CASE("empty files", "", ""),
+        EDGE_CASE("empty and newline", "", "\n"),
+        EDGE_CASE("empty and whitespace", "", " \t\n"),
+        EDGE_CASE("whitespace only", " \n\t", "\r\n\v\f "),
+        EDGE_CASE("empty and a letter", "", "a"),
+        EDGE_CASE("a letter and empty", "a", ""),
+        EDGE_CASE("trailing newline added", "abc", "abc\n"),
+        EDGE_CASE("trailing newline doubled", "abc\n", "abc\n\n"),
+        EDGE_CASE("trailing newline removed", "abc\n", "abc"),
+        EDGE_CASE("last byte repeated", "ab", "abb"),
+        EDGE_CASE("last byte dropped", "abb", "ab"),
+        EDGE_CASE("case changed", "Hello World\n", "hello world\n"),
+        EDGE_CASE("space removed", "a b", "ab"),
+        EDGE_CASE("space to tab", "a b\n", "a\tb\n"),
+        EDGE_CASE("high bytes", "\xff\xfe\x80", "\xff\xfe\x80"),
+        EDGE_CASE("high bytes changed", "\xff\xfe\x80", "\xff\xfe\x81"),
+        EDGE_CASE("high letters' case", "\xc9t\xe9", "\xe9t\xc9"),
+        EDGE_CASE("non breaking space", "x\xa0y", "xy"),
+        EDGE_CASE("null bytes", "a\0b", "a\0b"),
+        EDGE_CASE("null byte changed", "a\0b", "a\0c"),
+        EDGE_CASE("null byte to space", "a\0b", "a b"),
+        EDGE_CASE("first byte", "xbc", "abc"),
+        EDGE_CASE("numbers written apart", "1.5 2\n", "1.50 2e0\n"),
+        EDGE_CASE("numbers close", "0.1 100", "0.1000001 100.00001"),
+        EDGE_CASE("numbers apart", "1.5", "1.6"),
+        EDGE_CASE("number and word", "5", "five"),
+        EDGE_CASE("number and suffix", "5", "5x"),
+        EDGE_CASE("infinities", "inf -inf", "INF -Infinity"),
+        EDGE_CASE("lines reordered", "a\nb\n", "b\na\n"),
+        EDGE_CASE("last line without newline", "a\nb", "b\na\n"),
+        EDGE_CASE("empty line moved", "a\n\nb\n", "\na\nb\n"),
+        EDGE_CASE("empty line added", "a\n", "a\n\n"),
+        EDGE_CASE("line repeated", "a\na\nb\n", "a\nb\nb\n")};
+
+int main(int argc, char *argv[]) {
+
+    //Variable declarations.
+    int      caseCount;
+    unsigned seed = (unsigned) time(0) ^ (unsigned) getpid();
+
+    //Check that the number of parameters is correct, the seed is optional.
+    if (argc != 2 && (argc != 4 || strcmp(argv[2], "--seed") != 0)) {
+
+        fprintf(stderr, "Error: usage is %s cases [--seed seed].\n",
+                argv[0]);
+
+        return COMPARE_FAILED;
+    }
+
+    caseCount = atoi(argv[1]);
+
+    if (argc == 4) {
+
+        seed = (unsigned) strtoul(argv[3], 0, 10);
+    }
+
+    return RunSelfCheck(caseCount, seed);
+}
+
+int RunSelfCheck(int caseCount, unsigned int seed) {
+
+    //Variable declarations.
+    char          directory[] = "comp_check_XXXXXX";
+    char          fileName1[64];
+    char          fileName2[64];
+    char          decoyName[64];
+    char          compressedNames[DECODER_KINDS][64];
+    char          keptName[96];
+    char          *name;
+    int           caseIndex;
+    int           total;
+    int           comparator;
+    int           oracle;
+    int           decoder;
+    int           finder;
+    int           isDifferent;
+    int           failures   = 0;
+    unsigned int  firstSeed  = seed;
+    int           isDecoder[DECODER_KINDS] = {1, 1, 1};
+    int           isRun[COMPARATOR_COUNT];
+    int           verdicts[COMPARATOR_COUNT];
+    int           finders[COMPARATOR_COUNT];
+    int           runs[COMPARATOR_COUNT]        = {0};
+    int           differences[COMPARATOR_COUNT] = {0};
+    long          length1;
+    long          length2;
+    long          decoyLength;
+    long long     start;
+    long long     offsets[COMPARATOR_COUNT];
+    long long     micros[COMPARATOR_COUNT]      = {0};
+    unsigned char *text1;
+    unsigned char *text2;
+    unsigned char *decoy;
+    CheckCase     checkCase;
+
+    text1 = (unsigned char *) malloc(SELF_CHECK_MAX_LENGTH + SELF_CHECK_ROOM);
+    text2 = (unsigned char *) malloc(SELF_CHECK_MAX_LENGTH + SELF_CHECK_ROOM);
+    decoy = (unsigned char *) malloc(SELF_CHECK_MAX_LENGTH + SELF_CHECK_ROOM);
+
+    //Check if allocation worked.
+    if (text1 == 0 || text2 == 0 || decoy == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Check if the cases' directory was made.
+    if (mkdtemp(directory) == 0) {
+
+        perror("Error: failed to create directory.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    sprintf(fileName1, "%s/first", directory);
+    sprintf(fileName2, "%s/second", directory);
+    sprintf(decoyName, "%s/decoy", directory);
+
+    for (decoder = 0; decoder < DECODER_KINDS; decoder++) {
+
+        sprintf(compressedNames[decoder], "%s/first%s", directory,
+                suffixes[decoder]);
+    }
+
+    checkCase.fileName2     = fileName2;
+    checkCase.references[0] = decoyName;
+    total = (int) (sizeof(edgeCases) / sizeof(EdgeCase)) +
+            SELF_CHECK_GENERATED + caseCount;
+
+    for (caseIndex = 0; caseIndex < total; caseIndex++) {
+
+        //Every amount of threads moves the chunks' boundaries elsewhere.
+        checkCase.threadCount = 1 + caseIndex % SELF_CHECK_THREADS;
+        name = MakeCase(caseIndex, checkCase.threadCount, &seed, text1,
+                        &length1, text2, &length2);
+        MakeDecoy(text2, length2, decoy, &decoyLength, checkCase.threadCount,
+                  &seed);
+        WriteCase(fileName1, text1, length1);
+        WriteCase(fileName2, text2, length2);
+        WriteCase(decoyName, decoy, decoyLength);
+        isDifferent = 0;
+
+        for (decoder = DECODER_NONE + 1; decoder < DECODER_KINDS; decoder++) {
+
+            //Check if the compressor is still there, else skip its decoder.
+            if (isDecoder[decoder] &&
+                !CompressCase(fileName1, compressors[decoder],
+                              compressedNames[decoder])) {
+
+                fprintf(stderr, "Warning: %s failed, its comparators are "
+                                "skipped.\n", compressors[decoder]);
+                isDecoder[decoder] = 0;
+            }
+        }
+
+        for (comparator = 0; comparator < COMPARATOR_COUNT; comparator++) {
+
+            decoder             = comparators[comparator].decoder;
+            isRun[comparator]   = isDecoder[decoder];
+            offsets[comparator] = OFFSET_UNKNOWN;
+
+            //Check if the comparator's decoder is missing.
+            if (!isRun[comparator]) {
+                continue;
+            }
+
+            //Read the correct output through the comparator's decoder.
+            checkCase.fileName1     = compressedNames[decoder];
+            checkCase.references[1] = compressedNames[decoder];
+
+            checkCase.offset     = OFFSET_UNKNOWN;
+            start                = NowMicros();
+            verdicts[comparator] = comparators[comparator].compare(&checkCase);
+            micros[comparator]  += NowMicros() - start;
+            offsets[comparator]  = checkCase.offset;
+            runs[comparator]++;
+        }
+
+        //Every comparator of an oracle must find the offset the first one
+        //that finds an offset does.
+        for (comparator = 0; comparator < COMPARATOR_COUNT; comparator++) {
+
+            finders[comparator] = -1;
+        }
+
+        for (comparator = 0; comparator < COMPARATOR_COUNT; comparator++) {
+
+            oracle = comparators[comparator].oracle;
+
+            if (isRun[comparator] && finders[oracle] < 0 &&
+                offsets[comparator] != OFFSET_UNKNOWN) {
+
+                finders[oracle] = comparator;
+            }
+        }
+
+        for (comparator = 0; comparator < COMPARATOR_COUNT; comparator++) {
+
+            oracle = comparators[comparator].oracle;
+            finder = finders[oracle];
+
+            //Check if the comparator agrees with its oracle, and on where
+            //the files differ with the first one that found it.
+            if (!isRun[comparator] ||
+                (verdicts[comparator] == verdicts[oracle] &&
+                 (offsets[comparator] == OFFSET_UNKNOWN ||
+                  offsets[comparator] == offsets[finder]))) {
+                continue;
+            }
+
+            fprintf(stderr, "Error: case %d (%s, %d threads): %s says %d "
+                            "at %lld, %s says %d, %s at %lld.\n",
+                    caseIndex, name, checkCase.threadCount,
+                    comparators[comparator].name, verdicts[comparator],
+                    offsets[comparator], comparators[oracle].name,
+                    verdicts[oracle],
+                    finder >= 0 ? comparators[finder].name : "none",
+                    finder >= 0 ? offsets[finder] : OFFSET_UNKNOWN);
+            differences[comparator]++;
+            isDifferent = 1;
+        }
+
+        //Keep the failing case's files, the next case writes over them.
+        if (isDifferent) {
+
+            failures++;
+            sprintf(keptName, "%s/case%d.1", directory, caseIndex);
+            rename(fileName1, keptName);
+            sprintf(keptName, "%s/case%d.2", directory, caseIndex);
+            rename(fileName2, keptName);
+            sprintf(keptName, "%s/case%d.decoy", directory, caseIndex);
+            rename(decoyName, keptName);
+        }
+    }
+
+    printf("%d cases, seed %u\n", total, firstSeed);
+
+    for (comparator = 0; comparator < COMPARATOR_COUNT; comparator++) {
+
+        oracle = comparators[comparator].oracle;
+
+        //Check if the comparator's decoder was missing from the start.
+        if (runs[comparator] == 0) {
+
+            printf("%-30s skipped\n", comparators[comparator].name);
+            continue;
+        }
+
+        printf("%-30s %6d differences %10.1f ms %8.1fx\n",
+               comparators[comparator].name, differences[comparator],
+               micros[comparator] / 1000.0, (double) micros[oracle] /
+               (double) (micros[comparator] > 0 ? micros[comparator] : 1));
+    }
+
+    unlink(fileName1);
+    unlink(fileName2);
+    unlink(decoyName);
+
+    for (decoder = DECODER_NONE + 1; decoder < DECODER_KINDS; decoder++) {
+
+        unlink(compressedNames[decoder]);
+    }
+
+    //The directory is only empty if no case failed.
+    if (failures > 0) {
+
+        fprintf(stderr, "Error: %d cases failed, they are kept in %s.\n",
+                failures, directory);
+    } else {
+
+        rmdir(directory);
+    }
+
+    free(text1);
+    free(text2);
+    free(decoy);
+
+    return failures > 0 ? COMPARE_FAILED : 0;
+}
+
+char *MakeCase(int caseIndex, int threadCount, unsigned int *seed,
+               unsigned char *text1, long *length1, unsigned char *text2,
+               long *length2) {
+
+    //Variable declarations.
+    int  edgeCount = (int) (sizeof(edgeCases) / sizeof(EdgeCase));
+    int  number;
+    int  kind;
+    char number1[32];
+    char number2[32];
+    long position;
+    long index;
+    long start;
+    long end;
+
+    //Check if the case is an edge case.
+    if (caseIndex < edgeCount) {
+
+        *length1 = edgeCases[caseIndex].length1;
+        *length2 = edgeCases[caseIndex].length2;
+        memcpy(text1, edgeCases[caseIndex].text1, (size_t) *length1);
+        memcpy(text2, edgeCases[caseIndex].text2, (size_t) *length2);
+
+        return edgeCases[caseIndex].name;
+    }
+
+    //Check if the case differs at a read buffer's boundary.
+    if (caseIndex < edgeCount + SELF_CHECK_GENERATED - 2) {
+
+        *length1 = 2 * READ_BUFFER_SIZE + 1;
+        *length2 = *length1;
+        memset(text1, 'a', (size_t) *length1);
+        memcpy(text2, text1, (size_t) *length1);
+        text2[READ_BUFFER_SIZE - 1 + caseIndex - edgeCount] = 'A';
+
+        return "read buffer boundary";
+    }
+
+    //Check if the case ends with a token that fills the token buffer.
+    if (caseIndex < edgeCount + SELF_CHECK_GENERATED - 1) {
+
+        *length1 = TOKEN_SIZE - 1;
+        *length2 = *length1;
+        memset(text1, 'x', (size_t) *length1);
+        memcpy(text2, text1, (size_t) *length1);
+        text2[(*length2)++] = '\n';
+
+        return "token filling the buffer";
+    }
+
+    //Check if the case is a token going on past the token buffer with what
+    //would be close numbers on their own.
+    if (caseIndex < edgeCount + SELF_CHECK_GENERATED) {
+
+        *length1 = TOKEN_SIZE - 1;
+        *length2 = *length1;
+        memset(text1, 'x', (size_t) *length1);
+        memcpy(text2, text1, (size_t) *length1);
+        InsertText(text1, length1, *length1, "5");
+        InsertText(text2, length2, *length2, "5.0");
+
+        return "number past the token buffer";
+    }
+
+    *length1 = RandomText(text1, seed);
+    *length2 = *length1;
+    memcpy(text2, text1, (size_t) *length1);
+    position = PickPosition(*length1, threadCount, seed);
+
+    switch (rand_r(seed) % SELF_CHECK_MUTATIONS) {
+
+        case 1:
+
+            //Flip the case of the first letter from the position on.
+            for (index = position; index < *length2; index++) {
+
+                if (isalpha(text2[index])) {
+
+                    text2[index] ^= 'a' ^ 'A';
+                    break;
+                }
+            }
+
+            return "case changed";
+        case 2:
+
+            memmove(text2 + position + 1, text2 + position,
+                    (size_t) (*length2 - position));
+            text2[position] = " \n\t\r"[rand_r(seed) % 4];
+            (*length2)++;
+
+            return "whitespace inserted";
+        case 3:
+
+            if (*length2 > 0) {
+
+                memmove(text2 + position, text2 + position + 1,
+                        (size_t) (*length2 - position - 1));
+                (*length2)--;
+            }
+
+            return "byte removed";
+        case 4:
+
+            if (*length2 > 0) {
+
+                text2[position] = (unsigned char) (text2[position] + 1 +
+                                                   rand_r(seed) % 255);
+            }
+
+            return "byte changed";
+        case 5:
+
+            if (*length2 > 0 && text2[*length2 - 1] == '\n') {
+
+                (*length2)--;
+            } else {
+
+                text2[(*length2)++] = '\n';
+            }
+
+            return "trailing newline";
+        case 6:
+
+            if (*length2 > 0) {
+
+                text2[*length2] = text2[*length2 - 1];
+                (*length2)++;
+            }
+
+            return "last byte repeated";
+        case 7:
+
+            for (index = 0; index < *length2; index++) {
+
+                text2[index] = RandomByte(seed);
+            }
+
+            return "unrelated texts";
+        case 8:
+
+            //Keep only the whitespace, so neither text has anything else.
+            for (index = 0; index < *length1; index++) {
+
+                text1[index] = " \n\t\r\v\f"[rand_r(seed) % 6];
+                text2[index] = " \n\t\r\v\f"[rand_r(seed) % 6];
+            }
+
+            return "whitespace only";
+        case 9:
+
+            //Write a number the same, close or apart in each text.
+            number = rand_r(seed) % 1000;
+            sprintf(number1, " %d.5 ", number);
+            kind = rand_r(seed) % 3;
+
+            if (kind == 0) {
+
+                sprintf(number2, " %.3e ", number + 0.5);
+            } else if (kind == 1) {
+
+                sprintf(number2, " %d.5000001 ", number);
+            } else {
+
+                sprintf(number2, " %d.6 ", number);
+            }
+
+            InsertText(text1, length1, position, number1);
+            InsertText(text2, length2, position, number2);
+
+            return "number rewritten";
+        case 10:
+
+            //Check if the text has lines.
+            if (*length1 == 0) {
+
+                return "line moved";
+            }
+
+            //End the last line, so a moved line stays a line of its own.
+            if (text1[*length1 - 1] != '\n') {
+
+                text1[(*length1)++] = '\n';
+            }
+
+            //Find the line the position is in.
+            start = position;
+            end   = position;
+
+            while (start > 0 && text1[start - 1] != '\n') {
+
+                start--;
+            }
+
+            while (text1[end] != '\n') {
+
+                end++;
+            }
+
+            end++;
+
+            //Move the line to the end.
+            memcpy(text2, text1, (size_t) start);
+            memcpy(text2 + start, text1 + end, (size_t) (*length1 - end));
+            memcpy(text2 + start + *length1 - end, text1 + start,
+                   (size_t) (end - start));
+            *length2 = *length1;
+
+            return "line moved";
+        default:
+
+            return "copy";
+    }
+}
+
+void MakeDecoy(unsigned char *text2, long length2, unsigned char *decoy,
+               long *decoyLength, int threadCount, unsigned int *seed) {
+
+    //Variable declarations.
+    long position;
+
+    memcpy(decoy, text2, (size_t) length2);
+    *decoyLength = length2;
+    position     = PickPosition(length2, threadCount, seed);
+
+    switch (rand_r(seed) % 4) {
+
+        case 1:
+
+            if (length2 > 0) {
+
+                decoy[position] = (unsigned char) (decoy[position] + 1 +
+                                                   rand_r(seed) % 255);
+            }
+
+            break;
+        case 2:
+
+            *decoyLength = position;
+            break;
+        case 3:
+
+            *decoyLength = RandomText(decoy, seed);
+            break;
+        default:
+
+            //The decoy matches too, the first match is the one found.
+            break;
+    }
+}
+
+void InsertText(unsigned char *text, long *length, long position,
+                char *insert) {
+
+    //Variable declarations.
+    size_t insertLength = strlen(insert);
+
+    memmove(text + position + insertLength, text + position,
+            (size_t) (*length - position));
+    memcpy(text + position, insert, insertLength);
+    *length += (long) insertLength;
+}
+
+long RandomText(unsigned char *text, unsigned int *seed) {
+
+    //Variable declarations.
+    long length;
+    long index;
+    int  size = rand_r(seed) % 10;
+
+    //Check if the text is short, medium or long.
+    if (size < 5) {
+
+        length = rand_r(seed) % 65;
+    } else if (size < 8) {
+
+        length = rand_r(seed) % 4097;
+    } else {
+
+        length = rand_r(seed) % SELF_CHECK_MAX_LENGTH;
+    }
+
+    for (index = 0; index < length; index++) {
+
+        text[index] = RandomByte(seed);
+    }
+
+    return length;
+}
+
+unsigned char RandomByte(unsigned int *seed) {
+
+    //Variable declarations.
+    int kind = rand_r(seed) % 20;
+
+    if (kind < 8) {
+
+        return (unsigned char) ((rand_r(seed) % 2 ? 'a' : 'A') +
+                                rand_r(seed) % 26);
+    }
+
+    if (kind < 10) {
+
+        return (unsigned char) ('0' + rand_r(seed) % 10);
+    }
+
+    if (kind < 16) {
+
+        return (unsigned char) "  \n\n\t\r\v\f"[rand_r(seed) % 8];
+    }
+
+    if (kind < 18) {
+
+        return (unsigned char) (0x80 + rand_r(seed) % 0x80);
+    }
+
+    if (kind < 19) {
+
+        return (unsigned char) ".,;:-+()"[rand_r(seed) % 8];
+    }
+
+    return 0;
+}
+
+long PickPosition(long length, int threadCount, unsigned int *seed) {
+
+    //Variable declarations.
+    long position;
+
+    //Check if the text has no positions.
+    if (length == 0) {
+
+        return 0;
+    }
+
+    switch (rand_r(seed) % 4) {
+
+        case 0:
+
+            //Next to where a chunk starts.
+            position = length * (rand_r(seed) % threadCount) / threadCount +
+                       rand_r(seed) % 3 - 1;
+            break;
+        case 1:
+
+            //Next to where a read buffer ends.
+            position = READ_BUFFER_SIZE *
+                       (1 + rand_r(seed) % (length / READ_BUFFER_SIZE + 1)) +
+                       rand_r(seed) % 3 - 1;
+            break;
+        case 2:
+
+            position = rand_r(seed) % 2 ? 0 : length - 1;
+            break;
+        default:
+
+            position = rand_r(seed) % length;
+    }
+
+    if (position < 0) {
+
+        position = 0;
+    }
+
+    if (position >= length) {
+
+        position = rand_r(seed) % length;
+    }
+
+    return position;
+}
+
+void WriteCase(char *fileName, unsigned char *text, long length) {
+
+    //Variable declarations.
+    int file;
+
+    file = open(fileName, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the file was opened.
+    if (file < 0) {
+
+        perror(fileName);
+        exit(COMPARE_FAILED);
+    }
+
+    //Check if the text was written.
+    if (write(file, text, (size_t) length) != length) {
+
+        perror("Error: failed to write file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Check if file was closed.
+    if (close(file) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+}
+
+int CompressCase(char *fileName, char *command, char *compressedName) {
+
+    //Variable declarations.
+    int   input;
+    int   output;
+    int   nullFile;
+    int   status;
+    pid_t pid;
+
+    input  = open(fileName, O_RDONLY);
+    output = open(compressedName, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the files were opened.
+    if (input < 0 || output < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    pid = fork();
+
+    //Check if fork succeeded.
+    if (pid < 0) {
+
+        perror("Error: fork failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    if (pid == 0) {
+
+        //A missing compressor is reported by the self check.
+        nullFile = open("/dev/null", O_WRONLY);
+
+        if (dup2(input, 0) < 0 || dup2(output, 1) < 0 ||
+            (nullFile >= 0 && dup2(nullFile, 2) < 0)) {
+
+            _exit(DECODER_EXEC_FAILED);
+        }
+
+        execlp(command, command, "-cq", (char *) 0);
+        _exit(DECODER_EXEC_FAILED);
+    }
+
+    close(input);
+    close(output);
+
+    //Check if the compressor finished well.
+    if (waitpid(pid, &status, 0) < 0) {
+
+        perror("Error: waitpid failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+long long NowMicros(void) {
+
+    //Variable declarations.
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+int IsLoadedTokensEqual(char *fileName1, char *fileName2, int isNumeric) {
+
+    //Variable declarations.
+    char          token1[TOKEN_SIZE];
+    char          token2[TOKEN_SIZE];
+    int           isMapped1;
+    int           isMapped2;
+    int           retVal    = 1;
+    long long     size1;
+    long long     size2;
+    long long     position1 = 0;
+    long long     position2 = 0;
+    long long     start1;
+    long long     start2;
+    unsigned char *text1;
+    unsigned char *text2;
+
+    text1 = LoadFile(fileName1, &size1, &isMapped1);
+    text2 = LoadFile(fileName2, &size2, &isMapped2);
+
+    while (retVal) {
+
+        //Skip the whitespace before the tokens.
+        while (position1 < size1 && isspace(text1[position1])) {
+
+            position1++;
+        }
+
+        while (position2 < size2 && isspace(text2[position2])) {
+
+            position2++;
+        }
+
+        //Check if a file has no tokens left, both must have none then.
+        if (position1 == size1 || position2 == size2) {
+
+            retVal = position1 == size1 && position2 == size2;
+            break;
+        }
+
+        start1 = position1;
+        start2 = position2;
+
+        while (position1 < size1 && !isspace(text1[position1])) {
+
+            position1++;
+        }
+
+        while (position2 < size2 && !isspace(text2[position2])) {
+
+            position2++;
+        }
+
+        //Check if the tokens are equal.
+        if (position1 - start1 == position2 - start2 &&
+            memcmp(text1 + start1, text2 + start2,
+                   (size_t) (position1 - start1)) == 0) {
+            continue;
+        }
+
+        //Only tokens that fit the token buffer are compared as numbers.
+        retVal = isNumeric && position1 - start1 < TOKEN_SIZE - 1 &&
+                 position2 - start2 < TOKEN_SIZE - 1;
+
+        if (retVal) {
+
+            memcpy(token1, text1 + start1, (size_t) (position1 - start1));
+            memcpy(token2, text2 + start2, (size_t) (position2 - start2));
+            token1[position1 - start1] = '\0';
+            token2[position2 - start2] = '\0';
+            retVal = IsNumbersClose(token1, token2, SELF_CHECK_ABS_EPSILON,
+                                    SELF_CHECK_REL_EPSILON);
+        }
+    }
+
+    UnloadFile(text1, size1, isMapped1);
+    UnloadFile(text2, size2, isMapped2);
+
+    return retVal;
+}
+
+int IsLoadedLinesEqual(char *fileName1, char *fileName2) {
+
+    //Variable declarations.
+    int           isMapped1;
+    int           isMapped2;
+    int           retVal;
+    long          count1;
+    long          count2;
+    long          index;
+    long long     size1;
+    long long     size2;
+    unsigned char *text1;
+    unsigned char *text2;
+    Line          *lines1;
+    Line          *lines2;
+
+    text1  = LoadFile(fileName1, &size1, &isMapped1);
+    text2  = LoadFile(fileName2, &size2, &isMapped2);
+    lines1 = SplitLines(text1, size1, &count1);
+    lines2 = SplitLines(text2, size2, &count2);
+    retVal = count1 == count2;
+
+    qsort(lines1, (size_t) count1, sizeof(Line), CompareLines);
+    qsort(lines2, (size_t) count2, sizeof(Line), CompareLines);
+
+    for (index = 0; retVal && index < count1; index++) {
+
+        retVal = CompareLines(&lines1[index], &lines2[index]) == 0;
+    }
+
+    free(lines1);
+    free(lines2);
+    UnloadFile(text1, size1, isMapped1);
+    UnloadFile(text2, size2, isMapped2);
+
+    return retVal;
+}
+
+Line *SplitLines(unsigned char *text, long long length, long *count) {
+
+    //Variable declarations.
+    long long position;
+    long long start = 0;
+    Line      *lines;
+
+    //A line per newline and the last line, if any.
+    lines  = (Line *) malloc(sizeof(Line) * (size_t) (length + 1));
+    *count = 0;
+
+    //Check if allocation worked.
+    if (lines == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    for (position = 0; position <= length; position++) {
+
+        //Check if a line ended, a last line without a newline counts too.
+        if ((position < length && text[position] == '\n') ||
+            (position == length && position > start)) {
+
+            lines[*count].text   = text + start;
+            lines[*count].length = (long) (position - start);
+            (*count)++;
+            start = position + 1;
+        }
+    }
+
+    return lines;
+}
+
+int CompareLines(const void *line1, const void *line2) {
+
+    //Variable declarations.
+    const Line *first  = (const Line *) line1;
+    const Line *second = (const Line *) line2;
+    long       common  = first->length < second->length ? first->length :
+                         second->length;
+    int        retVal  = 0;
+
+    //Check if the lines have common bytes, an empty line has no text.
+    if (common > 0) {
+
+        retVal = memcmp(first->text, second->text, (size_t) common);
+    }
+
+    if (retVal == 0) {
+
+        retVal = (first->length > second->length) -
+                 (first->length < second->length);
+    }
+
+    return retVal;
+}
+
+int CheckIdenticalBytes(CheckCase *checkCase) {
+
+    return IsFilesIdentical(checkCase->fileName1, checkCase->fileName2);
+}
+
+int CheckSimilarBytes(CheckCase *checkCase) {
+
+    return IsFilesSimilar(checkCase->fileName1, checkCase->fileName2);
+}
+
+int CheckDecoyBytes(CheckCase *checkCase) {
+
+    //Variable declarations.
+    int reference;
+
+    for (reference = 0; reference < CHECK_REFERENCES; reference++) {
+
+        if (IsFilesIdentical(checkCase->references[reference],
+                             checkCase->fileName2)) {
+
+            return reference;
+        }
+    }
+
+    return -1;
+}
+
+int CheckSimilarDecoyBytes(CheckCase *checkCase) {
+
+    //Variable declarations.
+    int reference;
+
+    for (reference = 0; reference < CHECK_REFERENCES; reference++) {
+
+        if (IsFilesSimilar(checkCase->references[reference],
+                           checkCase->fileName2)) {
+
+            return reference;
+        }
+    }
+
+    return -1;
+}
+
+int CheckTokenDecoyOracle(CheckCase *checkCase) {
+
+    //Variable declarations.
+    int reference;
+
+    for (reference = 0; reference < CHECK_REFERENCES; reference++) {
+
+        if (IsLoadedTokensEqual(checkCase->references[reference],
+                                checkCase->fileName2, 0)) {
+
+            return reference;
+        }
+    }
+
+    return -1;
+}
+
+int CheckTokenOracle(CheckCase *checkCase) {
+
+    return IsLoadedTokensEqual(checkCase->fileName1, checkCase->fileName2,
+                               0);
+}
+
+int CheckNumericOracle(CheckCase *checkCase) {
+
+    return IsLoadedTokensEqual(checkCase->fileName1, checkCase->fileName2,
+                               1);
+}
+
+int CheckLinesOracle(CheckCase *checkCase) {
+
+    return IsLoadedLinesEqual(checkCase->fileName1, checkCase->fileName2);
+}
+
+int CheckSinglePass(CheckCase *checkCase) {
+
+    //Variable declarations.
+    Mismatch mismatch;
+    int      matched;
+
+    matched = FindMatchingReference(&checkCase->fileName1, 1,
+                                    checkCase->fileName2, &mismatch);
+    checkCase->offset = mismatch.offset;
+
+    return matched >= 0;
+}
+
+int CheckReferenceChunks(CheckCase *checkCase) {
+
+    //Variable declarations.
+    Mismatch mismatch;
+    int      matched;
+
+    matched = FindMatchingReferenceInChunks(&checkCase->fileName1, 1,
+                                            checkCase->fileName2, &mismatch,
+                                            checkCase->threadCount);
+    checkCase->offset = mismatch.offset;
+
+    return matched >= 0;
+}
+
+int CheckIdenticalChunks(CheckCase *checkCase) {
+
+    return CompareInChunks(checkCase->fileName1, checkCase->fileName2, 0,
+                           checkCase->threadCount, &checkCase->offset);
+}
+
+int CheckSimilarChunks(CheckCase *checkCase) {
+
+    return CompareInChunks(checkCase->fileName1, checkCase->fileName2, 1,
+                           checkCase->threadCount, 0);
+}
+
+int CheckDecoySinglePass(CheckCase *checkCase) {
+
+    //Variable declarations.
+    Mismatch mismatch;
+    int      matched;
+
+    matched = FindMatchingReference(checkCase->references, CHECK_REFERENCES,
+                                    checkCase->fileName2, &mismatch);
+    checkCase->offset = mismatch.offset;
+
+    return matched;
+}
+
+int CheckDecoyChunks(CheckCase *checkCase) {
+
+    //Variable declarations.
+    Mismatch mismatch;
+    int      matched;
+
+    matched = FindMatchingReferenceInChunks(checkCase->references,
+                                            CHECK_REFERENCES,
+                                            checkCase->fileName2, &mismatch,
+                                            checkCase->threadCount);
+    checkCase->offset = mismatch.offset;
+
+    return matched;
+}
+
+int CheckTokenMode(CheckCase *checkCase) {
+
+    return IsFilesEqualInMode(checkCase->fileName1, checkCase->fileName2,
+                              MODE_TOKEN, 0, 0);
+}
+
+int CheckNumericMode(CheckCase *checkCase) {
+
+    return IsFilesEqualInMode(checkCase->fileName1, checkCase->fileName2,
+                              MODE_NUMERIC, SELF_CHECK_ABS_EPSILON,
+                              SELF_CHECK_REL_EPSILON);
+}
+
+int CheckLinesMode(CheckCase *checkCase) {
+
+    return IsFilesEqualInMode(checkCase->fileName1, checkCase->fileName2,
+                              MODE_LINES, 0, 0);
+}
+
+int CheckSimilarSinglePass(CheckCase *checkCase) {
+
+    return FindSimilarReference(&checkCase->fileName1, 1,
+                                checkCase->fileName2) >= 0;
+}
+
+int CheckSimilarDecoySinglePass(CheckCase *checkCase) {
+
+    return FindSimilarReference(checkCase->references, CHECK_REFERENCES,
+                                checkCase->fileName2);
+}
+
+int CheckTokenSinglePass(CheckCase *checkCase) {
+
+    return FindModeReference(&checkCase->fileName1, 1, checkCase->fileName2,
+                             MODE_TOKEN, 0, 0) >= 0;
+}
+
+int CheckTokenDecoySinglePass(CheckCase *checkCase) {
+
+    return FindModeReference(checkCase->references, CHECK_REFERENCES,
+                             checkCase->fileName2, MODE_TOKEN, 0, 0);
+}
+
+int CheckNumericSinglePass(CheckCase *checkCase) {
+
+    return FindModeReference(&checkCase->fileName1, 1, checkCase->fileName2,
+                             MODE_NUMERIC, SELF_CHECK_ABS_EPSILON,
+                             SELF_CHECK_REL_EPSILON) >= 0;
+}
+
+int CheckLinesSinglePass(CheckCase *checkCase) {
+
+    return FindModeReference(&checkCase->fileName1, 1, checkCase->fileName2,
+                             MODE_LINES, 0, 0) >= 0;
+}
@@ -0,0 +1,2107 @@
+/******************************************
+* Student name: Danny Perov
+* Student ID: 318810637
+* Course Exercise Group: 05
+* Exercise name: Exercise 1
+******************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "compare.h"
+
+//Decoders of the compressed correct outputs that are open.
+static Decoder decoders[MAX_DECODERS];
+static int     decoderCount = 0;
+
+//Lengths of the compressed correct outputs that were decoded to the end.
+static DecodedLength decodedLengths[MAX_DECODERS];
+static int           decodedCount = 0;
+
+int IsFilesIdentical(char *fileName1, char *fileName2) {
+
+    //Variable declaration.
+    char buffer1[BUFFER_SIZE] = {0};
+    char buffer2[BUFFER_SIZE] = {0};
+    int  file1       = 0;
+    int  file2       = 0;
+    int  stop        = 0;
+    int  readFile1   = 0;
+    int  readFile2   = 0;
+    int  retVal      = 1;
+    int  closeResult = 0;
+
+    //Open files for reading.
+    file1 = OpenFileToRead(fileName1);
+    file2 = OpenFileToRead(fileName2);
+
+    while (!stop) {
+
+        readFile1 = ReadFile(file1, buffer1, 1);
+
+        if (readFile1 < 0) {
+
+            perror("Error while reading from file.\n");
+        }
+
+        readFile2 = ReadFile(file2, buffer2, 1);
+
+        //Check if read data.
+        if (readFile2 < 0) {
+
+            perror("Error while reading from file.\n");
+        }
+
+        //Check if reached end of files.
+        if (readFile1 == 0 && readFile2 == 0) {
+
+            stop = 1;
+        }
+
+        //Check if the read chars are equal.
+        if (*buffer1 != *buffer2) {
+
+            stop   = 1;
+            retVal = 0;
+        }
+    }
+
+    closeResult = CloseFile(file1);
+
+    //Check if file was closed.
+    if (closeResult < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    closeResult = CloseFile(file2);
+
+    //Check if file was closed.
+    if (closeResult < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    return retVal;
+}
+
+int IsFilesSimilar(char *fileName1, char *fileName2) {
+
+    //Variable declaration.
+    char buffer1[BUFFER_SIZE] = {0};
+    char buffer2[BUFFER_SIZE] = {0};
+    int  file1       = 0;
+    int  file2       = 0;
+    int  stop        = 0;
+    int  isLetter1   = 0;
+    int  isLetter2   = 0;
+    int  readFile1   = 0;
+    int  readFile2   = 0;
+    int  retVal      = 1;
+    int  closeResult = 0;
+
+    //Open files for reading.
+    file1 = OpenFileToRead(fileName1);
+    file2 = OpenFileToRead(fileName2);
+
+    while (!stop) {
+
+        isLetter1 = 0;
+        isLetter2 = 0;
+
+        //Search for a legal char in file 1.
+        while (!isLetter1) {
+
+            readFile1 = ReadFile(file1, buffer1, 1);
+
+            //Check if read data.
+            if (readFile1 < 0) {
+
+                perror("Error while reading from file.\n");
+                exit(COMPARE_FAILED);
+            }
+
+            //Check if encountered a legal letter.
+            if (readFile1 == 0) {
+
+                isLetter1 = 1;
+            }
+
+            //Check if encountered an illegal letter.
+            if (!isspace(*buffer1) && (*buffer1 != '\n')) {
+
+                isLetter1 = 1;
+            }
+        }
+
+        //Search for a legal char in file 2.
+        while (!isLetter2) {
+
+            readFile2 = ReadFile(file2, buffer2, 1);
+
+            //Check if read data.
+            if (readFile2 < 0) {
+
+                perror("Error while reading from file.\n");
+                exit(COMPARE_FAILED);
+            }
+
+            //Check if encountered a legal letter.
+            if (readFile2 == 0) {
+
+                isLetter2 = 1;
+            }
+
+            //Check if encountered an illegal letter.
+            if ((!isspace(*buffer2)) && (*buffer2 != '\n')) {
+
+                isLetter2 = 1;
+            }
+        }
+
+        //Check if reached end of files.
+        if (readFile1 == 0 && readFile2 == 0) {
+
+            stop = 1;
+        }
+
+        //Check if only one of the files ended.
+        if ((readFile1 == 0) != (readFile2 == 0)) {
+
+            stop   = 1;
+            retVal = 0;
+        }
+
+        //Convert to lower case chars.
+        *buffer1 = tolower(*buffer1);
+        *buffer2 = tolower(*buffer2);
+
+        //Check if chars are equal.
+        if (*buffer1 != *buffer2) {
+
+            stop   = 1;
+            retVal = 0;
+        }
+    }
+
+    closeResult = CloseFile(file1);
+
+    //Check if file was closed.
+    if (closeResult < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    closeResult = CloseFile(file2);
+
+    //Check if file was closed.
+    if (closeResult < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    return retVal;
+}
+
+int IsFilesTokenEqual(char *fileName1, char *fileName2, int isNumeric,
+                      double absEpsilon, double relEpsilon) {
+
+    //Variable declarations.
+    char   token1[TOKEN_SIZE];
+    char   token2[TOKEN_SIZE];
+    int    length1;
+    int    length2;
+    int    isContinued1   = 0;
+    int    isContinued2   = 0;
+    int    isTokenStart   = 1;
+    int    retVal         = 1;
+    Reader *reader1;
+    Reader *reader2;
+
+    reader1 = (Reader *) malloc(sizeof(Reader));
+    reader2 = (Reader *) malloc(sizeof(Reader));
+
+    //Check if allocation worked.
+    if (reader1 == 0 || reader2 == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    InitReader(reader1, fileName1);
+    InitReader(reader2, fileName2);
+
+    while (retVal) {
+
+        length1 = ReadToken(reader1, token1, &isContinued1);
+        length2 = ReadToken(reader2, token2, &isContinued2);
+
+        //Check if reached end of files.
+        if (length1 < 0 && length2 < 0) {
+            break;
+        }
+
+        //Check if the token pieces are equal.
+        if (length1 != length2 || isContinued1 != isContinued2 ||
+            memcmp(token1, token2, (size_t) (length1 > 0 ? length1 : 0)) !=
+            0) {
+
+            //Whole tokens that are close numbers are still equal.
+            retVal = isNumeric && isTokenStart && length1 > 0 &&
+                     length2 > 0 && !isContinued1 && !isContinued2 &&
+                     IsNumbersClose(token1, token2, absEpsilon, relEpsilon);
+        }
+
+        //The next piece starts a new token unless this one goes on.
+        isTokenStart = !isContinued1;
+    }
+
+    CloseReader(reader1);
+    CloseReader(reader2);
+    free(reader1);
+    free(reader2);
+
+    return retVal;
+}
+
+int IsFilesLineSetEqual(char *fileName1, char *fileName2) {
+
+    //Variable declarations.
+    unsigned long long sum1[2] = {0, 0};
+    unsigned long long sum2[2] = {0, 0};
+    long               lines1  = 0;
+    long               lines2  = 0;
+
+    HashLines(fileName1, &sum1[0], &sum1[1], &lines1);
+    HashLines(fileName2, &sum2[0], &sum2[1], &lines2);
+
+    return lines1 == lines2 && sum1[0] == sum2[0] && sum1[1] == sum2[1];
+}
+
+void InitReader(Reader *reader, char *fileName) {
+
+    reader->fd       = OpenFileToRead(fileName);
+    reader->length   = 0;
+    reader->position = 0;
+}
+
+void CloseReader(Reader *reader) {
+
+    //Check if file was closed.
+    if (CloseFile(reader->fd) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+}
+
+int ReadChar(Reader *reader) {
+
+    //Check if the buffer ran out.
+    if (reader->position == reader->length) {
+
+        reader->length   = ReadFile(reader->fd, reader->buffer,
+                                    READ_BUFFER_SIZE);
+        reader->position = 0;
+
+        //Check if read data.
+        if (reader->length < 0) {
+
+            perror("Error while reading from file.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        //Check if reached end of file.
+        if (reader->length == 0) {
+
+            return -1;
+        }
+    }
+
+    return reader->buffer[reader->position++];
+}
+
+int ReadToken(Reader *reader, char *token, int *isContinued) {
+
+    //Variable declarations.
+    int letter;
+    int length       = 0;
+    int wasContinued = *isContinued;
+
+    //Skip the whitespace before a new token.
+    if (!*isContinued) {
+
+        do {
+
+            letter = ReadChar(reader);
+        } while (letter != -1 && isspace(letter));
+
+    } else {
+
+        letter = ReadChar(reader);
+    }
+
+    //Collect chars until the token ends or the buffer is full.
+    while (letter != -1 && !isspace(letter)) {
+
+        token[length++] = (char) letter;
+
+        //Check if the buffer is full.
+        if (length == TOKEN_SIZE - 1) {
+            break;
+        }
+
+        letter = ReadChar(reader);
+    }
+
+    token[length] = '\0';
+
+    //The token goes on if the buffer filled up before its end.
+    *isContinued = (length == TOKEN_SIZE - 1);
+
+    //Check if reached end of file without a token. A token that filled the
+    //buffer right before the end still ends here with an empty piece, as it
+    //would before whitespace.
+    if (length == 0 && letter == -1 && !wasContinued) {
+
+        return -1;
+    }
+
+    return length;
+}
+
+int IsNumbersClose(char *token1, char *token2, double absEpsilon,
+                   double relEpsilon) {
+
+    //Variable declarations.
+    char   *end1;
+    char   *end2;
+    double number1;
+    double number2;
+    double difference;
+    double largest;
+
+    number1 = strtod(token1, &end1);
+    number2 = strtod(token2, &end2);
+
+    //Check that both tokens are whole numbers.
+    if (end1 == token1 || *end1 != '\0' || end2 == token2 || *end2 != '\0') {
+
+        return 0;
+    }
+
+    //Equal numbers, including infinities, are always close.
+    if (number1 == number2) {
+
+        return 1;
+    }
+
+    difference = fabs(number1 - number2);
+    largest    = fabs(number1) > fabs(number2) ? fabs(number1) :
+                 fabs(number2);
+
+    return difference <= absEpsilon || difference <= relEpsilon * largest;
+}
+
+unsigned long long MixHash(unsigned long long hash) {
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+void HashLines(char *fileName, unsigned long long *sum1,
+               unsigned long long *sum2, long *lines) {
+
+    //Variable declarations.
+    unsigned long long hash1     = 14695981039346656037ULL;
+    unsigned long long hash2     = 0x9e3779b97f4a7c15ULL;
+    int                letter;
+    int                lineLength = 0;
+    Reader             *reader;
+
+    reader = (Reader *) malloc(sizeof(Reader));
+
+    //Check if allocation worked.
+    if (reader == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    InitReader(reader, fileName);
+
+    do {
+
+        letter = ReadChar(reader);
+
+        //Check if a line ended, a last line without a newline counts too.
+        if (letter == '\n' || (letter == -1 && lineLength > 0)) {
+
+            *sum1 += MixHash(hash1 ^ (unsigned long long) lineLength);
+            *sum2 += MixHash(hash2 + (unsigned long long) lineLength);
+            (*lines)++;
+
+            hash1      = 14695981039346656037ULL;
+            hash2      = 0x9e3779b97f4a7c15ULL;
+            lineLength = 0;
+
+        } else if (letter != -1) {
+
+            //Hash the line with FNV-1a and a multiply-rotate hash.
+            hash1 = (hash1 ^ (unsigned char) letter) * 1099511628211ULL;
+            hash2 = ((hash2 << 5) | (hash2 >> 59)) * 0x100000001b3ULL +
+                    (unsigned char) letter;
+            lineLength++;
+        }
+    } while (letter != -1);
+
+    CloseReader(reader);
+    free(reader);
+}
+
+int FindMatchingReference(char **references, int referenceCount,
+                          char *studentName, Mismatch *mismatch) {
+
+    //Variable declarations.
+    int    letter;
+    int    studentLast = 0;
+    int    compared;
+    int    referenceLetter;
+    int    isReading;
+    int    reference;
+    int    liveCount;
+    int    live[MAX_REFERENCES];
+    int    lastLetters[MAX_REFERENCES];
+    Reader *student;
+    Reader *readers[MAX_REFERENCES];
+
+    student = (Reader *) malloc(sizeof(Reader));
+
+    //Check if allocation worked.
+    if (student == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    InitReader(student, studentName);
+
+    //Every correct output starts out live.
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        readers[reference] = (Reader *) malloc(sizeof(Reader));
+
+        //Check if allocation worked.
+        if (readers[reference] == 0) {
+
+            perror("Error: malloc failed.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        InitReader(readers[reference], references[reference]);
+        live[reference]        = reference;
+        lastLetters[reference] = 0;
+    }
+
+    liveCount           = referenceCount;
+    mismatch->offset    = 0;
+    mismatch->line      = 1;
+    mismatch->column    = 1;
+    mismatch->reference = 0;
+
+    do {
+
+        letter    = ReadChar(student);
+        isReading = letter != -1;
+
+        //A file that ended goes on repeating its last char, as the
+        //byte-wise comparison's buffer does.
+        if (isReading) {
+
+            studentLast = letter;
+        }
+
+        //Keep only the correct outputs that agree with this char.
+        for (reference = 0; reference < liveCount; reference++) {
+
+            referenceLetter = ReadChar(readers[live[reference]]);
+
+            //Check if both files ended, they agree then.
+            if (referenceLetter == -1 && letter == -1) {
+                continue;
+            }
+
+            if (referenceLetter != -1) {
+
+                lastLetters[live[reference]] = referenceLetter;
+                isReading                    = 1;
+            }
+
+            compared = referenceLetter == -1 ? lastLetters[live[reference]] :
+                       referenceLetter;
+
+            if (compared != studentLast) {
+
+                //Remember the last one to drop out as the closest.
+                mismatch->reference = live[reference];
+                live[reference]     = live[--liveCount];
+                reference--;
+            }
+        }
+
+        //Check if no correct output agrees anymore.
+        if (liveCount == 0) {
+            break;
+        }
+
+        //Move the position past the char.
+        if (letter == '\n') {
+
+            mismatch->line++;
+            mismatch->column = 1;
+
+        } else {
+
+            mismatch->column++;
+        }
+
+        mismatch->offset++;
+    } while (isReading);
+
+    CloseReader(student);
+    free(student);
+
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        CloseReader(readers[reference]);
+        free(readers[reference]);
+    }
+
+    //Check if a correct output reached its end together with the student's.
+    if (liveCount > 0) {
+
+        mismatch->offset    = -1;
+        mismatch->reference = live[0];
+
+        //Report the first of the identical correct outputs.
+        for (reference = 1; reference < liveCount; reference++) {
+
+            if (live[reference] < mismatch->reference) {
+
+                mismatch->reference = live[reference];
+            }
+        }
+
+        return mismatch->reference;
+    }
+
+    return -1;
+}
+
+int IsFilesEqualInMode(char *fileName1, char *fileName2, int mode,
+                       double absEpsilon, double relEpsilon) {
+
+    switch (mode) {
+
+        case MODE_TOKEN:
+            return IsFilesTokenEqual(fileName1, fileName2, 0, 0, 0);
+
+        case MODE_NUMERIC:
+            return IsFilesTokenEqual(fileName1, fileName2, 1, absEpsilon,
+                                     relEpsilon);
+
+        case MODE_LINES:
+            return IsFilesLineSetEqual(fileName1, fileName2);
+
+        default:
+            return 0;
+    }
+}
+
+int FindModeReference(char **references, int referenceCount,
+                      char *studentName, int mode, double absEpsilon,
+                      double relEpsilon) {
+
+    //Variable declarations.
+    unsigned long long sum1[2] = {0, 0};
+    unsigned long long sum2[2] = {0, 0};
+    char               token1[TOKEN_SIZE];
+    char               token2[TOKEN_SIZE];
+    int                length1;
+    int                length2;
+    int                isContinued2 = 0;
+    int                isNumeric    = mode == MODE_NUMERIC;
+    int                reference;
+    int                matched      = -1;
+    int                liveCount;
+    int                live[MAX_REFERENCES];
+    int                isContinued1[MAX_REFERENCES];
+    int                isTokenStart[MAX_REFERENCES];
+    long               lines1       = 0;
+    long               lines2       = 0;
+    Reader             *student;
+    Reader             *readers[MAX_REFERENCES];
+
+    //The lines mode needs every correct output whole, only once the
+    //student's.
+    if (mode == MODE_LINES) {
+
+        HashLines(studentName, &sum2[0], &sum2[1], &lines2);
+
+        for (reference = 0; reference < referenceCount; reference++) {
+
+            sum1[0] = 0;
+            sum1[1] = 0;
+            lines1  = 0;
+
+            HashLines(references[reference], &sum1[0], &sum1[1], &lines1);
+
+            //Check if the correct output has the student's lines.
+            if (lines1 == lines2 && sum1[0] == sum2[0] && sum1[1] == sum2[1]) {
+
+                return reference;
+            }
+        }
+
+        return -1;
+    }
+
+    //Check if the mode compares tokens.
+    if (mode != MODE_TOKEN && mode != MODE_NUMERIC) {
+
+        return -1;
+    }
+
+    student = (Reader *) malloc(sizeof(Reader));
+
+    //Check if allocation worked.
+    if (student == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    InitReader(student, studentName);
+
+    //Every correct output starts out live.
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        readers[reference] = (Reader *) malloc(sizeof(Reader));
+
+        //Check if allocation worked.
+        if (readers[reference] == 0) {
+
+            perror("Error: malloc failed.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        InitReader(readers[reference], references[reference]);
+        live[reference]         = reference;
+        isContinued1[reference] = 0;
+        isTokenStart[reference] = 1;
+    }
+
+    liveCount = referenceCount;
+
+    while (liveCount > 0) {
+
+        length2 = ReadToken(student, token2, &isContinued2);
+
+        //Keep only the correct outputs whose token pieces agree.
+        for (reference = 0; reference < liveCount; reference++) {
+
+            length1 = ReadToken(readers[live[reference]], token1,
+                                &isContinued1[live[reference]]);
+
+            //Check if both files ended, the first such one is the match.
+            if (length1 < 0 && length2 < 0) {
+
+                if (matched < 0 || live[reference] < matched) {
+
+                    matched = live[reference];
+                }
+
+                live[reference] = live[--liveCount];
+                reference--;
+                continue;
+            }
+
+            //Check if the token pieces are equal, whole tokens that are
+            //close numbers are still equal.
+            if ((length1 != length2 ||
+                 isContinued1[live[reference]] != isContinued2 ||
+                 memcmp(token1, token2,
+                        (size_t) (length1 > 0 ? length1 : 0)) != 0) &&
+                !(isNumeric && isTokenStart[live[reference]] &&
+                  length1 > 0 && length2 > 0 &&
+                  !isContinued1[live[reference]] && !isContinued2 &&
+                  IsNumbersClose(token1, token2, absEpsilon, relEpsilon))) {
+
+                live[reference] = live[--liveCount];
+                reference--;
+                continue;
+            }
+
+            //The next piece starts a new token unless this one goes on.
+            isTokenStart[live[reference]] = !isContinued1[live[reference]];
+        }
+
+        //Check if the student's output ended, every correct output did too.
+        if (length2 < 0) {
+            break;
+        }
+    }
+
+    CloseReader(student);
+    free(student);
+
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        CloseReader(readers[reference]);
+        free(readers[reference]);
+    }
+
+    return matched;
+}
+
+int FindSimilarReference(char **references, int referenceCount,
+                         char *studentName) {
+
+    //Variable declarations.
+    int    letter;
+    int    studentLast = 0;
+    int    referenceLetter;
+    int    reference;
+    int    matched     = -1;
+    int    liveCount;
+    int    live[MAX_REFERENCES];
+    int    lastLetters[MAX_REFERENCES];
+    Reader *student;
+    Reader *readers[MAX_REFERENCES];
+
+    student = (Reader *) malloc(sizeof(Reader));
+
+    //Check if allocation worked.
+    if (student == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    InitReader(student, studentName);
+
+    //Every correct output starts out live.
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        readers[reference] = (Reader *) malloc(sizeof(Reader));
+
+        //Check if allocation worked.
+        if (readers[reference] == 0) {
+
+            perror("Error: malloc failed.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        InitReader(readers[reference], references[reference]);
+        live[reference]        = reference;
+        lastLetters[reference] = 0;
+    }
+
+    liveCount = referenceCount;
+
+    while (liveCount > 0) {
+
+        letter = ReadSimilarChar(student, &studentLast);
+
+        //Keep only the correct outputs that agree with this char.
+        for (reference = 0; reference < liveCount; reference++) {
+
+            referenceLetter = ReadSimilarChar(readers[live[reference]],
+                                              &lastLetters[live[reference]]);
+
+            //Check if both files ended, their last chars decide then.
+            if (referenceLetter == -1 && letter == -1) {
+
+                if (tolower(lastLetters[live[reference]]) ==
+                    tolower(studentLast) &&
+                    (matched < 0 || live[reference] < matched)) {
+
+                    matched = live[reference];
+                }
+
+                live[reference] = live[--liveCount];
+                reference--;
+
+            } else if (referenceLetter != letter) {
+
+                //Only one of the files ended or the chars differ.
+                live[reference] = live[--liveCount];
+                reference--;
+            }
+        }
+
+        //Check if the student's output ended, every correct output did too.
+        if (letter == -1) {
+            break;
+        }
+    }
+
+    CloseReader(student);
+    free(student);
+
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        CloseReader(readers[reference]);
+        free(readers[reference]);
+    }
+
+    return matched;
+}
+
+int ReadSimilarChar(Reader *reader, int *last) {
+
+    //Variable declarations.
+    int letter;
+
+    do {
+
+        letter = ReadChar(reader);
+
+        //Keep the last char, the end of the file compares it.
+        if (letter != -1) {
+
+            *last = letter;
+        }
+    } while (letter != -1 && isspace(letter));
+
+    return letter == -1 ? -1 : tolower(letter);
+}
+
+long BoundedEditDistance(char *fileName1, char *fileName2, long long prefix,
+                         long budgetMillis) {
+
+    //Variable declarations.
+    int           isMapped1;
+    int           isMapped2;
+    long          length1;
+    long          length2;
+    long          longest;
+    long          band;
+    long          distance = -1;
+    long long     size1;
+    long long     size2;
+    long long     deadline;
+    unsigned char *text1;
+    unsigned char *text2;
+
+    deadline = NowMillis() + budgetMillis;
+
+    //A compressed file is streamed rather than decoded into memory, the
+    //distance is the same both ways round.
+    if (DecoderCommand(fileName1) != 0) {
+
+        return StreamedEditDistance(fileName1, fileName2, prefix, deadline);
+    }
+
+    if (DecoderCommand(fileName2) != 0) {
+
+        return StreamedEditDistance(fileName2, fileName1, prefix, deadline);
+    }
+
+    text1    = LoadFile(fileName1, &size1, &isMapped1);
+    text2    = LoadFile(fileName2, &size2, &isMapped2);
+    length1  = (long) size1;
+    length2  = (long) size2;
+    longest  = length1 > length2 ? length1 : length2;
+
+    //An empty file is as far as the other file is long.
+    if (length1 == 0 || length2 == 0) {
+
+        distance = longest;
+    }
+
+    //Drop the common suffix, the common prefix is already known.
+    while (length1 > prefix && length2 > prefix &&
+           text1[length1 - 1] == text2[length2 - 1]) {
+
+        length1--;
+        length2--;
+    }
+
+    length1 -= (long) prefix;
+    length2 -= (long) prefix;
+
+    //Widen the band until the distance fits in it.
+    band = labs(length1 - length2);
+
+    if (band < DISTANCE_MIN_BAND) {
+
+        band = DISTANCE_MIN_BAND;
+    }
+
+    while (distance < 0) {
+
+        //A band as wide as the longer text gives the exact distance.
+        if (band > length1 && band > length2) {
+
+            band = length1 > length2 ? length1 : length2;
+        }
+
+        distance = BandedEditDistance(text1 + prefix, length1, text2 + prefix,
+                                      length2, band, deadline);
+
+        //Check if the budget ran out.
+        if (distance == DISTANCE_TIMEOUT) {
+
+            distance = -1;
+            break;
+        }
+
+        //Check if the distance is outside the band.
+        if (distance > band) {
+
+            distance = -1;
+            band *= 2;
+        }
+    }
+
+    UnloadFile(text1, size1, isMapped1);
+    UnloadFile(text2, size2, isMapped2);
+
+    return distance;
+}
+
+long BandedEditDistance(unsigned char *text1, long length1,
+                        unsigned char *text2, long length2, long band,
+                        long long deadline) {
+
+    //Variable declarations.
+    long          row;
+    DistanceTable table;
+
+    //Check if the end of the table is inside the band.
+    if (labs(length1 - length2) > band) {
+
+        return band + 1;
+    }
+
+    StartDistanceTable(&table, band, length2);
+
+    for (row = 1; row <= length1; row++) {
+
+        //Check the time budget every few rows.
+        if (row % DISTANCE_CHECK_ROWS == 0 && NowMillis() > deadline) {
+
+            EndDistanceTable(&table, length2);
+
+            return DISTANCE_TIMEOUT;
+        }
+
+        AddDistanceRow(&table, text1[row - 1], text2, length2);
+    }
+
+    return EndDistanceTable(&table, length2);
+}
+
+long StreamedEditDistance(char *fileName1, char *fileName2, long long prefix,
+                          long long deadline) {
+
+    //Variable declarations.
+    int           file1;
+    int           isMapped2;
+    int           isTimeout = 0;
+    long          length1   = -1;
+    long          length2;
+    long          band      = DISTANCE_MIN_BAND;
+    long          distance  = -1;
+    long long     size2;
+    long long     skipped;
+    ssize_t       readNum;
+    ssize_t       index;
+    unsigned char buffer[READ_BUFFER_SIZE];
+    unsigned char *text2;
+    DistanceTable table;
+
+    text2   = LoadFile(fileName2, &size2, &isMapped2);
+    length2 = (long) (size2 - prefix);
+
+    while (distance < 0) {
+
+        //A band as wide as the longer text gives the exact distance.
+        if (length1 >= 0 && band > length1 && band > length2) {
+
+            band = length1 > length2 ? length1 : length2;
+        }
+
+        file1   = OpenFileToRead(fileName1);
+        skipped = 0;
+        readNum = 0;
+
+        StartDistanceTable(&table, band, length2);
+
+        while (!isTimeout &&
+               (readNum = ReadFile(file1, buffer, READ_BUFFER_SIZE)) > 0) {
+
+            for (index = 0; index < readNum; index++) {
+
+                //The common prefix is already known.
+                if (skipped < prefix) {
+
+                    skipped++;
+                    continue;
+                }
+
+                //Rows past the band only count the length.
+                if (table.row - length2 >= band) {
+
+                    table.row++;
+                    continue;
+                }
+
+                //Check the time budget every few rows.
+                if ((table.row + 1) % DISTANCE_CHECK_ROWS == 0 &&
+                    NowMillis() > deadline) {
+
+                    isTimeout = 1;
+                    break;
+                }
+
+                AddDistanceRow(&table, buffer[index], text2 + prefix,
+                               length2);
+            }
+        }
+
+        //Check if read data.
+        if (readNum < 0) {
+
+            perror("Error while reading from file.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        CloseFile(file1);
+
+        length1  = table.row;
+        distance = EndDistanceTable(&table, length2);
+
+        //Check if the budget ran out.
+        if (isTimeout) {
+
+            distance = -1;
+            break;
+        }
+
+        //Check if the distance is outside the band, the next band at least
+        //covers the difference in length.
+        if (distance > band) {
+
+            distance = -1;
+            band    *= 2;
+
+            if (band < labs(length1 - length2)) {
+
+                band = labs(length1 - length2);
+            }
+        }
+
+        //An empty text is as far as the other text is long.
+        if (length2 == 0) {
+
+            distance = length1;
+        }
+    }
+
+    UnloadFile(text2, size2, isMapped2);
+
+    return distance;
+}
+
+void StartDistanceTable(DistanceTable *table, long band, long length2) {
+
+    //Variable declarations.
+    long cell;
+    long column;
+
+    table->band     = band;
+    table->width    = 2 * band + 1;
+    table->infinity = band + 1;
+    table->row      = 0;
+    table->previous = (long *) malloc(table->width * sizeof(long));
+    table->current  = (long *) malloc(table->width * sizeof(long));
+
+    //Check if allocation worked.
+    if (table->previous == 0 || table->current == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Row 0 is only insertions.
+    for (cell = 0; cell < table->width; cell++) {
+
+        column               = cell - band;
+        table->current[cell] = (column >= 0 && column <= length2 &&
+                                column < table->infinity) ? column :
+                               table->infinity;
+    }
+}
+
+void AddDistanceRow(DistanceTable *table, unsigned char byte,
+                    unsigned char *text2, long length2) {
+
+    //Variable declarations.
+    long *previous = table->current;
+    long *current  = table->previous;
+    long width     = table->width;
+    long infinity  = table->infinity;
+    long row       = ++table->row;
+    long cell;
+    long column;
+    long best;
+
+    table->previous = previous;
+    table->current  = current;
+
+    for (cell = 0; cell < width; cell++) {
+
+        column = row - table->band + cell;
+
+        //Check if the column is outside the table.
+        if (column < 0 || column > length2) {
+
+            current[cell] = infinity;
+            continue;
+        }
+
+        //The first column is only deletions.
+        if (column == 0) {
+
+            current[cell] = row < infinity ? row : infinity;
+            continue;
+        }
+
+        //Substitution or match, previous row's same cell is the diagonal.
+        best = previous[cell] + (byte != text2[column - 1] ? 1 : 0);
+
+        //Insertion from the left.
+        if (cell > 0 && current[cell - 1] + 1 < best) {
+
+            best = current[cell - 1] + 1;
+        }
+
+        //Deletion from above.
+        if (cell + 1 < width && previous[cell + 1] + 1 < best) {
+
+            best = previous[cell + 1] + 1;
+        }
+
+        current[cell] = best < infinity ? best : infinity;
+    }
+}
+
+long EndDistanceTable(DistanceTable *table, long length2) {
+
+    //Variable declarations.
+    long distance = table->infinity;
+
+    //Check if the end of the table is inside the band.
+    if (labs(table->row - length2) <= table->band) {
+
+        distance = table->current[length2 - table->row + table->band];
+    }
+
+    free(table->previous);
+    free(table->current);
+
+    return distance;
+}
+
+long long NowMillis(void) {
+
+    //Variable declarations.
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+int OpenFileToRead(char *fileName) {
+
+    //Variable declarations.
+    int file = 0;
+
+    //Variable declarations.
+    char *command;
+
+    file = open(fileName, O_RDONLY | O_CLOEXEC);
+
+    //Check that file 1 was opened correctly.
+    if (file == -1) {
+
+        perror(fileName);
+
+        exit(COMPARE_FAILED);
+    }
+
+    command = DecoderCommand(fileName);
+
+    //A compressed correct output is read through its decoder.
+    if (command != 0) {
+
+        file = StartDecoder(file, fileName, command);
+    }
+
+    return file;
+}
+
+
+int FindMatchingReferenceInChunks(char **references, int referenceCount,
+                                  char *studentName, Mismatch *mismatch,
+                                  int threadCount) {
+
+    //Variable declarations.
+    int           reference;
+    int           matched  = -1;
+    int           studentFile;
+    long long     offset;
+    long long     longest  = -1;
+    long long     position = 0;
+    long long     counted;
+    unsigned char *text;
+    unsigned char *newline;
+    struct stat   fileStat;
+
+    mismatch->reference = 0;
+
+    for (reference = 0; reference < referenceCount; reference++) {
+
+        CompareInChunks(references[reference], studentName, 0, threadCount,
+                        &offset);
+
+        //Check if the outputs are identical.
+        if (offset < 0) {
+
+            matched = reference;
+            break;
+        }
+
+        //Remember the correct output that agrees the longest.
+        if (offset > longest) {
+
+            longest             = offset;
+            mismatch->reference = reference;
+        }
+    }
+
+    mismatch->line   = 1;
+    mismatch->column = 1;
+
+    if (matched >= 0) {
+
+        mismatch->offset    = -1;
+        mismatch->reference = matched;
+
+        return matched;
+    }
+
+    mismatch->offset = longest;
+
+    //Count the lines before the difference for the report.
+    if (longest > 0) {
+
+        studentFile = OpenFileToRead(studentName);
+
+        //Check the student's size, the difference may be past its end.
+        if (fstat(studentFile, &fileStat) < 0) {
+
+            perror("Error: failed to stat file.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        counted = longest < fileStat.st_size ? longest :
+                  (long long) fileStat.st_size;
+        text    = counted > 0 ? mmap(0, (size_t) counted, PROT_READ,
+                                     MAP_PRIVATE, studentFile, 0) : 0;
+
+        //Check if the file was mapped.
+        if (text == MAP_FAILED) {
+
+            perror("Error: mmap failed.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        close(studentFile);
+
+        while (counted > 0 &&
+               (newline = memchr(text + position, '\n',
+                                 (size_t) (counted - position))) != 0) {
+
+            mismatch->line++;
+            position = newline - text + 1;
+        }
+
+        mismatch->column = (long) (longest - position + 1);
+
+        if (counted > 0) {
+
+            munmap(text, (size_t) counted);
+        }
+    }
+
+    return -1;
+}
+
+int CompareInChunks(char *fileName1, char *fileName2, int isSimilar,
+                    int threadCount, long long *offset) {
+
+    //Variable declarations.
+    ChunkJob  *job;
+    int       chunk;
+    int       retVal;
+    int       last1;
+    int       last2;
+    long long shorter;
+    long long difference;
+
+    job = (ChunkJob *) malloc(sizeof(ChunkJob));
+
+    //Check if allocation worked.
+    if (job == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    job->text1      = MapFile(fileName1, &job->length1);
+    job->text2      = MapFile(fileName2, &job->length2);
+    job->chunkCount = threadCount;
+    job->stopChunk  = threadCount;
+
+    for (chunk = 0; chunk < threadCount; chunk++) {
+
+        job->offsets[chunk] = -1;
+    }
+
+    if (isSimilar) {
+
+        RunChunkThreads(job, CountChunk);
+        job->before1[0] = 0;
+        job->before2[0] = 0;
+
+        for (chunk = 0; chunk < threadCount; chunk++) {
+
+            job->before1[chunk + 1] = job->before1[chunk] + job->counts1[chunk];
+            job->before2[chunk + 1] = job->before2[chunk] + job->counts2[chunk];
+        }
+
+        last1 = job->length1 > 0 ? tolower(job->text1[job->length1 - 1]) : 0;
+        last2 = job->length2 > 0 ? tolower(job->text2[job->length2 - 1]) : 0;
+
+        //Similar files have as many non whitespace bytes, and the byte-wise
+        //comparison ends comparing the files' last chars.
+        retVal = job->before1[threadCount] == job->before2[threadCount] &&
+                 last1 == last2;
+
+        if (retVal) {
+
+            RunChunkThreads(job, CompareSimilarChunk);
+            retVal = job->stopChunk == threadCount;
+        }
+
+    } else {
+
+        RunChunkThreads(job, CompareIdenticalChunk);
+        shorter = job->length1 < job->length2 ? job->length1 : job->length2;
+
+        //The first difference is in the lowest chunk that found one, or
+        //where the longer file stops repeating the shorter one's last byte.
+        if (job->stopChunk < threadCount) {
+
+            difference = job->offsets[job->stopChunk];
+        } else if (job->length1 > job->length2) {
+
+            difference = FindTailDifference(job->text1, shorter,
+                                            job->length1, shorter > 0 ?
+                                            job->text2[shorter - 1] : 0);
+        } else {
+
+            difference = FindTailDifference(job->text2, shorter,
+                                            job->length2, shorter > 0 ?
+                                            job->text1[shorter - 1] : 0);
+        }
+
+        retVal = difference < 0;
+
+        if (offset != 0) {
+
+            *offset = difference;
+        }
+    }
+
+    if (job->text1 != 0) {
+
+        munmap(job->text1, (size_t) job->length1);
+    }
+
+    if (job->text2 != 0) {
+
+        munmap(job->text2, (size_t) job->length2);
+    }
+
+    free(job);
+
+    return retVal;
+}
+
+void RunChunkThreads(ChunkJob *job, void *(*routine)(void *)) {
+
+    //Variable declarations.
+    int       chunk;
+    pthread_t threads[MAX_THREADS];
+    ChunkTask tasks[MAX_THREADS];
+
+    for (chunk = 0; chunk < job->chunkCount; chunk++) {
+
+        tasks[chunk].job   = job;
+        tasks[chunk].chunk = chunk;
+
+        //Check if the thread was started.
+        if (pthread_create(&threads[chunk], 0, routine, &tasks[chunk]) != 0) {
+
+            perror("Error: pthread_create failed.\n");
+            exit(COMPARE_FAILED);
+        }
+    }
+
+    for (chunk = 0; chunk < job->chunkCount; chunk++) {
+
+        pthread_join(threads[chunk], 0);
+    }
+}
+
+void *CompareIdenticalChunk(void *task) {
+
+    //Variable declarations.
+    ChunkJob  *job   = ((ChunkTask *) task)->job;
+    int       chunk  = ((ChunkTask *) task)->chunk;
+    long long length = job->length1 < job->length2 ? job->length1 :
+                       job->length2;
+    long long start  = length * chunk / job->chunkCount;
+    long long end    = length * (chunk + 1) / job->chunkCount;
+    long long block;
+
+    while (start < end) {
+
+        //Check if a difference before this chunk was found.
+        if (chunk > __atomic_load_n(&job->stopChunk, __ATOMIC_RELAXED)) {
+            break;
+        }
+
+        block = end - start < CANCEL_CHECK_BYTES ? end - start :
+                CANCEL_CHECK_BYTES;
+
+        //Check if the block differs, then find the byte.
+        if (memcmp(job->text1 + start, job->text2 + start, (size_t) block) !=
+            0) {
+
+            while (job->text1[start] == job->text2[start]) {
+
+                start++;
+            }
+
+            job->offsets[chunk] = start;
+            StopAtChunk(job, chunk);
+            break;
+        }
+
+        start += block;
+    }
+
+    return 0;
+}
+
+void *CountChunk(void *task) {
+
+    //Variable declarations.
+    ChunkJob  *job  = ((ChunkTask *) task)->job;
+    int       chunk = ((ChunkTask *) task)->chunk;
+    long long position;
+    long long end;
+    long long count;
+
+    count = 0;
+    end   = job->length1 * (chunk + 1) / job->chunkCount;
+
+    for (position = job->length1 * chunk / job->chunkCount; position < end;
+         position++) {
+
+        count += !isspace(job->text1[position]);
+    }
+
+    job->counts1[chunk] = count;
+    count               = 0;
+    end                 = job->length2 * (chunk + 1) / job->chunkCount;
+
+    for (position = job->length2 * chunk / job->chunkCount; position < end;
+         position++) {
+
+        count += !isspace(job->text2[position]);
+    }
+
+    job->counts2[chunk] = count;
+
+    return 0;
+}
+
+void *CompareSimilarChunk(void *task) {
+
+    //Variable declarations.
+    ChunkJob  *job   = ((ChunkTask *) task)->job;
+    int       chunk  = ((ChunkTask *) task)->chunk;
+    long long total  = job->before1[job->chunkCount];
+    long long first  = total * chunk / job->chunkCount;
+    long long left   = total * (chunk + 1) / job->chunkCount - first;
+    long long sinceCheck = 0;
+    long long position1;
+    long long position2;
+
+    //Both files hold the same non whitespace bytes from here on if similar.
+    position1 = FindNonSpace(job->text1, job->length1, job->before1,
+                             job->chunkCount, first);
+    position2 = FindNonSpace(job->text2, job->length2, job->before2,
+                             job->chunkCount, first);
+
+    while (left > 0) {
+
+        //Check every so often if another chunk found a difference.
+        if (++sinceCheck == CANCEL_CHECK_BYTES) {
+
+            sinceCheck = 0;
+
+            if (__atomic_load_n(&job->stopChunk, __ATOMIC_RELAXED) < 0) {
+                break;
+            }
+        }
+
+        while (isspace(job->text1[position1])) {
+
+            position1++;
+        }
+
+        while (isspace(job->text2[position2])) {
+
+            position2++;
+        }
+
+        //Check if the chars are equal ignoring case.
+        if (tolower(job->text1[position1]) != tolower(job->text2[position2])) {
+
+            //A similarity check needs no place, so stop every chunk.
+            StopAtChunk(job, -1);
+            break;
+        }
+
+        position1++;
+        position2++;
+        left--;
+    }
+
+    return 0;
+}
+
+long long FindNonSpace(unsigned char *text, long long length,
+                       long long *before, int chunkCount, long long index) {
+
+    //Variable declarations.
+    int       chunk = 0;
+    long long position;
+
+    //Find the chunk holding the byte.
+    while (chunk + 1 < chunkCount && before[chunk + 1] <= index) {
+
+        chunk++;
+    }
+
+    index -= before[chunk];
+
+    for (position = length * chunk / chunkCount; position < length;
+         position++) {
+
+        if (!isspace(text[position]) && index-- == 0) {
+            break;
+        }
+    }
+
+    return position;
+}
+
+long long FindTailDifference(unsigned char *text, long long start,
+                             long long length, int last) {
+
+    //Variable declarations.
+    long long position;
+
+    for (position = start; position < length; position++) {
+
+        //Check if the byte breaks the repeat.
+        if (text[position] != last) {
+
+            return position;
+        }
+    }
+
+    return -1;
+}
+
+void StopAtChunk(ChunkJob *job, int chunk) {
+
+    //Variable declarations.
+    int current = __atomic_load_n(&job->stopChunk, __ATOMIC_RELAXED);
+
+    //Lower the stop chunk unless another thread lowered it further.
+    while (chunk < current &&
+           !__atomic_compare_exchange_n(&job->stopChunk, &current, chunk, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+unsigned char *MapFile(char *fileName, long long *length) {
+
+    //Variable declarations.
+    int           file;
+    unsigned char *text = 0;
+    struct stat   fileStat;
+
+    file = OpenFileToRead(fileName);
+
+    //Check the file's size.
+    if (fstat(file, &fileStat) < 0) {
+
+        perror("Error: failed to stat file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    *length = (long long) fileStat.st_size;
+
+    //An empty file cannot be mapped.
+    if (*length > 0) {
+
+        text = mmap(0, (size_t) *length, PROT_READ, MAP_PRIVATE, file, 0);
+
+        //Check if the file was mapped.
+        if (text == MAP_FAILED) {
+
+            perror("Error: mmap failed.\n");
+            exit(COMPARE_FAILED);
+        }
+
+        //Read the chunks ahead of the threads.
+        madvise(text, (size_t) *length, MADV_SEQUENTIAL);
+    }
+
+    close(file);
+
+    return text;
+}
+
+char *DecoderCommand(char *fileName) {
+
+    //Variable declarations.
+    size_t length = strlen(fileName);
+
+    if (length > 4 && strcmp(fileName + length - 4, ".zst") == 0) {
+
+        return "zstd";
+    }
+
+    if (length > 5 && strcmp(fileName + length - 5, ".zstd") == 0) {
+
+        return "zstd";
+    }
+
+    if (length > 4 && strcmp(fileName + length - 4, ".lz4") == 0) {
+
+        return "lz4";
+    }
+
+    return 0;
+}
+
+int StartDecoder(int file, char *fileName, char *command) {
+
+    //Variable declarations.
+    int   pipeFds[2];
+    int   nullFile;
+    pid_t pid;
+
+    //Check that there is room for another decoder.
+    if (decoderCount == MAX_DECODERS) {
+
+        fprintf(stderr, "Error: too many compressed files open.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //The pipe is closed on exec so no other decoder holds it open.
+    if (pipe2(pipeFds, O_CLOEXEC) < 0) {
+
+        perror("Error: pipe failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Let the decoder run ahead of the comparison.
+    fcntl(pipeFds[1], F_SETPIPE_SZ, DECODER_PIPE_SIZE);
+    PrefetchFile(file);
+
+    pid = fork();
+
+    //Check if fork succeeded.
+    if (pid < 0) {
+
+        perror("Error: fork failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    if (pid == 0) {
+
+        //The decoder complains when its pipe closes early, which is fine.
+        nullFile = open("/dev/null", O_WRONLY);
+
+        if (dup2(file, 0) < 0 || dup2(pipeFds[1], 1) < 0 ||
+            (nullFile >= 0 && dup2(nullFile, 2) < 0)) {
+
+            _exit(DECODER_EXEC_FAILED);
+        }
+
+        execlp(command, command, "-dcq", (char *) 0);
+        _exit(DECODER_EXEC_FAILED);
+    }
+
+    close(pipeFds[1]);
+    close(file);
+
+    decoders[decoderCount].fd       = pipeFds[0];
+    decoders[decoderCount].pid      = pid;
+    decoders[decoderCount].fileName = fileName;
+    decoders[decoderCount].length   = 0;
+    decoderCount++;
+
+    return pipeFds[0];
+}
+
+void PrefetchFile(int file) {
+
+    //Variable declarations.
+    unsigned char *map;
+    unsigned char pages[PREFETCH_WINDOW_PAGES];
+    long          pageSize = sysconf(_SC_PAGESIZE);
+    long          page;
+    long          pageCount;
+    long long     offset;
+    long long     window;
+    int           isCached = 1;
+    struct stat   fileStat;
+
+    //Check if there is anything to read.
+    if (fstat(file, &fileStat) < 0 || fileStat.st_size == 0) {
+
+        return;
+    }
+
+    map = mmap(0, (size_t) fileStat.st_size, PROT_READ, MAP_SHARED, file, 0);
+
+    if (map == MAP_FAILED) {
+
+        isCached = 0;
+    }
+
+    //Check a window of pages at a time, the first missing page decides.
+    for (offset = 0; isCached && offset < fileStat.st_size;
+         offset += window) {
+
+        window = (long long) PREFETCH_WINDOW_PAGES * pageSize;
+
+        if (window > fileStat.st_size - offset) {
+
+            window = fileStat.st_size - offset;
+        }
+
+        pageCount = (long) ((window + pageSize - 1) / pageSize);
+
+        if (mincore(map + offset, (size_t) window, pages) < 0) {
+
+            isCached = 0;
+        }
+
+        for (page = 0; isCached && page < pageCount; page++) {
+
+            isCached = pages[page] & 1;
+        }
+    }
+
+    if (map != MAP_FAILED) {
+
+        munmap(map, (size_t) fileStat.st_size);
+    }
+
+    //Check if the whole file is cached, the decoder then never waits.
+    if (isCached) {
+
+        return;
+    }
+
+    posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(file, 0, 0, POSIX_FADV_WILLNEED);
+}
+
+ssize_t ReadFile(int file, void *buffer, size_t size) {
+
+    //Variable declarations.
+    int     status;
+    ssize_t readNum;
+    Decoder *decoder;
+
+    readNum = read(file, buffer, size);
+
+    //Check if the file is a decoder's pipe.
+    if (readNum < 0 || (decoder = FindDecoder(file)) == 0) {
+
+        return readNum;
+    }
+
+    //Count the content, its length is known once it ends.
+    if (readNum > 0 || decoder->pid == 0) {
+
+        decoder->length += readNum;
+
+        return readNum;
+    }
+
+    //Check that the decoder got through the whole file.
+    if (waitpid(decoder->pid, &status, 0) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+
+        fprintf(stderr, "Error: failed to decompress %s.\n",
+                decoder->fileName);
+        exit(COMPARE_FAILED);
+    }
+
+    decoder->pid = 0;
+    RecordDecodedLength(decoder->fileName, decoder->length);
+
+    return 0;
+}
+
+int CloseFile(int file) {
+
+    //Variable declarations.
+    int     retVal;
+    Decoder *decoder;
+
+    decoder = FindDecoder(file);
+    retVal  = close(file);
+
+    //Check if the file was a plain one.
+    if (decoder == 0) {
+
+        return retVal;
+    }
+
+    //A decoder stopped early dies of the closed pipe, which is fine.
+    if (decoder->pid != 0) {
+
+        waitpid(decoder->pid, 0, 0);
+    }
+
+    *decoder = decoders[--decoderCount];
+
+    return retVal;
+}
+
+Decoder *FindDecoder(int file) {
+
+    //Variable declarations.
+    int index;
+
+    for (index = 0; index < decoderCount; index++) {
+
+        if (decoders[index].fd == file) {
+
+            return &decoders[index];
+        }
+    }
+
+    return 0;
+}
+
+unsigned char *LoadFile(char *fileName, long long *length, int *isMapped) {
+
+    //Variable declarations.
+    int           file;
+    long long     capacity = READ_BUFFER_SIZE;
+    ssize_t       readNum;
+    unsigned char *text;
+
+    *isMapped = DecoderCommand(fileName) == 0;
+
+    //Check if the file can be mapped.
+    if (*isMapped) {
+
+        return MapFile(fileName, length);
+    }
+
+    file    = OpenFileToRead(fileName);
+    text    = (unsigned char *) malloc((size_t) capacity);
+    *length = 0;
+
+    //Check if allocation worked.
+    if (text == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Decode into a buffer that doubles when full.
+    while ((readNum = ReadFile(file, text + *length,
+                               (size_t) (capacity - *length))) > 0) {
+
+        *length += readNum;
+
+        if (*length == capacity) {
+
+            capacity *= 2;
+            text      = (unsigned char *) realloc(text, (size_t) capacity);
+
+            //Check if allocation worked.
+            if (text == 0) {
+
+                perror("Error: realloc failed.\n");
+                exit(COMPARE_FAILED);
+            }
+        }
+    }
+
+    //Check if read data.
+    if (readNum < 0) {
+
+        perror("Error while reading from file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    CloseFile(file);
+
+    return text;
+}
+
+void UnloadFile(unsigned char *text, long long length, int isMapped) {
+
+    //Check how the file was loaded.
+    if (text != 0 && isMapped) {
+
+        munmap(text, (size_t) length);
+
+    } else {
+
+        free(text);
+    }
+}
+
+long long FileLength(char *fileName) {
+
+    //Variable declarations.
+    int           file;
+    long long     length = 0;
+    ssize_t       readNum;
+    unsigned char buffer[READ_BUFFER_SIZE];
+    struct stat   fileStat;
+
+    //Check if the file is a plain one.
+    if (DecoderCommand(fileName) == 0) {
+
+        if (stat(fileName, &fileStat) < 0) {
+
+            perror(fileName);
+            exit(COMPARE_FAILED);
+        }
+
+        return (long long) fileStat.st_size;
+    }
+
+    //Check if the content was already decoded to its end.
+    if (FindDecodedLength(fileName, &length)) {
+
+        return length;
+    }
+
+    file = OpenFileToRead(fileName);
+
+    while ((readNum = ReadFile(file, buffer, READ_BUFFER_SIZE)) > 0) {
+
+        length += readNum;
+    }
+
+    //Check if read data.
+    if (readNum < 0) {
+
+        perror("Error while reading from file.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    CloseFile(file);
+
+    return length;
+}
+
+void RecordDecodedLength(char *fileName, long long length) {
+
+    //Variable declarations.
+    long long known;
+
+    //Check if the length is already remembered, or there is no room.
+    if (FindDecodedLength(fileName, &known) || decodedCount == MAX_DECODERS) {
+
+        return;
+    }
+
+    decodedLengths[decodedCount].fileName = fileName;
+    decodedLengths[decodedCount].length   = length;
+    decodedCount++;
+}
+
+int FindDecodedLength(char *fileName, long long *length) {
+
+    //Variable declarations.
+    int index;
+
+    for (index = 0; index < decodedCount; index++) {
+
+        if (strcmp(decodedLengths[index].fileName, fileName) == 0) {
+
+            *length = decodedLengths[index].length;
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,612 @@
+/******************************************
+* Student name: Danny Perov
+* Student ID: 318810637
+* Course Exercise Group: 05
+* Exercise name: Exercise 1
+******************************************/
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include <sys/types.h>
+
+#define BUFFER_SIZE 1
+#define READ_BUFFER_SIZE 65536
+#define TOKEN_SIZE 256
+
+//Comparison modes on top of identical and similar.
+#define MODE_NONE 0
+#define MODE_TOKEN 1
+#define MODE_NUMERIC 2
+#define MODE_LINES 3
+
+//Rows of the edit distance table between two checks of the time budget.
+#define DISTANCE_CHECK_ROWS 256
+#define DISTANCE_MIN_BAND 64
+#define DISTANCE_TIMEOUT -2
+#define MAX_REFERENCES 64
+
+//Exit code when the files could not be compared, apart from the verdicts.
+#define COMPARE_FAILED 4
+
+//Comparing big files in chunks on threads.
+#define MAX_THREADS 64
+#define PARALLEL_MIN_BYTES (1 << 24)
+#define CANCEL_CHECK_BYTES (1 << 20)
+
+//Reading correct outputs compressed with zstd or lz4 through the decoders.
+#define MAX_DECODERS (2 * MAX_REFERENCES + 2)
+#define DECODER_PIPE_SIZE (1 << 20)
+#define DECODER_EXEC_FAILED 127
+#define PREFETCH_WINDOW_PAGES 1024
+
+//Holds the place of the first difference between two files.
+typedef struct {
+
+    //Byte offset of the first difference, -1 if the files are identical.
+    long long offset;
+
+    //Line of the first difference, starting at 1.
+    long line;
+
+    //Column of the first difference, starting at 1.
+    long column;
+
+    //The correct output that matched the longest prefix.
+    int reference;
+} Mismatch;
+
+//Reads a file through a buffer.
+typedef struct {
+
+    //The file.
+    int fd;
+
+    //Amount of bytes in the buffer.
+    int length;
+
+    //Position of the next byte in the buffer.
+    int position;
+
+    //The buffer.
+    unsigned char buffer[READ_BUFFER_SIZE];
+} Reader;
+
+//Holds a decoder streaming a compressed correct output into a pipe.
+typedef struct {
+
+    //Read end of the pipe.
+    int fd;
+
+    //Decoder's process id, 0 once it was waited for.
+    pid_t pid;
+
+    //The compressed file's path.
+    char *fileName;
+
+    //Amount of bytes read from the pipe.
+    long long length;
+} Decoder;
+
+//Holds the length of a compressed file's content once it was decoded.
+typedef struct {
+
+    //The compressed file's path.
+    char *fileName;
+
+    //Length of the decoded content.
+    long long length;
+} DecodedLength;
+
+//Holds the two rows of a banded edit distance table filled row by row.
+typedef struct {
+
+    //The previous row and the row filled last, cell t of row i holds
+    //column i - band + t.
+    long *previous;
+    long *current;
+
+    //Cells away from the diagonal that are filled.
+    long band;
+
+    //Amount of cells in a row.
+    long width;
+
+    //Value of a cell outside the band.
+    long infinity;
+
+    //Amount of rows filled.
+    long row;
+} DistanceTable;
+
+//Holds a comparison of two mapped files split into a chunk per thread.
+typedef struct {
+
+    //The files' contents, 0 for an empty file.
+    unsigned char *text1;
+    unsigned char *text2;
+
+    //The files' sizes.
+    long long length1;
+    long long length2;
+
+    //Amount of chunks, one per thread.
+    int chunkCount;
+
+    //Lowest chunk that found a difference, chunkCount if none did. Chunks
+    //after it stop, since an earlier difference is the one that counts.
+    int stopChunk;
+
+    //Offset of the first difference in every chunk, -1 if none.
+    long long offsets[MAX_THREADS];
+
+    //Non whitespace bytes in every chunk of each file.
+    long long counts1[MAX_THREADS];
+    long long counts2[MAX_THREADS];
+
+    //Non whitespace bytes of each file before every chunk.
+    long long before1[MAX_THREADS + 1];
+    long long before2[MAX_THREADS + 1];
+} ChunkJob;
+
+//Holds the chunk a thread works on.
+typedef struct {
+
+    //The comparison.
+    ChunkJob *job;
+
+    //The chunk's index.
+    int chunk;
+} ChunkTask;
+
+/**
+ * function name: IsFilesIdentical.
+ * The input: file path, file path.
+ * The output: 1 if the files are identical, else 0.
+ * The function operation: Checks if the files are identical.
+*/
+int IsFilesIdentical(char *fileName1, char *fileName2);
+
+/**
+ * function name: IsFilesSimilar.
+ * The input: file path, file path.
+ * The output: 1 if the files are similar, else 0.
+ * The function operation: Checks if the files are similar.
+*/
+int IsFilesSimilar(char *fileName1, char *fileName2);
+
+/**
+ * function name: OpenFileToRead.
+ * The input: file path.
+ * The output: file descriptor.
+ * The function operation: Opens a given file path for reading.
+*/
+int OpenFileToRead(char *fileName);
+
+/**
+ * function name: IsFilesTokenEqual.
+ * The input: file path, file path, boolean compare numbers, absolute
+ * epsilon, relative epsilon.
+ * The output: 1 if the files have the same tokens, else 0.
+ * The function operation: Compares the files token by token, tokens being
+ * runs of non whitespace chars. When comparing numbers, tokens that are both
+ * numbers are equal if they are within the absolute or relative epsilon.
+*/
+int IsFilesTokenEqual(char *fileName1, char *fileName2, int isNumeric,
+                      double absEpsilon, double relEpsilon);
+
+/**
+ * function name: IsFilesLineSetEqual.
+ * The input: file path, file path.
+ * The output: 1 if the files have the same lines in any order, else 0.
+ * The function operation: Compares the multisets of the files' lines by
+ * adding up two independent hashes of every line.
+*/
+int IsFilesLineSetEqual(char *fileName1, char *fileName2);
+
+/**
+ * function name: FindMatchingReference.
+ * The input: correct output paths, amount of them, student's output path,
+ * mismatch to fill.
+ * The output: index of the identical correct output, -1 if none is.
+ * The function operation: Walks all the correct outputs in one pass over
+ * the student's output. The correct outputs that still agree with the
+ * student share the walk along their common prefix and drop out where they
+ * differ. A file that ended goes on as its last byte, as in the byte-wise
+ * comparison. Records the offset, line and column where the last of them
+ * dropped out.
+*/
+int FindMatchingReference(char **references, int referenceCount,
+                          char *studentName, Mismatch *mismatch);
+
+/**
+ * function name: IsFilesEqualInMode.
+ * The input: file path, file path, mode, absolute epsilon, relative
+ * epsilon.
+ * The output: 1 if the files match in the mode, else 0.
+ * The function operation: Runs the mode's comparison.
+*/
+int IsFilesEqualInMode(char *fileName1, char *fileName2, int mode,
+                       double absEpsilon, double relEpsilon);
+
+/**
+ * function name: FindModeReference.
+ * The input: correct output paths, amount of them, student's output path,
+ * mode, absolute epsilon, relative epsilon.
+ * The output: index of the first correct output that matches in the mode,
+ * -1 if none does.
+ * The function operation: Reads the student's output once for all the
+ * correct outputs. In the token modes every correct output still equal
+ * reads its next token against the student's and drops out where they
+ * differ. In the lines mode the student's lines are hashed once and
+ * compared with every correct output's.
+*/
+int FindModeReference(char **references, int referenceCount,
+                      char *studentName, int mode, double absEpsilon,
+                      double relEpsilon);
+
+/**
+ * function name: FindSimilarReference.
+ * The input: correct output paths, amount of them, student's output path.
+ * The output: index of the first similar correct output, -1 if none is.
+ * The function operation: Walks all the correct outputs in one pass over
+ * the student's output, as FindMatchingReference does, comparing the non
+ * whitespace chars in lower case. A correct output drops out where it
+ * differs or ends before the student's output. At the end the files' last
+ * chars are compared as in IsFilesSimilar.
+*/
+int FindSimilarReference(char **references, int referenceCount,
+                         char *studentName);
+
+/**
+ * function name: ReadSimilarChar.
+ * The input: reader, last char to fill.
+ * The output: the next non whitespace char in lower case, -1 at the end of
+ * the file.
+ * The function operation: Skips whitespace and keeps the last char read,
+ * whitespace included.
+*/
+int ReadSimilarChar(Reader *reader, int *last);
+
+/**
+ * function name: BoundedEditDistance.
+ * The input: file path, file path, length of the common prefix, time budget
+ * in milliseconds.
+ * The output: the edit distance, -1 if it was not found within the budget.
+ * The function operation: Skips the common prefix and suffix and runs a
+ * banded edit distance on the rest, doubling the band until the distance
+ * fits in it or the budget runs out.
+*/
+long BoundedEditDistance(char *fileName1, char *fileName2, long long prefix,
+                         long budgetMillis);
+
+/**
+ * function name: BandedEditDistance.
+ * The input: text, length, text, length, band, deadline in milliseconds.
+ * The output: the distance if it is at most the band, else more than the
+ * band, DISTANCE_TIMEOUT if the deadline passed.
+ * The function operation: Fills only the cells of the edit distance table
+ * that are at most band cells away from the diagonal.
+*/
+long BandedEditDistance(unsigned char *text1, long length1,
+                        unsigned char *text2, long length2, long band,
+                        long long deadline);
+
+/**
+ * function name: StreamedEditDistance.
+ * The input: compressed file path, file path, length of the common prefix,
+ * deadline in milliseconds.
+ * The output: the edit distance, -1 if it was not found before the
+ * deadline.
+ * The function operation: Streams the compressed file's decoder output
+ * through the banded table, one row per byte, against the other file. The
+ * decoded content is never kept. A distance outside the band decodes the
+ * file again with a wider band.
+*/
+long StreamedEditDistance(char *fileName1, char *fileName2, long long prefix,
+                          long long deadline);
+
+/**
+ * function name: StartDistanceTable.
+ * The input: table, band, length of the second text.
+ * The output: void.
+ * The function operation: Allocates the table's rows and fills row 0.
+*/
+void StartDistanceTable(DistanceTable *table, long band, long length2);
+
+/**
+ * function name: AddDistanceRow.
+ * The input: table, the first text's next byte, second text, its length.
+ * The output: void.
+ * The function operation: Fills the band's cells of the next row.
+*/
+void AddDistanceRow(DistanceTable *table, unsigned char byte,
+                    unsigned char *text2, long length2);
+
+/**
+ * function name: EndDistanceTable.
+ * The input: table, length of the second text.
+ * The output: the distance if it is at most the band, else more than the
+ * band.
+ * The function operation: Reads the distance from the last row and frees
+ * the rows.
+*/
+long EndDistanceTable(DistanceTable *table, long length2);
+
+/**
+ * function name: NowMillis.
+ * The input: void.
+ * The output: monotonic time in milliseconds.
+ * The function operation: Reads the monotonic clock.
+*/
+long long NowMillis(void);
+
+/**
+ * function name: InitReader.
+ * The input: reader, file path.
+ * The output: void.
+ * The function operation: Opens a file for buffered reading.
+*/
+void InitReader(Reader *reader, char *fileName);
+
+/**
+ * function name: CloseReader.
+ * The input: reader.
+ * The output: void.
+ * The function operation: Closes the reader's file.
+*/
+void CloseReader(Reader *reader);
+
+/**
+ * function name: ReadChar.
+ * The input: reader.
+ * The output: the next byte, -1 at the end of the file.
+ * The function operation: Takes the next byte out of the buffer, refilling
+ * it when empty.
+*/
+int ReadChar(Reader *reader);
+
+/**
+ * function name: ReadToken.
+ * The input: reader, token buffer of TOKEN_SIZE bytes, boolean is the token
+ * continued.
+ * The output: length of the token piece, -1 at the end of the file.
+ * The function operation: Reads the next token. A token longer than the
+ * buffer is returned in pieces, every piece but the last marked as
+ * continued, so memory stays bounded.
+*/
+int ReadToken(Reader *reader, char *token, int *isContinued);
+
+/**
+ * function name: IsNumbersClose.
+ * The input: token, token, absolute epsilon, relative epsilon.
+ * The output: 1 if both are numbers within an epsilon, else 0.
+ * The function operation: Parses both tokens and compares the numbers.
+*/
+int IsNumbersClose(char *token1, char *token2, double absEpsilon,
+                   double relEpsilon);
+
+/**
+ * function name: MixHash.
+ * The input: hash.
+ * The output: mixed hash.
+ * The function operation: Spreads the hash's bits so sums of hashes of
+ * different line sets rarely collide.
+*/
+unsigned long long MixHash(unsigned long long hash);
+
+/**
+ * function name: HashLines.
+ * The input: file path, two sums, line counter.
+ * The output: void.
+ * The function operation: Adds the two hashes of every line of the file
+ * into the sums and counts the lines.
+*/
+void HashLines(char *fileName, unsigned long long *sum1,
+               unsigned long long *sum2, long *lines);
+
+/**
+ * function name: FindMatchingReferenceInChunks.
+ * The input: correct output paths, amount of them, student's output path,
+ * mismatch to fill, amount of threads.
+ * The output: index of the identical correct output, -1 if none is.
+ * The function operation: Like FindMatchingReference, but compares the
+ * student's output with every correct output in chunks on threads.
+*/
+int FindMatchingReferenceInChunks(char **references, int referenceCount,
+                                  char *studentName, Mismatch *mismatch,
+                                  int threadCount);
+
+/**
+ * function name: CompareInChunks.
+ * The input: file path, file path, boolean similar instead of identical,
+ * amount of threads, offset of the first difference to fill or 0.
+ * The output: 1 if the files are identical or similar, else 0.
+ * The function operation: Maps both files and splits them into a chunk per
+ * thread. For identical files every thread compares its byte range. For
+ * similar files every thread first counts the non whitespace bytes of its
+ * range in both files, and the counts' prefix sums then line up chunks that
+ * hold the same non whitespace bytes of the two files. A difference stops
+ * the threads whose chunks come after it.
+*/
+int CompareInChunks(char *fileName1, char *fileName2, int isSimilar,
+                    int threadCount, long long *offset);
+
+/**
+ * function name: RunChunkThreads.
+ * The input: comparison, thread routine.
+ * The output: void.
+ * The function operation: Runs the routine on a thread per chunk and waits
+ * for all of them.
+*/
+void RunChunkThreads(ChunkJob *job, void *(*routine)(void *));
+
+/**
+ * function name: CompareIdenticalChunk.
+ * The input: chunk task.
+ * The output: 0.
+ * The function operation: Compares the chunk's bytes of the two files and
+ * records the first difference.
+*/
+void *CompareIdenticalChunk(void *task);
+
+/**
+ * function name: CountChunk.
+ * The input: chunk task.
+ * The output: 0.
+ * The function operation: Counts the non whitespace bytes of the chunk's
+ * range in each file.
+*/
+void *CountChunk(void *task);
+
+/**
+ * function name: CompareSimilarChunk.
+ * The input: chunk task.
+ * The output: 0.
+ * The function operation: Finds where the chunk's share of the non
+ * whitespace bytes starts in each file and compares them ignoring case.
+*/
+void *CompareSimilarChunk(void *task);
+
+/**
+ * function name: FindNonSpace.
+ * The input: text, length, non whitespace bytes before every chunk, amount
+ * of chunks, index of the wanted non whitespace byte.
+ * The output: offset of the byte, length if there is no such byte.
+ * The function operation: Finds the chunk holding the byte by its count
+ * and scans the chunk for it.
+*/
+long long FindNonSpace(unsigned char *text, long long length,
+                       long long *before, int chunkCount, long long index);
+
+/**
+ * function name: FindTailDifference.
+ * The input: text, offset to start at, length, last byte of the shorter
+ * file.
+ * The output: offset of the first byte that is not the last byte, -1 if
+ * none.
+ * The function operation: Checks the longer file's rest against the
+ * shorter file's last byte, which the byte-wise identity check keeps
+ * comparing once the shorter file ended.
+*/
+long long FindTailDifference(unsigned char *text, long long start,
+                             long long length, int last);
+
+/**
+ * function name: StopAtChunk.
+ * The input: comparison, chunk that found a difference, -1 to stop all.
+ * The output: void.
+ * The function operation: Lowers the comparison's stop chunk.
+*/
+void StopAtChunk(ChunkJob *job, int chunk);
+
+/**
+ * function name: MapFile.
+ * The input: file path, size to fill.
+ * The output: the file's contents, 0 for an empty file.
+ * The function operation: Maps a file for reading.
+*/
+unsigned char *MapFile(char *fileName, long long *length);
+
+/**
+ * function name: DecoderCommand.
+ * The input: file path.
+ * The output: the decoder for the file's extension, 0 for a plain file.
+ * The function operation: Recognizes .zst, .zstd and .lz4 files.
+*/
+char *DecoderCommand(char *fileName);
+
+/**
+ * function name: StartDecoder.
+ * The input: compressed file, its path, decoder.
+ * The output: the read end of a pipe with the decompressed content.
+ * The function operation: Runs the decoder on the open file, so the
+ * content streams through the pipe block by block and never reaches the
+ * disk.
+*/
+int StartDecoder(int file, char *fileName, char *command);
+
+/**
+ * function name: PrefetchFile.
+ * The input: file.
+ * The output: void.
+ * The function operation: Checks with mincore whether the file is already
+ * in the page cache, a window of pages at a time up to the first missing
+ * page. A cached file is left to the decoder as is. Otherwise the kernel is
+ * asked to read the file ahead, so the disk works while the decoder does.
+*/
+void PrefetchFile(int file);
+
+/**
+ * function name: ReadFile.
+ * The input: file, buffer, size.
+ * The output: amount of bytes read, 0 at the end, -1 on failure.
+ * The function operation: Reads a file or a decoder's pipe. The end of a
+ * pipe is only the end of the file if the decoder succeeded, else the
+ * comparison fails.
+*/
+ssize_t ReadFile(int file, void *buffer, size_t size);
+
+/**
+ * function name: CloseFile.
+ * The input: file.
+ * The output: close's result.
+ * The function operation: Closes a file, and waits for its decoder, which
+ * stops once no one reads its pipe.
+*/
+int CloseFile(int file);
+
+/**
+ * function name: FindDecoder.
+ * The input: file.
+ * The output: the file's decoder, 0 for a plain file.
+ * The function operation: Searches the running decoders.
+*/
+Decoder *FindDecoder(int file);
+
+/**
+ * function name: LoadFile.
+ * The input: file path, size to fill, boolean is the content mapped to
+ * fill.
+ * The output: the file's content, 0 for an empty file.
+ * The function operation: Maps a plain file, a compressed one is decoded
+ * into memory.
+*/
+unsigned char *LoadFile(char *fileName, long long *length, int *isMapped);
+
+/**
+ * function name: UnloadFile.
+ * The input: loaded content, its size, boolean is the content mapped.
+ * The output: void.
+ * The function operation: Unmaps a mapped content, frees a decoded one.
+*/
+void UnloadFile(unsigned char *text, long long length, int isMapped);
+
+/**
+ * function name: FileLength.
+ * The input: file path.
+ * The output: the size of the file's content.
+ * The function operation: Stats a plain file. A compressed one that was
+ * already decoded to its end has its length remembered, else it is decoded
+ * and counted.
+*/
+long long FileLength(char *fileName);
+
+/**
+ * function name: RecordDecodedLength.
+ * The input: compressed file path, length of its content.
+ * The output: void.
+ * The function operation: Remembers the length of a file decoded to its
+ * end.
+*/
+void RecordDecodedLength(char *fileName, long long length);
+
+/**
+ * function name: FindDecodedLength.
+ * The input: compressed file path, length to fill.
+ * The output: 1 if the length is known, else 0.
+ * The function operation: Searches the remembered lengths.
+*/
+int FindDecodedLength(char *fileName, long long *length);
+
+#endif
@@ -5,266 +5,259 @@
 * Exercise name: Exercise 1
 ******************************************/
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
-#include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 
-#define BUFFER_SIZE 1
-
-/**
- * function name: IsFilesIdentical.
- * The input: file path, file path.
- * The output: 1 if the files are identical, else 0.
- * The function operation: Checks if the files are identical.
-*/
-int IsFilesIdentical(char *fileName1, char *fileName2);
-
-/**
- * function name: IsFilesSimilar.
- * The input: file path, file path.
- * The output: 1 if the files are similar, else 0.
- * The function operation: Checks if the files are similar.
-*/
-int IsFilesSimilar(char *fileName1, char *fileName2);
+#include "compare.h"
 
 /**
- * function name: OpenFileToRead.
- * The input: file path.
- * The output: file descriptor.
- * The function operation: Opens a given file path for reading.
+ * function name: WriteReport.
+ * The input: report path, mismatch, edit distance, similarity percent,
+ * matched correct output starting at 1 or 0 for none.
+ * The output: void.
+ * The function operation: Writes where the files differ and how much.
 */
-int OpenFileToRead(char *fileName);
+void WriteReport(char *reportName, Mismatch *mismatch, long distance,
+                 double similarity, int reference);
 
 int main(int argc, char *argv[]) {
 
-    //Check that the number of parameters is correct.
-    if (argc != 3) {
-
-        perror("Error: wrong number of parameters.\n");
-
-        return 3;
-    }
+    //Variable declarations.
+    int         mode         = MODE_NONE;
+    int         index        = 1;
+    int         isIdentical;
+    int         matched;
+    int         reference;
+    int         threadCount  = 1;
+    int         isChunked;
+    long        budgetMillis = 0;
+    long        distance     = -1;
+    double      absEpsilon   = 0;
+    double      relEpsilon   = 0;
+    double      similarity   = -1;
+    char        *reportName  = 0;
+    long long   longest;
+    Mismatch    mismatch;
+    struct stat fileStat2;
+
+    //Read the comparison mode flags.
+    while (index + 1 < argc && strncmp(argv[index], "--", 2) == 0) {
+
+        if (strcmp(argv[index], "--mode") == 0) {
+
+            if (strcmp(argv[index + 1], "token") == 0) {
+
+                mode = MODE_TOKEN;
+            } else if (strcmp(argv[index + 1], "numeric") == 0) {
+
+                mode = MODE_NUMERIC;
+            } else if (strcmp(argv[index + 1], "lines") == 0) {
+
+                mode = MODE_LINES;
+            } else {
+
+                fprintf(stderr, "Error: unknown mode %s.\n", argv[index + 1]);
+
+                return COMPARE_FAILED;
+            }
+        } else if (strcmp(argv[index], "--abs-eps") == 0) {
 
-    //Sets the files names.
-    char *fileName1 = argv[1];
-    char *fileName2 = argv[2];
+            absEpsilon = atof(argv[index + 1]);
+        } else if (strcmp(argv[index], "--rel-eps") == 0) {
 
-    int retVal = 0;
+            relEpsilon = atof(argv[index + 1]);
+        } else if (strcmp(argv[index], "--report") == 0) {
 
-    //Compare files.
-    if (isFilesIdentical(fileName1, fileName2)) {
+            reportName = argv[index + 1];
+        } else if (strcmp(argv[index], "--distance-budget") == 0) {
 
-        retVal = 1;
-    } else if (isFilesSimilar(fileName1, fileName2)) {
+            budgetMillis = atol(argv[index + 1]);
+        } else if (strcmp(argv[index], "--threads") == 0) {
 
-        retVal = 2;
-    } else {
+            threadCount = atoi(argv[index + 1]);
 
-        retVal = 3;
-    }
+            //Zero threads means one per processor.
+            if (threadCount == 0) {
 
-    return retVal;
-}
-
-int isFilesIdentical(char *fileName1, char *fileName2) {
-
-    //Variable declaration.
-    char buffer1[BUFFER_SIZE];
-    char buffer2[BUFFER_SIZE];
-    int  file1       = 0;
-    int  file2       = 0;
-    int  stop        = 0;
-    int  readFile1   = 0;
-    int  readFile2   = 0;
-    int  retVal      = 1;
-    int  closeResult = 0;
-
-    //Open files for reading.
-    file1 = openFileToRead(fileName1);
-    file2 = openFileToRead(fileName2);
-
-    while (!stop) {
+                threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+            }
 
-        readFile1 = read(file1, buffer1, 1);
+            if (threadCount < 1) {
 
-        if (readFile1 < 0) {
+                threadCount = 1;
+            }
 
-            perror("Error while reading from file.\n");
-        }
+            if (threadCount > MAX_THREADS) {
 
-        readFile2 = read(file2, buffer2, 1);
+                threadCount = MAX_THREADS;
+            }
+        } else {
 
-        //Check if read data.
-        if (readFile2 < 0) {
+            fprintf(stderr, "Error: unknown parameter %s.\n", argv[index]);
 
-            perror("Error while reading from file.\n");
+            return COMPARE_FAILED;
         }
 
-        //Check if reached end of files.
-        if (readFile1 == 0 && readFile2 == 0) {
+        index += 2;
+    }
 
-            stop = 1;
-        }
+    //Check that the number of parameters is correct.
+    if (argc - index < 2 || argc - index - 1 > MAX_REFERENCES) {
 
-        //Check if the read chars are equal.
-        if (*buffer1 != *buffer2) {
+        perror("Error: wrong number of parameters.\n");
 
-            stop   = 1;
-            retVal = 0;
-        }
+        return COMPARE_FAILED;
     }
 
-    closeResult = close(file1);
+    //Sets the files names, every file but the last is a correct output.
+    char **references    = &argv[index];
+    int  referenceCount  = argc - index - 1;
+    char *fileName2      = argv[argc - 1];
+    char *fileName1;
 
-    //Check if file was closed.
-    if (closeResult < 0) {
+    int retVal = 0;
 
-        perror("Error: failed to close file.\n");
-        exit(1);
-    }
+    //Small outputs are not worth starting threads for.
+    isChunked = threadCount > 1 && stat(fileName2, &fileStat2) == 0 &&
+                fileStat2.st_size >= PARALLEL_MIN_BYTES;
 
-    closeResult = close(file2);
+    //A compressed correct output can only be read from its start.
+    for (reference = 0; reference < referenceCount; reference++) {
 
-    //Check if file was closed.
-    if (closeResult < 0) {
+        if (DecoderCommand(references[reference]) != 0) {
 
-        perror("Error: failed to close file.\n");
-        exit(1);
+            isChunked = 0;
+        }
     }
 
-    return retVal;
-}
+    //Find where the files differ in the same pass that checks identity.
+    if (isChunked) {
 
-int isFilesSimilar(char *fileName1, char *fileName2) {
-
-    //Variable declaration.
-    char buffer1[BUFFER_SIZE];
-    char buffer2[BUFFER_SIZE];
-    int  file1       = 0;
-    int  file2       = 0;
-    int  stop        = 0;
-    int  isLetter1   = 0;
-    int  isLetter2   = 0;
-    int  readFile1   = 0;
-    int  readFile2   = 0;
-    int  retVal      = 1;
-    int  closeResult = 0;
+        matched = FindMatchingReferenceInChunks(references, referenceCount,
+                                                fileName2, &mismatch,
+                                                threadCount);
+    } else {
 
-    //Open files for reading.
-    file1 = openFileToRead(fileName1);
-    file2 = openFileToRead(fileName2);
+        matched = FindMatchingReference(references, referenceCount,
+                                        fileName2, &mismatch);
+    }
 
-    while (!stop) {
+    isIdentical = matched >= 0;
+    fileName1   = references[mismatch.reference];
 
-        isLetter1 = 0;
-        isLetter2 = 0;
+    //Compare files, a match in the chosen mode counts as a correct output.
+    if (isIdentical) {
 
-        //Search for a legal char in file 1.
-        while (!isLetter1) {
+        retVal = 1;
+    } else if ((reference = FindModeReference(references, referenceCount,
+                                              fileName2, mode, absEpsilon,
+                                              relEpsilon)) >= 0) {
 
-            readFile1 = read(file1, buffer1, 1);
+        retVal  = 1;
+        matched = reference;
+    } else if (!isChunked) {
 
-            //Check if read data.
-            if (readFile1 < 0) {
+        matched = FindSimilarReference(references, referenceCount,
+                                       fileName2);
+        retVal  = matched >= 0 ? 2 : 3;
+    } else {
 
-                perror("Error while reading from file.\n");
-                return 3;
-            }
+        //Chunked outputs are mapped, so every correct output's threads read
+        //the student's output from memory, not from the file again.
+        for (reference = 0; retVal == 0 && reference < referenceCount;
+             reference++) {
 
-            //Check if encountered a legal letter.
-            if (readFile1 == 0) {
+            //Check if the outputs are similar.
+            if (CompareInChunks(references[reference], fileName2, 1,
+                                threadCount, 0)) {
 
-                isLetter1 = 1;
+                retVal  = 2;
+                matched = reference;
             }
+        }
 
-            //Check if encountered an illegal letter.
-            if (!isspace(*buffer1) && (*buffer1 != '\n')) {
+        if (retVal == 0) {
 
-                isLetter1 = 1;
-            }
+            retVal = 3;
         }
+    }
 
-        //Search for a legal char in file 2.
-        while (!isLetter2) {
+    //Report how far the files are apart.
+    if (reportName != 0) {
 
-            readFile2 = read(file2, buffer2, 1);
+        //Measure the distance only when asked for and the files differ.
+        if (!isIdentical && budgetMillis > 0) {
 
-            //Check if read data.
-            if (readFile2 < 0) {
+            distance = BoundedEditDistance(fileName1, fileName2,
+                                           mismatch.offset, budgetMillis);
+        }
 
-                perror("Error while reading from file.\n");
-                return 3;
-            }
+        //The similarity is the share of the longer file left unedited.
+        if (distance >= 0) {
 
-            //Check if encountered a legal letter.
-            if (readFile2 == 0) {
+            longest    = FileLength(fileName1);
 
-                isLetter2 = 1;
-            }
+            if (FileLength(fileName2) > longest) {
 
-            //Check if encountered an illegal letter.
-            if ((!isspace(*buffer2)) && (*buffer2 != '\n')) {
-
-                isLetter2 = 1;
+                longest = FileLength(fileName2);
             }
-        }
 
-        //Check if reached end of files.
-        if (readFile1 == 0 && readFile2 == 0) {
-
-            stop = 1;
+            similarity = longest > 0 ?
+                         100.0 * (1.0 - (double) distance / (double) longest) :
+                         100;
         }
 
-        //Convert to lower case chars.
-        *buffer1 = tolower(*buffer1);
-        *buffer2 = tolower(*buffer2);
-
-        //Check if chars are equal.
-        if (*buffer1 != *buffer2) {
+        if (isIdentical) {
 
-            stop   = 1;
-            retVal = 0;
+            similarity = 100;
         }
-    }
-
-    closeResult = close(file1);
 
-    //Check if file was closed.
-    if (closeResult < 0) {
-
-        perror("Error: failed to close file.\n");
-        exit(1);
-    }
-
-    closeResult = close(file2);
-
-    //Check if file was closed.
-    if (closeResult < 0) {
-
-        perror("Error: failed to close file.\n");
-        exit(1);
+        WriteReport(reportName, &mismatch, distance, similarity,
+                    matched + 1);
     }
 
     return retVal;
 }
 
-int openFileToRead(char *fileName) {
+void WriteReport(char *reportName, Mismatch *mismatch, long distance,
+                 double similarity, int reference) {
 
     //Variable declarations.
-    int file = 0;
+    char report[256];
+    int  reportFile;
+    int  length;
 
-    file = open(fileName, O_RDONLY);
+    length = sprintf(report, "offset %lld\nline %ld\ncolumn %ld\n"
+                             "distance %ld\nsimilarity %.1f\nreference %d\n",
+                     mismatch->offset, mismatch->line, mismatch->column,
+                     distance, similarity, reference);
 
-    //Check that file 1 was opened correctly.
-    if (file == -1) {
+    reportFile = open(reportName, O_CREAT | O_TRUNC | O_WRONLY, 0644);
 
-        perror(fileName);
+    //Check that the report was opened.
+    if (reportFile < 0) {
 
-        exit(1);
+        perror(reportName);
+        exit(COMPARE_FAILED);
     }
 
-    return file;
-}
+    //Check that the report was written.
+    if (write(reportFile, report, (size_t) length) != length) {
 
+        perror("Error: failed to write report.\n");
+        exit(COMPARE_FAILED);
+    }
+
+    //Check if file was closed.
+    if (close(reportFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(COMPARE_FAILED);
+    }
+}
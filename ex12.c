@@ -5,16 +5,135 @@
 * Exercise name: Exercise 1
 ******************************************/
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
 #include <memory.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <zlib.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 
+#include "store.h"
+
 #define MAX_SIZE 160
+#define RESULTS_FILE "results.csv"
+#define JOURNAL_FILE "results.journal"
+#define LINE_SIZE 4096
+#define WORKER_BATCH 8
+#define GROUPS_FILE "groups.csv"
+#define HASH_BUFFER_SIZE 65536
+#define HISTORY_FILE "history.csv"
+#define DEFAULT_COMPILE_MICROS 150000
+#define HEAVY_COST_MICROS 1000000
+#define PRECHECK_BATCH 8
+#define CONFIG_KEY_COUNT 23
+#define FEEDBACK_SIZE 512
+
+//Grading several assignments in one run.
+#define CACHE_DIR_TEMPLATE "compile_cache_XXXXXX"
+#define ASSIGNMENT_FILES 6
+
+//Finding C files that share too much code, by winnowing token k-grams.
+#define PLAGIARISM_FILE "plagiarism.csv"
+#define PLAGIARISM_KGRAM 12
+#define PLAGIARISM_WINDOW 4
+#define PLAGIARISM_THRESHOLD 50
+#define PLAGIARISM_MIN_SHARED 4
+#define PLAGIARISM_COMMON 50
+#define PLAGIARISM_MIN_COMMON 10
+#define MAX_PLAGIARISM_THREADS 64
+#define TOKEN_NAME 1
+#define TOKEN_NUMBER 2
+#define TOKEN_STRING 3
+#define TOKEN_CHAR 4
+
+//Transient failures are retried with a doubling pause.
+#define MAX_RETRIES 8
+#define RETRY_MIN_MICROS 1000
+
+//Exit code of a child that could not start its program.
+#define CHILD_EXEC_FAILED 127
+
+//Reading the C files out of submitted zip and tar archives.
+#define ARCHIVE_ZIP 1
+#define ARCHIVE_TAR 2
+#define ARCHIVE_MAX_SOURCE (1 << 24)
+#define ZIP_END_SIZE 22
+#define ZIP_MAX_COMMENT 65535
+#define ZIP_ENTRY_SIZE 46
+#define ZIP_LOCAL_SIZE 30
+#define TAR_BLOCK 512
+
+//Placing the students' runs and the compile jobs on separate cores.
+#define CPU_SYSFS_PATH "/sys/devices/system/cpu"
+#define MAX_NODES 64
+
+//Reading the students directory in big batches of entries.
+#define DIRENT_BUFFER_SIZE (1 << 20)
+#define DIRENT_MIN_SIZE 24
+
+//Watching the students tree for new submissions.
+#define WATCH_DEBOUNCE_MICROS 2000000
+#define WATCH_BUFFER_SIZE 65536
+#define WATCH_EVENTS (IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | \
+                      IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE)
+
+//The results store, its format is shared with the query tool.
+#define STORE_FILE "results.col"
+
+//Hardware counters measured on a student's runs.
+#define COUNTER_INSTRUCTIONS 0
+#define COUNTER_CYCLES 1
+#define COUNTER_CACHE_MISSES 2
+#define COUNTER_BRANCH_MISSES 3
+#define COUNTER_TASK_CLOCK 4
+#define COUNTER_COUNT 5
+
+//Verdicts of a graded student, the comparison ones match comp.out's codes.
+#define VERDICT_GREAT_JOB 1
+#define VERDICT_SIMILAR_OUTPUT 2
+#define VERDICT_BAD_OUTPUT 3
+#define VERDICT_COMPILATION_ERROR 4
+#define VERDICT_TIMEOUT 5
+#define VERDICT_OUTPUT_LIMIT 6
+#define VERDICT_INTERNAL_ERROR 7
+#define VERDICT_COUNT 8
+
+//Verdicts only kept in the results store.
+#define VERDICT_NO_C_FILE VERDICT_COUNT
+#define VERDICT_MULTIPLE_DIRECTORIES (VERDICT_COUNT + 1)
+
+//Grading stages timed for the statistics.
+#define STAGE_COMPILE 0
+#define STAGE_EXECUTE 1
+#define STAGE_COMPARE 2
+#define STAGE_COUNT 3
+#define HISTOGRAM_BUCKETS 16
+#define STATS_INTERVAL 1000000
+#define MAX_COMPARE_FLAGS 10
+#define MAX_REFERENCES 64
+#define TIMEOUT_MICROS 5000000
+#define POLL_MIN_MICROS 1000
+#define POLL_MAX_MICROS 100000
 
 //Holds the the student's status
 typedef struct {
@@ -33,14 +152,14 @@ typedef struct {
 typedef struct {
 
     //Student's feedback.
-    char feedback[MAX_SIZE];
+    char feedback[FEEDBACK_SIZE];
 
     //Student's grade.
     int grade;
 } Result;
 
 //Holds the students info.
-typedef struct {
+typedef struct Student {
 
     //Student's name.
     char *name;
@@ -54,6 +173,9 @@ typedef struct {
     //Student's executable file path.
     char *execFilePath;
 
+    //Student's output file path.
+    char *outputFilePath;
+
     //The path to the main directory of students.
     char *homePath;
 
@@ -63,12 +185,92 @@ typedef struct {
     //Depth to c file.
     int depth;
 
+    //Student's position in the list of students being graded.
+    int index;
+
+    //Hash of the C file's content.
+    unsigned long long sourceHash;
+
+    //Size of the C file.
+    off_t sourceSize;
+
+    //Boolean is the C file identical to an earlier student's one.
+    int isDuplicate;
+
+    //Next student with an identical C file, graded through this one.
+    struct Student *nextDuplicate;
+
+    //Time in microseconds every stage took, -1 if it did not run.
+    long long stageTimes[STAGE_COUNT];
+
+    //Path of the comparator's report.
+    char *reportFilePath;
+
+    //Line and column where the output first went wrong, 0 if unknown.
+    long mismatchLine;
+    long mismatchColumn;
+
+    //Percent of the correct output the student's output kept, -1 unknown.
+    double similarity;
+
+    //The correct output the student's output matched, starting at 1.
+    int matchedReference;
+
+    //The test case that failed, starting at 1, 0 if none or only one case.
+    int failedCase;
+
+    //Expected grading time in microseconds, used to order the students.
+    long long predictedCost;
+
+    //Time running took in the previous run in microseconds, -1 if unknown.
+    long long previousRunTime;
+
+    //Boolean is the student with a worker right now.
+    int isDispatched;
+
+    //The worker the student was last sent to, -1 if none.
+    int worker;
+
+    //Boolean was the student's result written.
+    int isFinished;
+
+    //The student's verdict.
+    int verdict;
+
+    //Counter totals over the student's runs, -1 if not measured.
+    long long counters[COUNTER_COUNT];
+
+    //Amount of test cases the student ran.
+    int casesRun;
+
     //Boolean does the student have multiple directories.
     int isMultipleDirectories;
 
     //Boolean did the student receive a timeout.
     int isTimeOut;
 
+    //Boolean did the student's output go over the output limit.
+    int isOutputLimit;
+
+    //Boolean did grading the student fail for a reason of the grader's.
+    int isInternalError;
+
+    //Name of the archive the student handed in, 0 for a directory.
+    char *archiveName;
+
+    //Memory file with the C file unpacked from the archive, -1 for a C file
+    //of a directory. Unpacked once, every stage reopens it.
+    int sourceFile;
+
+    //Options of the assignment the student is graded for.
+    struct Options *options;
+
+    //Distinct winnowed fingerprints of the C file, sorted, 0 if not taken.
+    unsigned int *fingerprints;
+
+    //Amount of fingerprints.
+    int fingerprintCount;
+
     //Student's status.
     Status status;
 
@@ -77,900 +279,9623 @@ typedef struct {
 
 } Student;
 
-/**
- * function name: WriteToFile.
- * The input: file descriptor, message to write.
- * The output: void.
- * The function operation: Writes a message to the given file.
-*/
-void WriteToFile(int file, char *message);
+//Holds a growing list of students.
+typedef struct {
 
-/**
- * function name: ReadFromFile.
- * The input: file descriptor, array.
- * The output: void.
- * The function operation: Reads a line from a file into the given buffer.
-*/
-void ReadFromFile(int fileDesc, char *buffer);
+    //The students.
+    Student **items;
 
-/**
- * function name: FindCFile.
- * The input: initial path to search, student struct.
- * The output: path if found, else NULL.
- * The function operation: Searches for a C file in the given directory.
-*/
-char *
-FindCFile(char *initPath, Student *student);
+    //Amount of students in the list.
+    int count;
 
-/**
- * function name: IsDirectory.
- * The input: file path.
- * The output: boolean
- * The function operation: Checks if the given path belongs to a directory.
-*/
-int IsDirectory(char *path);
+    //Amount of students the list has room for.
+    int capacity;
+} StudentList;
 
-/**
- * function name: IsCFile.
- * The input: path
- * The output:  1 true, 0 false.
- * The function operation: Checks that the given path leads to a C file.
-*/
-int IsCFile(char *path);
+//Holds one input and the outputs accepted for it.
+typedef struct {
 
-/**
- * function name: InitStudent.
- * The input: dirent, path.
- * The output: Student.
- * The function operation: Initializes a student.
-*/
-Student *InitStudent(struct dirent *studentDirent, char *dirPath);
+    //Path to the input file.
+    char *inputPath;
 
-/**
- * function name: WaitForChildExec.
- * The input: status.
- * The output: -1 exec failed, 0 program failed, 1 succeeded.
- * The function operation: Waits for the child to finish execution.
-*/
-int WaitForChildExec(int *status);
+    //Paths to the accepted correct output files, ending with 0.
+    char *outputPaths[MAX_REFERENCES + 1];
 
-/**
- * function name: CompileStudentFile.
- * The input: *Student
- * The output: 0 if failed, 1 if succeeded.
- * The function operation: Compiles the student's C file.
-*/
-int CompileStudentFile(Student *student);
+    //Amount of accepted correct output files.
+    int outputCount;
 
-/**
- * function name: ExecuteStudentFile.
- * The input: student, input file path.
- * The output:  0 if failed, 1 if succeeded.
- * The function operation: Executes the student's C file.
-*/
-int ExecuteStudentFile(Student *student, char *inputFilePath);
+    //Sealed memory file with the input, read once and reopened by every
+    //student.
+    int inputFile;
+} TestCase;
 
-/**
- * function name: CompareStudentFile.
- * The input: student, correct output path,  student's output path.
- * The output: -1 different, 0 similar, 1 same.
- * The function operation: Compares between the correct and student's outputs.
-*/
-int CompareStudentFile(Student *student, char *correctOutput,
-                       char *studentOutput);
+//Holds the cores of an execution slot, a worker or the grader itself.
+typedef struct {
 
-/**
- * function name: HandleNoCFile.
- * The input: student.
- * The output: void.
- * The function operation: Handles the case in which a C file was not found.
-*/
-void HandleNoCFile(Student *student);
+    //The core the slot's students run on, and nothing else of the grader.
+    int execCpu;
 
-/**
- * function name: WriteStudentResult.
- * The input: student.
- * The output: void.
- * The function operation: Writes the student's result into the results file.
-*/
-void WriteStudentResult(Student *student);
+    //NUMA node of the core.
+    int node;
 
-/**
- * function name: TimeoutHandler.
- * The input: process id, status.
- * The output: 0 timeout, 1 no timeout.
- * The function operation:  Handles process timeout.
-*/
-int TimeoutHandler(pid_t pid, int *status);
+    //The cores the slot compiles and compares on, of its node if it has any.
+    cpu_set_t compileCpus;
+} CpuSlot;
 
-/**
- * function name: FreeStudent.
- * The input: student.
- * The output: void.
- * The function operation: Frees the student and his content.
-*/
-void FreeStudent(Student *student);
+//Holds the command line flags.
+typedef struct Options {
 
-/**
- * function name: HandleCompilationError.
- * The input: student.
- * The output: void.
- * The function operation:  Handles compilation error of student's file.
-*/
-void HandleCompilationError(Student *student);
+    //Path to the configuration file.
+    char *configPath;
 
-/**
- * function name: HandleComparisonResult.
- * The input: student.
- * The output: comparison result.
- * The function operation: Handle student's comparison result.
-*/
-void HandleComparisonResult(Student *student, int compareResult);
+    //Paths of every assignment's configuration file.
+    char **configPaths;
 
-/**
- * function name: HandleTimeout.
- * The input: student.
- * The output: void.
- * The function operation: Handles timeout of student's file.
-*/
-void HandleTimeout(Student *student);
+    //Amount of assignments graded in this run.
+    int configCount;
 
-int main(int argc, char *argv[]) {
+    //Position of this assignment among the configuration files.
+    int assignment;
 
-    //Check that the number of command line arguments is correct.
-    if (argc != 2) {
+    //Paths of the files the assignment's results are written to.
+    char *resultsPath;
+    char *journalPath;
+    char *groupsPath;
+    char *storePath;
 
-        perror("Error: wrong number of parameters.\n");
-        exit(1);
-    }
+    //Directory of the programs compiled for every assignment, 0 for none.
+    char *cacheDir;
 
-    //Variable declarations.
-    char          *mainPath;
-    char          *studentPath = 0;
-    char          dirPath[MAX_SIZE];
-    char          inputPath[MAX_SIZE];
-    char          outputPath[MAX_SIZE];
-    char          studentDir[MAX_SIZE];
-    int           configFile;
-    int           results;
-    int           closeValue;
-    DIR           *mainDir;
-    struct dirent *studentDirent;
+    //Boolean compare the C files with each other after the grading.
+    int isPlagiarism;
 
-    //Holds the main path to student's directory.
-    mainPath = argv[1];
+    //Percent of the uncommon fingerprints of the C file with fewer that two
+    //files must share to be reported.
+    int plagiarismThreshold;
 
-    //Open configuration file.
-    configFile = open(mainPath, O_RDONLY);
+    //Percent of the C files a fingerprint must be found in to count as
+    //code that came with the assignment.
+    int plagiarismCommon;
 
-    //Check if the file was opened.
-    if (configFile < 0) {
+    //C file the assignment handed out, its code is never reported, 0 if
+    //none.
+    char *plagiarismStarter;
 
-        perror("Error: failed to open file.\n");
-        exit(1);
-    }
+    //Path of the report of the similar C files.
+    char *plagiarismPath;
 
-    //Read the file paths.
-    ReadFromFile(configFile, dirPath);
-    ReadFromFile(configFile, inputPath);
-    ReadFromFile(configFile, outputPath);
+    //The configuration file's content the paths point into.
+    char *configContent;
 
-    closeValue = close(configFile);
+    //Path to the main directory of students.
+    char *dirPath;
 
-    //Check if the file was closed.
-    if (closeValue < 0) {
+    //Path of the grading cost history.
+    char *historyPath;
 
-        perror("Error: failed to close file.\n");
-        exit(1);
-    }
+    //Boolean continue an interrupted run from its journal.
+    int isResume;
 
-    mainDir = opendir(dirPath);
+    //Amount of worker processes, 0 grades in this process.
+    int workers;
 
-    //Check if the directory eas opened.
-    if (mainDir == 0) {
+    //Largest output in bytes a student may write, 0 for no limit.
+    long outputLimit;
 
-        perror("Error: failed to open directory.\n");
-        exit(1);
-    }
+    //Path to the input file.
+    char *inputPath;
 
-    //Creates the results file.
-    results = open("results.csv", O_CREAT, 0777);
+    //Paths to the accepted correct output files, ending with 0.
+    char *outputPaths[MAX_REFERENCES + 1];
 
-    //Check if results file was opened.
-    if (results < 0) {
+    //Amount of accepted correct output files.
+    int outputCount;
 
-        perror("Error: failed to open file.\n");
-        exit(1);
-    }
+    //Path of the statistics file, 0 for none.
+    char *statsPath;
 
-    //Close the results file.
-    closeValue = close(results);
+    //Extra flags for the comparator, ending with 0.
+    char *compareFlags[MAX_COMPARE_FLAGS + 1];
 
-    //Check if closed file.
-    if (closeValue < 0) {
+    //Amount of extra flags for the comparator.
+    int compareFlagCount;
 
-        perror("Error: failed to close file.\n");
-        exit(1);
-    }
+    //Boolean report where a bad output went wrong.
+    int isDiffFeedback;
 
-    //Run over all the students.
-    while ((studentDirent = readdir(mainDir)) != 0) {
+    //Boolean check the C files' syntax ahead of grading.
+    int isPrecheck;
 
-        //Check if read from directory.
-        if (studentDirent == 0) {
+    //Boolean measure the students' runs with hardware counters.
+    int isPerf;
 
-            perror("Error: failed to read from directory.\n");
-            exit(1);
-        }
+    //Booleans can every counter be opened on this machine.
+    int isCounterAvailable[COUNTER_COUNT];
 
-        //Ignore inner directories.
-        if (strcmp(studentDirent->d_name, ".") == 0 ||
-            strcmp(studentDirent->d_name, "..") == 0) {
-            continue;
-        }
+    //Path of the test case list, 0 for the configuration's only case.
+    char *testsPath;
 
-        Student *student;
+    //The test cases every student runs.
+    TestCase *testCases;
 
-        //Initialize student.
-        student = InitStudent(studentDirent, dirPath);
+    //Amount of test cases.
+    int testCaseCount;
 
-        //Search for the student's C file.
-        studentPath = FindCFile(dirPath, student);
+    //Boolean keep grading the students whose submissions change.
+    int isWatch;
 
-        student->cFilePath = studentPath;
+    //Time a student's files must stay unchanged before grading, in
+    //microseconds.
+    long long watchDebounce;
 
-        //Check if C file was found.
-        if (student->cFilePath == 0) {
+    //Boolean pin the students' runs and the compile jobs to their cores.
+    int isAffinity;
 
-            HandleNoCFile(student);
+    //Cores of every execution slot.
+    CpuSlot *cpuSlots;
 
-        } else {
+    //The cores none of the slots runs students on.
+    cpu_set_t compilePool;
 
-            //Variable declarations.
-            int compileResult;
-            int executeResult;
-            int compareResult;
-            int chDirResult;
-            int unlinkResult;
+    //Execution slot of this process.
+    int cpuSlot;
+} Options;
 
-            //Set student's grade tp 100 - 10 * depth.
-            student->result.grade = 100 - (10 * student->depth);
+//Holds the live statistics of the run.
+typedef struct {
 
-            //Compiles the C file.
-            compileResult = CompileStudentFile(student);
+    //Path of the statistics file, 0 for none.
+    char *path;
 
-            //Check if compilation failed.
-            if (compileResult == 0) {
+    //Start time of the run in microseconds.
+    long long startTime;
 
-                HandleCompilationError(student);
-                continue;
-            }
+    //Last time the statistics file was written.
+    long long lastWrite;
 
-            //Executes the C file.
-            executeResult = ExecuteStudentFile(student, inputPath);
+    //Amount of students found in the students directory.
+    int discovered;
 
-            //Unlinks exe file.
-            unlinkResult = unlink("student.out");
+    //Amount of students skipped since the journal had them.
+    int skipped;
 
-            //Check if unlinked file.
-            if (unlinkResult < 0) {
+    //Amount of students with a C file.
+    int located;
 
-                perror("Error: failed to unlink file.\n");
-                exit(1);
-            }
+    //Amount of students whose result was written.
+    int written;
 
-            //Check if there was a timeout.
-            if (student->isTimeOut) {
+    //Amount of students that got another student's verdict.
+    int duplicates;
 
-                HandleTimeout(student);
-                continue;
-            }
+    //Amount of students without a C file.
+    int noCFile;
 
-            //Compare the student's result to the correct answer.
-            compareResult = CompareStudentFile(student, outputPath,
-                                               "studentOutput.txt");
+    //Amount of students with multiple directories.
+    int multipleDirectories;
 
-            //Handle comparison result.
-            HandleComparisonResult(student, compareResult);
+    //Amount of compilation errors found by the syntax pre-check.
+    int prechecked;
 
-            //Unlink student's output file.
-            unlinkResult = unlink("studentOutput.txt");
+    //Amount of students graded again after their submission changed.
+    int regraded;
 
-            //Check if unlinked file.
-            if (unlinkResult < 0) {
+    //Boolean did the discovery finish.
+    int isDiscoveryDone;
 
-                perror("Error: failed to unlink file.\n");
-                exit(1);
-            }
-        }
+    //Amount of students that went through every stage.
+    int stageDone[STAGE_COUNT];
 
-        //Write student's result.
-        WriteStudentResult(student);
+    //Total time spent in every stage in microseconds.
+    long long stageTotal[STAGE_COUNT];
 
-        FreeStudent(student);
-    }
+    //Sum of the squared stage times in milliseconds, for their spread.
+    double stageSquares[STAGE_COUNT];
 
-    //Close main directory.
-    closeValue = closedir(mainDir);
+    //Amount of students whose run time is known from the previous run.
+    int runChanges;
 
-    //Check if directory was closed.
-    if (closeValue < 0) {
+    //Sum of the relative run time changes from the previous run.
+    double runChangeTotal;
 
-        perror("Error: failed to close directory.\n");
-        exit(1);
-    }
-}
+    //Sum of the squared relative run time changes.
+    double runChangeSquares;
 
-char *FindCFile(char *initPath, Student *student) {
+    //Amount of stage runs in power of two millisecond buckets.
+    int histograms[STAGE_COUNT][HISTOGRAM_BUCKETS];
 
-    //Variable declarations.
-    int  stop        = 0;
-    int  dirCounter  = 0;
-    int  isCFound    = 0;
-    int  closeResult = 0;
-    char finalPath[MAX_SIZE];
-    char nextFile[MAX_SIZE];
-    DIR  *dir;
+    //Amount of students per verdict.
+    int verdicts[VERDICT_COUNT];
 
-    //Set path name.
-    strcpy(finalPath, initPath);
-    strcat(finalPath, "/");
-    strcat(finalPath, student->dirent->d_name);
+    //Amount of students waiting in the coordinator's queue.
+    int pending;
 
-    while (!stop) {
+    //Amount of workers.
+    int workerCount;
 
-        //Check if found the C file.
-        if (isCFound) {
+    //Amount of students every worker holds.
+    int *workerOutstanding;
 
-            //Return final path.
-            char *retPath = (char *) malloc(
-                    strlen(finalPath) * sizeof(char) + 1);
+    //Time every worker spent grading in microseconds.
+    long long *workerBusy;
+} Stats;
 
-            strcpy(retPath, finalPath);
-            strcat(retPath, "\0");
+//Buffers the lines received on a socket.
+typedef struct {
 
-            return retPath;
-        }
+    //The socket.
+    int fd;
 
-        dir = opendir(finalPath);
+    //Amount of buffered bytes.
+    int length;
 
-        //Check if directory was opened.
-        if (dir == 0) {
+    //The buffered bytes.
+    char buffer[LINE_SIZE];
+} LineReader;
 
-            perror("Error: failed to open directory.\n");
-            exit(1);
-        }
+//Holds the coordinator's view of a worker process.
+typedef struct {
 
-        student->depth += 1;
+    //Worker's process id.
+    pid_t pid;
 
-        dirCounter = 0;
+    //Worker's lines.
+    LineReader reader;
 
-        //Checks the amount of folders the student has is legal.
-        while ((student->dirent = readdir(dir)) != 0) {
+    //Amount of students sent to the worker and not finished yet.
+    int outstanding;
 
-            //Check if read from directory.
-            if (student->dirent == 0) {
+    //Boolean is the worker out of work.
+    int isIdle;
 
-                perror("Error: failed to read directory.\n");
-                exit(1);
-            }
+    //Boolean was the worker asked to give back work.
+    int isStealPending;
 
-            if (strcmp(student->dirent->d_name, ".") == 0 ||
-                strcmp(student->dirent->d_name, "..") == 0) {
-                continue;
-            }
+    //Boolean is the worker still running.
+    int isAlive;
+} Worker;
 
-            char temp[MAX_SIZE];
-            strcpy(temp, finalPath);
-            strcat(temp, "/");
-            strcat(temp, student->dirent->d_name);
+//Holds what grading a student cost in a previous run.
+typedef struct {
 
-            if (IsDirectory(temp)) {
+    //Student's name.
+    char *name;
 
-                strcpy(nextFile, temp);
-                dirCounter++;
-            } else if (IsCFile(temp)) {
+    //Size of the C file.
+    long long sourceSize;
 
-                strcpy(nextFile, temp);
-                isCFound = 1;
-                break;
-            }
-        }
+    //Time compiling took in microseconds.
+    long long compileTime;
 
-        closeResult = closedir(dir);
+    //Time executing and comparing took in microseconds.
+    long long runTime;
 
-        //Check if the directory was closed.
-        if (closeResult < 0) {
+    //Boolean was the student found again in this run.
+    int isUsed;
+} HistoryEntry;
 
-            perror("Error: failed to close directory");
-            exit(1);
-        }
+//Holds the grading costs of the previous runs.
+typedef struct {
 
-        //Stop searching if more that on inner folder exists.
-        if ((dirCounter > 1) && !isCFound) {
+    //The entries, sorted by name.
+    HistoryEntry *entries;
 
-            student->isMultipleDirectories = 1;
+    //Amount of entries.
+    int count;
 
-            return 0;
-        }
+    //The raw history content the names point into.
+    char *content;
+} History;
 
-        //Check if there were sub-directories.
-        if (dirCounter == 0 && !isCFound) {
+//Holds one student's row of the results store.
+typedef struct {
 
-            return 0;
+    //Student's name.
+    char *name;
+
+    //Student's grade.
+    int grade;
+
+    //Student's verdict, 0 if unknown.
+    int verdict;
+
+    //Depth to the C file, -1 if unknown.
+    int depth;
+
+    //Time every stage took in microseconds, -1 if unknown.
+    long long stageTimes[STAGE_COUNT];
+} StoreRow;
+
+//Holds the progress journal of a previous run.
+typedef struct {
+
+    //Names of the students that were already graded, sorted.
+    char **names;
+
+    //Amount of graded students.
+    int count;
+
+    //The raw journal content the names point into.
+    char *content;
+} Journal;
+
+//Holds a file or directory inside a submitted archive.
+typedef struct {
+
+    //Path inside the archive, directories end without a slash.
+    char *name;
+
+    //Boolean is the entry a directory.
+    int isDirectory;
+
+    //Offset of the entry's zip header or of its tar data.
+    long long offset;
+
+    //Size of the entry's data as stored.
+    long long size;
+
+    //Zip compression method, 0 for stored data.
+    int method;
+} ArchiveMember;
+
+//Holds the table of contents of a submitted archive.
+typedef struct {
+
+    //ARCHIVE_ZIP or ARCHIVE_TAR.
+    int type;
+
+    //The entries.
+    ArchiveMember *members;
+
+    //Amount of entries.
+    int count;
+
+    //Amount of entries there is room for.
+    int capacity;
+} Archive;
+
+//Holds a directory entry as getdents64 returns it.
+typedef struct {
+
+    //Inode number.
+    unsigned long long inode;
+
+    //Position of the next entry.
+    long long offset;
+
+    //Size of this entry.
+    unsigned short length;
+
+    //File type, DT_UNKNOWN if the file system does not tell.
+    unsigned char type;
+
+    //Null terminated name.
+    char name[];
+} LinuxDirent;
+
+//Reads a directory a buffer of entries at a time.
+typedef struct {
+
+    //The directory.
+    int fd;
+
+    //Buffer the kernel fills with entries.
+    char *buffer;
+
+    //Names of the entries of the last batch, pointing into the buffer.
+    char **names;
+} DirLister;
+
+//Holds a watched directory of the students tree.
+typedef struct {
+
+    //Watch descriptor, -1 once the directory is gone.
+    int wd;
+
+    //Path of the directory.
+    char *path;
+
+    //Name of the student the directory belongs to, 0 for the main one.
+    char *name;
+} WatchedDir;
+
+//Holds a student whose files changed lately.
+typedef struct {
+
+    //Student's name.
+    char *name;
+
+    //Time of the last change in microseconds.
+    long long lastChange;
+} Change;
+
+//Holds the watch over the students tree.
+typedef struct {
+
+    //The inotify descriptor.
+    int fd;
+
+    //Signal descriptor for the signals that end the watch.
+    int signalFd;
+
+    //The signals that end the watch.
+    sigset_t signals;
+
+    //The watched directories.
+    WatchedDir *dirs;
+
+    //Amount of watched directories.
+    int dirCount;
+
+    //Amount of directories there is room for.
+    int dirCapacity;
+
+    //Students waiting for their files to settle.
+    Change *changes;
+
+    //Amount of waiting students.
+    int changeCount;
+
+    //Amount of waiting students there is room for.
+    int changeCapacity;
+} Watcher;
+
+//Holds a line of the results file while the file is rewritten.
+typedef struct {
+
+    //The line, without its end.
+    char *line;
+
+    //Length of the student's name at the start of the line.
+    size_t nameLength;
+
+    //Position of the line in the file.
+    int position;
+} ResultLine;
+
+//Holds a fingerprint and the C file it came from, an inverted index entry.
+typedef struct {
+
+    //The fingerprint.
+    unsigned int print;
+
+    //Position of the C file's student in the list being compared.
+    int source;
+
+    //Position of the fingerprint among all the students' fingerprints.
+    int position;
+} PrintEntry;
+
+//Holds two C files that share too many fingerprints.
+typedef struct {
+
+    //The two students, in the order of their names.
+    Student *first;
+    Student *second;
+
+    //Amount of fingerprints they share.
+    int shared;
+
+    //Percent they share of the uncommon fingerprints of the file with fewer.
+    int percent;
+} SimilarPair;
+
+//Holds what the threads of the similarity stage share.
+typedef struct {
+
+    //The students whose C files are compared.
+    StudentList *students;
+
+    //Every fingerprint of every student, sorted by fingerprint.
+    PrintEntry *entries;
+
+    //Amount of entries.
+    int entryCount;
+
+    //Position of every student's first fingerprint.
+    int *offsets;
+
+    //First entry of every fingerprint's C files by its position, -1 if
+    //it came with the assignment.
+    int *postings;
+
+    //Amount of every student's fingerprints that are not too common.
+    int *rareCounts;
+
+    //Least percent of shared fingerprints to report.
+    int threshold;
+
+    //Amount of threads.
+    int threadCount;
+} SimilarityJob;
+
+//Holds the work and the findings of one thread of the similarity stage.
+typedef struct {
+
+    //The shared work.
+    SimilarityJob *job;
+
+    //The thread's position, it scores every threadCount-th student.
+    int thread;
+
+    //Pairs the thread found.
+    SimilarPair *pairs;
+
+    //Amount of pairs found.
+    int pairCount;
+
+    //Amount of pairs there is room for.
+    int pairCapacity;
+} SimilarityTask;
+
+//Holds the students of one assignment of the run.
+typedef struct {
+
+    //Students with a C file, in the order they were found.
+    StudentList students;
+
+    //One student of every group of identical C files, by predicted cost.
+    StudentList representatives;
+
+    //Students without a C file to grade.
+    StudentList unfound;
+
+    //Progress journal of the previous run.
+    Journal journal;
+
+    //Grading cost history.
+    History history;
+} Assignment;
+
+/**
+ * function name: WriteToFile.
+ * The input: file descriptor, message to write.
+ * The output: 0 on success, -1 if the message could not be written.
+ * The function operation: Writes a message to the given file.
+*/
+int WriteToFile(int file, char *message);
+
+/**
+ * function name: FindCFile.
+ * The input: initial path to search, student struct.
+ * The output: path if found, else NULL.
+ * The function operation: Searches for a C file in the given directory.
+*/
+char *
+FindCFile(char *initPath, Student *student);
+
+/**
+ * function name: IsDirectory.
+ * The input: file path.
+ * The output: boolean
+ * The function operation: Checks if the given path belongs to a directory.
+*/
+int IsDirectory(char *path);
+
+/**
+ * function name: IsCFile.
+ * The input: path
+ * The output:  1 true, 0 false.
+ * The function operation: Checks that the given path leads to a C file.
+*/
+int IsCFile(char *path);
+
+/**
+ * function name: InitStudent.
+ * The input: student's directory name, path.
+ * The output: Student.
+ * The function operation: Initializes a student.
+*/
+Student *InitStudent(char *name, char *dirPath);
+
+/**
+ * function name: WaitForChildExec.
+ * The input: child's process id, status.
+ * The output: -1 exec or wait failed, 0 program failed, 1 succeeded.
+ * The function operation: Waits for the child to finish execution.
+*/
+int WaitForChildExec(pid_t pid, int *status);
+
+/**
+ * function name: CompileStudentFile.
+ * The input: *Student
+ * The output: -1 if gcc could not run, 0 if failed, 1 if succeeded.
+ * The function operation: Compiles the student's C file.
+*/
+int CompileStudentFile(Student *student);
+
+/**
+ * function name: ExecuteStudentFile.
+ * The input: student, open executable, test case, options.
+ * The output: -1 if the program could not run, 0 on timeout, 1 if it ran.
+ * The function operation: Executes the student's program on the test case.
+ * The input is the test case's sealed memory file, reopened at its start. A
+ * student that writes more than the output limit is killed by the kernel on
+ * the spot. The counters, when asked for, are attached before the program
+ * starts and added to the student's totals.
+*/
+int ExecuteStudentFile(Student *student, int execFile, TestCase *testCase,
+                       Options *options);
+
+/**
+ * function name: CompareStudentFile.
+ * The input: student, correct output paths ending with 0,  student's output
+ * path, extra comparator flags, report path or 0.
+ * The output: comp.out's verdict, -1 if the comparison failed.
+ * The function operation: Compares between the correct and student's
+ * outputs, any of the correct outputs is accepted.
+*/
+int CompareStudentFile(Student *student, char **correctOutputs,
+                       char *studentOutput, char **compareFlags,
+                       char *reportPath);
+
+/**
+ * function name: ReadCompareReport.
+ * The input: student.
+ * The output: 0 on success, -1 on failure.
+ * The function operation: Reads where the student's output first differs
+ * and how similar it is from the comparator's report.
+*/
+int ReadCompareReport(Student *student);
+
+/**
+ * function name: HandleNoCFile.
+ * The input: student.
+ * The output: void.
+ * The function operation: Handles the case in which a C file was not found.
+*/
+void HandleNoCFile(Student *student);
+
+/**
+ * function name: WriteStudentResult.
+ * The input: student.
+ * The output: 0 on success, -1 if the result could not be recorded.
+ * The function operation: Writes the student's result into the results file.
+ * A result that could not be recorded turns into an INTERNAL_ERROR.
+*/
+int WriteStudentResult(Student *student);
+
+/**
+ * function name: WriteResultLine.
+ * The input: result line, options.
+ * The output: 0 on success, -1 on failure.
+ * The function operation: Appends a result line to the journal and then to
+ * the results file.
+*/
+int WriteResultLine(char *resultLine, Options *options);
+
+/**
+ * function name: TimeoutHandler.
+ * The input: process id, status.
+ * The output: 1 timeout, 0 no timeout, -1 if waiting failed.
+ * The function operation:  Handles process timeout.
+*/
+int TimeoutHandler(pid_t pid, int *status);
+
+/**
+ * function name: FreeStudent.
+ * The input: student.
+ * The output: void.
+ * The function operation: Frees the student and his content.
+*/
+void FreeStudent(Student *student);
+
+/**
+ * function name: HandleCompilationError.
+ * The input: student.
+ * The output: void.
+ * The function operation:  Handles compilation error of student's file.
+*/
+void HandleCompilationError(Student *student);
+
+/**
+ * function name: HandleComparisonResult.
+ * The input: student.
+ * The output: comparison result.
+ * The function operation: Handle student's comparison result.
+*/
+void HandleComparisonResult(Student *student, int compareResult);
+
+/**
+ * function name: HandleTimeout.
+ * The input: student.
+ * The output: void.
+ * The function operation: Handles timeout of student's file.
+*/
+void HandleTimeout(Student *student);
+
+/**
+ * function name: HandleInternalError.
+ * The input: student.
+ * The output: void.
+ * The function operation: Handles a student the grader failed to grade.
+*/
+void HandleInternalError(Student *student);
+
+/**
+ * function name: ShouldRetry.
+ * The input: attempts made so far.
+ * The output: 1 if the call should be made again, else 0.
+ * The function operation: Pauses and counts the attempt if the last call
+ * failed for a passing reason, like being interrupted or out of processes
+ * or files for a moment. Keeps errno for the caller's message.
+*/
+int ShouldRetry(int *attempt);
+
+/**
+ * function name: ReportChildError.
+ * The input: error pipe.
+ * The output: void.
+ * The function operation: Tells the parent why a child could not start the
+ * student's program and ends the child.
+*/
+void ReportChildError(int errorPipe);
+
+/**
+ * function name: HandleOutputLimit.
+ * The input: student.
+ * The output: void.
+ * The function operation: Handles a student's output that went over the
+ * output limit.
+*/
+void HandleOutputLimit(Student *student);
+
+/**
+ * function name: ApplyVerdict.
+ * The input: student, verdict.
+ * The output: void.
+ * The function operation: Sets the student's grade and feedback from a
+ * verdict and the student's own depth.
+*/
+void ApplyVerdict(Student *student, int verdict);
+
+/**
+ * function name: FinishStudent.
+ * The input: graded student, verdict, statistics.
+ * The output: void.
+ * The function operation: Applies the verdict to the student and to every
+ * student with an identical C file, writes their results and counts them in
+ * the statistics.
+*/
+void FinishStudent(Student *student, int verdict, Stats *stats);
+
+/**
+ * function name: HashSourceFile.
+ * The input: student.
+ * The output: 0 on success, -1 if the C file could not be read.
+ * The function operation: Sets the hash and size of the student's C file.
+*/
+int HashSourceFile(Student *student);
+
+/**
+ * function name: CompareSources.
+ * The input: two pointers to students.
+ * The output: negative, zero or positive.
+ * The function operation: Orders students by C file hash, size and index.
+*/
+int CompareSources(const void *first, const void *second);
+
+/**
+ * function name: IsSourceEqual.
+ * The input: two students.
+ * The output: 1 if their C files have the same bytes, else 0.
+ * The function operation: Reads both C files block by block. A file that
+ * cannot be read counts as different, so its student is graded alone.
+*/
+int IsSourceEqual(Student *student1, Student *student2);
+
+/**
+ * function name: IsContentEqual.
+ * The input: file, file.
+ * The output: 1 if the rest of the files have the same bytes, else 0.
+ * The function operation: Reads both files block by block, a file that
+ * could not be opened or read counts as different.
+*/
+int IsContentEqual(int file1, int file2);
+
+/**
+ * function name: GroupDuplicates.
+ * The input: students, list to fill with one student per group, groups file
+ * path.
+ * The output: void.
+ * The function operation: Groups students with identical C files, links
+ * each group behind its first student and reports the groups' sizes.
+*/
+void GroupDuplicates(StudentList *students, StudentList *representatives,
+                     char *path);
+
+/**
+ * function name: WriteToJournal.
+ * The input: result line, journal path.
+ * The output: 0 on success, -1 on failure.
+ * The function operation: Appends a finished student's result line to the
+ * progress journal and flushes it to disk before the results file is updated.
+*/
+int WriteToJournal(char *resultLine, char *path);
+
+/**
+ * function name: ReplayJournal.
+ * The input: journal, options.
+ * The output: void.
+ * The function operation: Loads the finished students from the progress
+ * journal, drops a torn last line and rebuilds the results file from it.
+*/
+void ReplayJournal(Journal *journal, Options *options);
+
+/**
+ * function name: CreateResultFiles.
+ * The input: options.
+ * The output: void.
+ * The function operation: Creates the assignment's results file and journal
+ * empty.
+*/
+void CreateResultFiles(Options *options);
+
+/**
+ * function name: IsStudentFinished.
+ * The input: journal, student name.
+ * The output: 1 if the student was already graded, else 0.
+ * The function operation: Searches the journal for the student's name.
+*/
+int IsStudentFinished(Journal *journal, char *name);
+
+/**
+ * function name: FreeJournal.
+ * The input: journal.
+ * The output: void.
+ * The function operation: Frees the journal's content.
+*/
+void FreeJournal(Journal *journal);
+
+/**
+ * function name: CompareNames.
+ * The input: two pointers to names.
+ * The output: negative, zero or positive like strcmp.
+ * The function operation: Orders names for sorting and searching.
+*/
+int CompareNames(const void *first, const void *second);
+
+/**
+ * function name: ParseArguments.
+ * The input: argument count, arguments, options.
+ * The output: void.
+ * The function operation: Reads the command line flags and the
+ * configuration file paths, one per assignment.
+*/
+void ParseArguments(int argc, char *argv[], Options *options);
+
+/**
+ * function name: LoadAssignments.
+ * The input: options of the command line.
+ * The output: options of every assignment.
+ * The function operation: Reads and checks every configuration on top of
+ * the command line flags. With several assignments every one writes its own
+ * files named after its configuration, and they share the workers and a
+ * cache of compiled programs.
+*/
+Options *LoadAssignments(Options *options);
+
+/**
+ * function name: QueueAssignments.
+ * The input: assignments, options of every assignment, queue to fill.
+ * The output: void.
+ * The function operation: Merges the assignments' students into one queue,
+ * always taking the next student of the assignment that has the smallest
+ * share of its predicted cost queued, so every assignment moves forward at
+ * the same pace.
+*/
+void QueueAssignments(Assignment *assignments, Options *options,
+                      StudentList *queue);
+
+/**
+ * function name: ReadCompileCache.
+ * The input: student, path to fill with the cache entry's name.
+ * The output: -1 if the C file was not compiled yet, 0 if it failed to
+ * compile, 1 if its program was linked to the student's executable path.
+ * The function operation: Looks up a program another assignment compiled
+ * from the same C file.
+*/
+int ReadCompileCache(Student *student, char *cachePath);
+
+/**
+ * function name: WriteCompileCache.
+ * The input: student, cache entry's name, compilation result.
+ * The output: void.
+ * The function operation: Keeps the student's program, or the fact that it
+ * did not compile, for the other assignments. Failing to do so only costs
+ * a compilation later.
+*/
+void WriteCompileCache(Student *student, char *cachePath, int compileResult);
+
+/**
+ * function name: RemoveCompileCache.
+ * The input: cache directory.
+ * The output: void.
+ * The function operation: Deletes the cached programs and their directory.
+*/
+void RemoveCompileCache(char *path);
+
+/**
+ * function name: IsCachedSource.
+ * The input: student, cache entry's name.
+ * The output: 1 if the entry was made from the student's C file, else 0.
+ * The function operation: Compares the C file kept with the entry to the
+ * student's, since the entry's name is only a hash and may collide.
+*/
+int IsCachedSource(Student *student, char *cachePath);
+
+/**
+ * function name: ClaimCacheEntry.
+ * The input: student, cache entry's name.
+ * The output: 1 if the entry is the student's C file's, else 0.
+ * The function operation: Keeps a copy of the C file with the entry. The
+ * copy is linked into place whole, so a reader never sees half of it. If
+ * another C file already holds the entry, it stays that file's.
+*/
+int ClaimCacheEntry(Student *student, char *cachePath);
+
+/**
+ * function name: FingerprintSource.
+ * The input: student, the C file's content, its size.
+ * The output: void.
+ * The function operation: Hashes every run of PLAGIARISM_KGRAM tokens and
+ * keeps the smallest hash of every PLAGIARISM_WINDOW runs in a row, so any
+ * code two files share that is long enough leaves a fingerprint in both.
+*/
+void FingerprintSource(Student *student, char *source, size_t size);
+
+/**
+ * function name: TokenizeSource.
+ * The input: the C file's content, its size, array to fill with at least
+ * room for a token per byte.
+ * The output: amount of tokens.
+ * The function operation: Splits the C code into tokens, skipping spaces,
+ * comments and preprocessor lines. Names, numbers and literals become the
+ * same token each, so renaming a variable changes nothing.
+*/
+int TokenizeSource(char *source, size_t size, unsigned int *tokens);
+
+/**
+ * function name: IsCKeyword.
+ * The input: word, its length.
+ * The output: 1 if the word is a C keyword, else 0.
+ * The function operation: Searches the keywords.
+*/
+int IsCKeyword(char *word, size_t length);
+
+/**
+ * function name: ComparePrints.
+ * The input: two pointers to fingerprints.
+ * The output: negative, zero or positive like strcmp.
+ * The function operation: Orders fingerprints.
+*/
+int ComparePrints(const void *first, const void *second);
+
+/**
+ * function name: SortPrintEntries.
+ * The input: index entries, amount of entries.
+ * The output: void.
+ * The function operation: Sorts the entries by fingerprint a byte at a
+ * time, keeping the order of the entries with equal fingerprints.
+*/
+void SortPrintEntries(PrintEntry *entries, int count);
+
+/**
+ * function name: DetectPlagiarism.
+ * The input: one student of every group of identical C files, options.
+ * The output: void.
+ * The function operation: Indexes the students' fingerprints, scores only
+ * the pairs that share any on several threads and writes the pairs that
+ * share at least the threshold to the report, most similar first. Code
+ * of the starter file, and code more than the common percent of the C
+ * files have, came with the assignment and is left out.
+*/
+void DetectPlagiarism(StudentList *students, Options *options);
+
+/**
+ * function name: LoadStarterPrints.
+ * The input: starter file path, amount to fill.
+ * The output: the starter file's distinct fingerprints, sorted, 0 if it
+ * has none.
+ * The function operation: Fingerprints the C file the assignment handed
+ * out like a student's.
+*/
+unsigned int *LoadStarterPrints(char *path, int *count);
+
+/**
+ * function name: ScoreSources.
+ * The input: similarity task.
+ * The output: 0.
+ * The function operation: Counts the fingerprints each of the thread's
+ * students shares with every later student through the index, and keeps
+ * the pairs over the threshold.
+*/
+void *ScoreSources(void *task);
+
+/**
+ * function name: CompareSimilarPairs.
+ * The input: two pointers to pairs.
+ * The output: negative, zero or positive like strcmp.
+ * The function operation: Orders pairs from the most similar.
+*/
+int CompareSimilarPairs(const void *first, const void *second);
+
+/**
+ * function name: GradeStudent.
+ * The input: student, options.
+ * The output: the student's verdict.
+ * The function operation: Compiles, executes and compares the student's C
+ * file.
+*/
+int GradeStudent(Student *student, Options *options);
+
+/**
+ * function name: AddStudent.
+ * The input: list, student.
+ * The output: void.
+ * The function operation: Appends a student to the list.
+*/
+void AddStudent(StudentList *list, Student *student);
+
+/**
+ * function name: FillLineReader.
+ * The input: line reader.
+ * The output: amount of bytes read, 0 if the other side closed, -1 on a
+ * read error or a line too long to fit.
+ * The function operation: Reads whatever is available on the socket.
+*/
+int FillLineReader(LineReader *reader);
+
+/**
+ * function name: NextLine.
+ * The input: line reader, line buffer of LINE_SIZE bytes.
+ * The output: 1 if a full line was taken, else 0.
+ * The function operation: Takes the next complete line out of the reader.
+*/
+int NextLine(LineReader *reader, char *line);
+
+/**
+ * function name: RunWorker.
+ * The input: socket, worker's slot, options of every assignment.
+ * The output: void.
+ * The function operation: Grades the students the coordinator sends until
+ * told to quit. Unstarted students are given back when asked to.
+*/
+void RunWorker(int socket, int slot, Options *options);
+
+/**
+ * function name: RunCoordinator.
+ * The input: students, options, statistics, pre-check's line reader.
+ * The output: void.
+ * The function operation: Starts the workers, hands them batches of
+ * students, moves work from busy workers to idle ones and finishes the
+ * students with the verdicts they send back or the pre-check finds.
+*/
+void RunCoordinator(StudentList *students, Options *options, Stats *stats,
+                    LineReader *precheck);
+
+/**
+ * function name: NowMicros.
+ * The input: void.
+ * The output: monotonic time in microseconds.
+ * The function operation: Reads the monotonic clock.
+*/
+long long NowMicros(void);
+
+/**
+ * function name: WriteStats.
+ * The input: statistics, boolean write even if written recently.
+ * The output: void.
+ * The function operation: Rewrites the statistics file at most once per
+ * STATS_INTERVAL. The file is replaced by a rename so readers never see
+ * half of it.
+*/
+void WriteStats(Stats *stats, int isForced);
+
+/**
+ * function name: ReadWholeFile.
+ * The input: path, pointer to the size to set.
+ * The output: the file's content ending with a null byte.
+ * The function operation: Reads a whole file into memory.
+*/
+char *ReadWholeFile(char *path, size_t *size);
+
+/**
+ * function name: LoadConfig.
+ * The input: options.
+ * The output: void.
+ * The function operation: Reads the whole configuration file at once. A file
+ * of "key = value" lines names its settings, else the old lines are read in
+ * order: students directory, input and the correct outputs. Flags given on
+ * the command line win over the file.
+*/
+void LoadConfig(Options *options);
+
+/**
+ * function name: ApplyConfigKey.
+ * The input: options, key, value, line number, boolean first time the key
+ * was seen.
+ * The output: void.
+ * The function operation: Checks one named setting and sets it.
+*/
+void ApplyConfigKey(Options *options, char *key, char *value, int lineNumber,
+                    int isFirst);
+
+/**
+ * function name: ParseConfigNumber.
+ * The input: value, line number, smallest legal value.
+ * The output: the number.
+ * The function operation: Reads a whole number, stops the run if the value
+ * is anything else.
+*/
+long ParseConfigNumber(char *value, int lineNumber, long minimum);
+
+/**
+ * function name: ParseConfigSwitch.
+ * The input: value, line number.
+ * The output: 1 for yes, 0 for no.
+ * The function operation: Reads a yes or no, stops the run if the value is
+ * anything else.
+*/
+int ParseConfigSwitch(char *value, int lineNumber);
+
+/**
+ * function name: AddCompareFlag.
+ * The input: options, comparator flag, value.
+ * The output: void.
+ * The function operation: Passes a flag to the comparator unless the
+ * command line already did.
+*/
+void AddCompareFlag(Options *options, char *flag, char *value);
+
+/**
+ * function name: ValidateOptions.
+ * The input: options.
+ * The output: void.
+ * The function operation: Checks every path and setting before any student
+ * is graded, so a bad configuration stops the run at once.
+*/
+void ValidateOptions(Options *options);
+
+/**
+ * function name: LoadTestCases.
+ * The input: options.
+ * The output: void.
+ * The function operation: Reads the test case list, one case per line as an
+ * input path followed by its correct output paths, or makes the only case
+ * from the configuration. Every input is read into memory once.
+*/
+void LoadTestCases(Options *options);
+
+/**
+ * function name: LoadSealedInput.
+ * The input: input file path.
+ * The output: the memory file.
+ * The function operation: Copies the input into a memory file and seals it,
+ * so no one can change it while the students read it.
+*/
+int LoadSealedInput(char *path);
+
+/**
+ * function name: VerdictRank.
+ * The input: verdict.
+ * The output: how bad the verdict is, higher is worse.
+ * The function operation: Orders verdicts to keep the worst of a student's
+ * test cases.
+*/
+int VerdictRank(int verdict);
+
+/**
+ * function name: LoadHistory.
+ * The input: history, path.
+ * The output: void.
+ * The function operation: Reads the grading costs of the previous runs, an
+ * empty history if there were none.
+*/
+void LoadHistory(History *history, char *path);
+
+/**
+ * function name: CompareHistoryEntries.
+ * The input: two pointers to history entries.
+ * The output: negative, zero or positive like strcmp.
+ * The function operation: Orders history entries by name.
+*/
+int CompareHistoryEntries(const void *first, const void *second);
+
+/**
+ * function name: ScheduleStudents.
+ * The input: students to grade, every student with a C file, history.
+ * The output: void.
+ * The function operation: Predicts every student's grading time from the
+ * history, or from the C file's size and the history's averages for new
+ * students, and orders the students longest first.
+*/
+void ScheduleStudents(StudentList *representatives, StudentList *students,
+                      History *history);
+
+/**
+ * function name: CompareCosts.
+ * The input: two pointers to students.
+ * The output: negative, zero or positive.
+ * The function operation: Orders students by predicted cost, highest first.
+*/
+int CompareCosts(const void *first, const void *second);
+
+/**
+ * function name: WriteHistory.
+ * The input: history, graded students, path.
+ * The output: void.
+ * The function operation: Rewrites the history with this run's costs and
+ * the previous costs of students that were not graded again.
+*/
+void WriteHistory(History *history, StudentList *representatives,
+                  char *path);
+
+/**
+ * function name: FreeHistory.
+ * The input: history.
+ * The output: void.
+ * The function operation: Frees the history's content.
+*/
+void FreeHistory(History *history);
+
+/**
+ * function name: StartPrecheck.
+ * The input: students in grading order, line reader to set up.
+ * The output: the pre-check's process id.
+ * The function operation: Starts a process that checks the students' syntax
+ * from the end of the queue, while the grading starts from its front.
+*/
+pid_t StartPrecheck(StudentList *students, LineReader *precheck);
+
+/**
+ * function name: RunPrecheck.
+ * The input: students, pipe to report on.
+ * The output: void.
+ * The function operation: Checks the syntax of the C files in batches and
+ * checks the files of a failed batch one by one. Reports every index of a
+ * student whose C file does not compile.
+*/
+void RunPrecheck(StudentList *students, int pipe);
+
+/**
+ * function name: CheckSyntax.
+ * The input: students, amount of students.
+ * The output: 1 if every C file's syntax is fine, else 0.
+ * The function operation: Runs a syntax-only gcc on the C files at once.
+*/
+int CheckSyntax(Student **students, int count);
+
+/**
+ * function name: ReadPrecheck.
+ * The input: pre-check's line reader, students, statistics.
+ * The output: amount of students finished.
+ * The function operation: Finishes the students the pre-check found so far
+ * with a compilation error, unless a worker already has them. Stops reading
+ * once the pre-check is done.
+*/
+int ReadPrecheck(LineReader *precheck, StudentList *students, Stats *stats);
+
+/**
+ * function name: StopPrecheck.
+ * The input: pre-check's process id, pre-check's line reader.
+ * The output: void.
+ * The function operation: Stops the pre-check and its compiler if they are
+ * still running.
+*/
+void StopPrecheck(pid_t pid, LineReader *precheck);
+
+/**
+ * function name: OpenCounter.
+ * The input: counter, process id, 0 for this process.
+ * The output: the counter's file, -1 if it cannot be opened.
+ * The function operation: Opens a user space counter. A counter on another
+ * process waits for its exec and follows its children.
+*/
+int OpenCounter(int counter, pid_t pid);
+
+/**
+ * function name: ProbeCounters.
+ * The input: options.
+ * The output: void.
+ * The function operation: Finds the counters this machine allows, warns
+ * about the others and stops measuring if none are left.
+*/
+void ProbeCounters(Options *options);
+
+/**
+ * function name: ReadCounters.
+ * The input: student, counter files, -1 for counters not opened.
+ * The output: void.
+ * The function operation: Adds the counted values to the student's totals,
+ * scaled up if the kernel had to share the hardware, and closes the files.
+*/
+void ReadCounters(Student *student, int *counterFiles);
+
+/**
+ * function name: PlanAffinity.
+ * The input: options.
+ * The output: void.
+ * The function operation: Gives every execution slot a core of its own,
+ * spread over the NUMA nodes and away from each other's hyper-threads, and
+ * leaves the rest of the cores to the compile jobs. Runs unpinned if there
+ * are not enough cores.
+*/
+void PlanAffinity(Options *options);
+
+/**
+ * function name: CpuNode.
+ * The input: cpu.
+ * The output: the cpu's NUMA node, 0 if the system does not tell.
+ * The function operation: Finds the node link in the cpu's sysfs directory.
+*/
+int CpuNode(int cpu);
+
+/**
+ * function name: ReadCpuList.
+ * The input: path, cpus.
+ * The output: void.
+ * The function operation: Reads a sysfs list of cpus like 0-3,8 into the
+ * set, which stays empty if the file is missing.
+*/
+void ReadCpuList(char *path, cpu_set_t *cpus);
+
+/**
+ * function name: PinProcess.
+ * The input: cpus.
+ * The output: void.
+ * The function operation: Keeps this process and its future children on
+ * the given cpus, only warns if the system refuses.
+*/
+void PinProcess(cpu_set_t *cpus);
+
+/**
+ * function name: WriteResultsStore.
+ * The input: students with a C file, students without one, journal of the
+ * previous run, store path.
+ * The output: void.
+ * The function operation: Writes every student's result as columns sorted by
+ * name, so tools can map the file and read one column without parsing the
+ * results file. Students of the previous run only have what the journal
+ * kept.
+*/
+void WriteResultsStore(StudentList *students, StudentList *unfound,
+                       Journal *journal, char *path);
+
+/**
+ * function name: CompareRows.
+ * The input: two pointers to rows.
+ * The output: negative, zero or positive like strcmp.
+ * The function operation: Orders rows by name.
+*/
+int CompareRows(const void *first, const void *second);
+
+/**
+ * function name: WriteColumn.
+ * The input: file, column, column's size, offset to move past the column.
+ * The output: void.
+ * The function operation: Writes a column and pads it to 8 bytes.
+*/
+void WriteColumn(int file, void *column, size_t size,
+                 unsigned long long *offset);
+
+/**
+ * function name: SendBatch.
+ * The input: workers, worker's index, students, pending queue, queue start,
+ * queue size, amount of running workers.
+ * The output: 0 on success, -1 if the worker could not be written to.
+ * The function operation: Sends the worker its next batch of students.
+*/
+int SendBatch(Worker *workers, int worker, StudentList *students,
+              int *pending, int *pendingStart, int *pendingSize,
+              int workerCount);
+
+/**
+ * function name: RemoveWorker.
+ * The input: workers, worker's index, students, pending queue, queue start,
+ * queue size.
+ * The output: void.
+ * The function operation: Stops a worker that died or broke the protocol
+ * and puts the students it had back in the pending queue, for the other
+ * workers to grade.
+*/
+void RemoveWorker(Worker *workers, int worker, StudentList *students,
+                  int *pending, int pendingStart, int *pendingSize);
+
+/**
+ * function name: LocateStudent.
+ * The input: student, options, statistics, list of the students without a
+ * C file.
+ * The output: 1 if the student has a C file to grade, else 0.
+ * The function operation: Searches and hashes the student's C file. A
+ * student that cannot be graded gets its result written right away and
+ * joins the list of students without a C file.
+*/
+int LocateStudent(Student *student, Options *options, Stats *stats,
+                  StudentList *unfound);
+
+/**
+ * function name: StartWatch.
+ * The input: watcher, students directory.
+ * The output: void.
+ * The function operation: Watches every directory of the students tree
+ * and the signals that end the watch.
+*/
+void StartWatch(Watcher *watcher, char *dirPath);
+
+/**
+ * function name: WatchTree.
+ * The input: watcher, directory path, name of the student it belongs to, 0
+ * for the main directory.
+ * The output: void.
+ * The function operation: Watches the directory and every directory below
+ * it. The main directory's subdirectories are the students.
+*/
+void WatchTree(Watcher *watcher, char *path, char *name);
+
+/**
+ * function name: ReadWatchEvents.
+ * The input: watcher, students directory.
+ * The output: void.
+ * The function operation: Reads the pending events and notes a change for
+ * every student they touch. New directories get watched, and a lost event
+ * queue counts as a change of every student.
+*/
+void ReadWatchEvents(Watcher *watcher, char *dirPath);
+
+/**
+ * function name: NoteChange.
+ * The input: watcher, student's name.
+ * The output: void.
+ * The function operation: Restarts the student's quiet period.
+*/
+void NoteChange(Watcher *watcher, char *name);
+
+/**
+ * function name: WatchStudents.
+ * The input: watcher, options, statistics, graded students, students
+ * without a C file, journal of the previous run.
+ * The output: void.
+ * The function operation: Grades every student whose files stayed
+ * unchanged for the quiet period after a change, and updates the student's
+ * rows in the results, until SIGINT or SIGTERM.
+*/
+void WatchStudents(Watcher *watcher, Options *options, Stats *stats,
+                   StudentList *students, StudentList *unfound,
+                   Journal *journal);
+
+/**
+ * function name: StopWatch.
+ * The input: watcher.
+ * The output: void.
+ * The function operation: Closes the watch and frees it.
+*/
+void StopWatch(Watcher *watcher);
+
+/**
+ * function name: RemoveStudent.
+ * The input: list, student's name.
+ * The output: void.
+ * The function operation: Takes the student out of the list and frees it.
+*/
+void RemoveStudent(StudentList *list, char *name);
+
+/**
+ * function name: ForgetJournalName.
+ * The input: journal, student's name.
+ * The output: void.
+ * The function operation: Takes the student out of the journal's names.
+*/
+void ForgetJournalName(Journal *journal, char *name);
+
+/**
+ * function name: RewriteResultLines.
+ * The input: file path, boolean sync the file.
+ * The output: void.
+ * The function operation: Keeps only the last line of every student, at
+ * the place of the student's first line, and swaps the file for the new one
+ * at once.
+*/
+void RewriteResultLines(char *path, int isSynced);
+
+/**
+ * function name: CompareResultLines.
+ * The input: two pointers to result lines.
+ * The output: negative, zero or positive.
+ * The function operation: Orders lines by name and then by position.
+*/
+int CompareResultLines(const void *first, const void *second);
+
+/**
+ * function name: CompareLinePositions.
+ * The input: two pointers to result lines.
+ * The output: negative, zero or positive.
+ * The function operation: Orders lines by position.
+*/
+int CompareLinePositions(const void *first, const void *second);
+
+/**
+ * function name: OpenDirLister.
+ * The input: lister, directory path.
+ * The output: void.
+ * The function operation: Opens the directory for reading in batches.
+*/
+void OpenDirLister(DirLister *lister, char *path);
+
+/**
+ * function name: ReadEntryBatch.
+ * The input: lister.
+ * The output: amount of names in the batch, 0 at the end of the directory.
+ * The function operation: Reads as many entries as fit in the buffer with
+ * one getdents64 call and keeps the names of those that are not junk.
+*/
+int ReadEntryBatch(DirLister *lister);
+
+/**
+ * function name: CloseDirLister.
+ * The input: lister.
+ * The output: void.
+ * The function operation: Closes the directory and frees the buffers.
+*/
+void CloseDirLister(DirLister *lister);
+
+/**
+ * function name: IsJunkEntry.
+ * The input: entry name, entry type.
+ * The output: 1 if the entry is junk, else 0.
+ * The function operation: Finds the . and .. entries and the files archive
+ * tools leave behind: __MACOSX directories, ._ resource files and
+ * .DS_Store files. A known type rules out a file of the same name.
+*/
+int IsJunkEntry(char *name, unsigned char type);
+
+/**
+ * function name: IsEntryDirectory.
+ * The input: path, entry type.
+ * The output: 1 if the entry is a directory, else 0.
+ * The function operation: Trusts the entry's type when the file system
+ * gave one, else checks the path.
+*/
+int IsEntryDirectory(char *path, unsigned char type);
+
+/**
+ * function name: ArchiveSuffixLength.
+ * The input: file name.
+ * The output: length of the archive extension, 0 if the name has none.
+ * The function operation: Recognizes .zip, .tar, .tgz and .tar.gz names.
+*/
+int ArchiveSuffixLength(char *name);
+
+/**
+ * function name: ArchivePathLength.
+ * The input: path.
+ * The output: length of the archive part, 0 if the path is not inside an
+ * archive.
+ * The function operation: Finds the archive file among the path's
+ * directories, the rest of the path names an entry inside it.
+*/
+int ArchivePathLength(char *path);
+
+/**
+ * function name: ListArchive.
+ * The input: archive path, archive to fill.
+ * The output: 0 on success, -1 if the archive could not be read.
+ * The function operation: Reads a zip's central directory at once or walks
+ * a tar's headers, which gzread also takes out of a .tar.gz.
+*/
+int ListArchive(char *path, Archive *archive);
+
+/**
+ * function name: ListZip.
+ * The input: archive file, archive to fill.
+ * The output: 0 on success, -1 if the zip is broken.
+ * The function operation: Finds the end record and reads every central
+ * directory entry.
+*/
+int ListZip(int file, Archive *archive);
+
+/**
+ * function name: ListTar.
+ * The input: archive path, archive to fill.
+ * The output: 0 on success, -1 if the tar is broken.
+ * The function operation: Reads every header, skipping over the data.
+*/
+int ListTar(char *path, Archive *archive);
+
+/**
+ * function name: AddArchiveMember.
+ * The input: archive, name, its length, boolean directory, offset, size,
+ * method.
+ * The output: void.
+ * The function operation: Appends an entry without the name's leading ./
+ * and trailing slash.
+*/
+void AddArchiveMember(Archive *archive, char *name, size_t length,
+                      int isDirectory, long long offset, long long size,
+                      int method);
+
+/**
+ * function name: FreeArchive.
+ * The input: archive.
+ * The output: void.
+ * The function operation: Frees the entries.
+*/
+void FreeArchive(Archive *archive);
+
+/**
+ * function name: FindArchiveCFile.
+ * The input: archive path, student.
+ * The output: the C file's path through the archive, 0 if none.
+ * The function operation: Searches the archive like a student's directory,
+ * level by level, with the same depth and multiple directories rules.
+*/
+char *FindArchiveCFile(char *archivePath, Student *student);
+
+/**
+ * function name: OpenSourceFile.
+ * The input: C file path.
+ * The output: descriptor reading the C file from its start, -1 on failure.
+ * The function operation: Opens a plain C file. A C file inside an archive
+ * is unpacked into a memory file, so nothing is written to disk.
+*/
+int OpenSourceFile(char *path);
+
+/**
+ * function name: OpenStudentSource.
+ * The input: student.
+ * The output: descriptor reading the C file from its start, -1 on failure.
+ * The function operation: Reopens the student's unpacked memory file with
+ * an offset of its own, so stages running at once do not move each other's
+ * reads. Opens the C file itself if it was not unpacked.
+*/
+int OpenStudentSource(Student *student);
+
+/**
+ * function name: RaiseFileLimit.
+ * The input: void.
+ * The output: void.
+ * The function operation: Raises the limit of open files to the most
+ * allowed, every C file unpacked from an archive stays open until the end.
+*/
+void RaiseFileLimit(void);
+
+/**
+ * function name: ExtractMember.
+ * The input: archive path, archive, entry, file to write into.
+ * The output: 0 on success, -1 on failure.
+ * The function operation: Copies or inflates a zip entry, or reads a tar
+ * entry through gzread.
+*/
+int ExtractMember(char *archivePath, Archive *archive, ArchiveMember *member,
+                  int outFile);
+
+/**
+ * function name: ReadLittleEndian.
+ * The input: bytes, amount of bytes.
+ * The output: the number.
+ * The function operation: Reads a little endian number of a zip header.
+*/
+unsigned long long ReadLittleEndian(unsigned char *bytes, int size);
+
+/**
+ * function name: ReadOctal.
+ * The input: field, field size.
+ * The output: the number, -1 if the field is not a number.
+ * The function operation: Reads an octal number of a tar header.
+*/
+long long ReadOctal(char *field, int size);
+
+int main(int argc, char *argv[]) {
+
+    //Variable declarations.
+    int           batchCount;
+    int           entry;
+    int           current;
+    DirLister     lister;
+    Options       arguments;
+    Options       *options;
+    Stats         stats;
+    int           index;
+    LineReader    precheck;
+    pid_t         precheckPId = -1;
+    StudentList   queue       = {0, 0, 0};
+    StudentList   checked     = {0, 0, 0};
+    Assignment    *assignments;
+    Assignment    *assignment;
+    Watcher       watcher;
+
+    //Read the command line flags.
+    ParseArguments(argc, argv, &arguments);
+
+    //Read every configuration and check it before grading anyone.
+    options     = LoadAssignments(&arguments);
+
+    RaiseFileLimit();
+    assignments = (Assignment *) calloc(arguments.configCount,
+                                        sizeof(Assignment));
+
+    //Check if allocation worked.
+    if (assignments == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Start counting for the statistics.
+    memset(&stats, 0, sizeof(Stats));
+    stats.path      = options->statsPath;
+    stats.startTime = NowMicros();
+
+    //Watch before the first pass so no change during it is missed.
+    if (options->isWatch) {
+
+        StartWatch(&watcher, options->dirPath);
+    }
+
+    for (current = 0; current < arguments.configCount; current++) {
+
+        assignment = &assignments[current];
+
+        //Check if continuing a previous run.
+        if (options[current].isResume) {
+
+            //Rebuild the results file from the journal.
+            ReplayJournal(&assignment->journal, &options[current]);
+
+        } else {
+
+            CreateResultFiles(&options[current]);
+        }
+
+        OpenDirLister(&lister, options[current].dirPath);
+
+        //Run over all the students, a buffer of entries at a time.
+        while ((batchCount = ReadEntryBatch(&lister)) > 0) {
+
+            for (entry = 0; entry < batchCount; entry++) {
+
+                Student *student;
+
+                //Initialize student.
+                student = InitStudent(lister.names[entry],
+                                      options[current].dirPath);
+
+                //Skip students that were graded before the run was
+                //interrupted.
+                if (IsStudentFinished(&assignment->journal, student->name)) {
+
+                    FreeStudent(student);
+                    stats.skipped++;
+                    continue;
+                }
+
+                stats.discovered++;
+
+                //The C file was hashed to find identical submissions.
+                if (LocateStudent(student, &options[current], &stats,
+                                  &assignment->unfound)) {
+
+                    AddStudent(&assignment->students, student);
+                }
+            }
+        }
+
+        //Close main directory.
+        CloseDirLister(&lister);
+
+        //Grade only one student of every group of identical C files.
+        GroupDuplicates(&assignment->students, &assignment->representatives,
+                        options[current].groupsPath);
+
+        //Start the slowest students first so they do not finish the run
+        //alone.
+        LoadHistory(&assignment->history, options[current].historyPath);
+        ScheduleStudents(&assignment->representatives, &assignment->students,
+                         &assignment->history);
+    }
+
+    //Every assignment's students go through the same workers.
+    QueueAssignments(assignments, options, &queue);
+
+    //The grader, gcc and the comparator stay off the execution cores.
+    if (options->isAffinity) {
+
+        PinProcess(&options->compilePool);
+    }
+
+    //Find the compilation errors ahead of the grading, for the assignments
+    //that want it. The students keep their places in the queue.
+    precheck.fd     = -1;
+    precheck.length = 0;
+    checked.items   = (Student **) malloc((queue.count + 1) *
+                                          sizeof(Student *));
+
+    //Check if allocation worked.
+    if (checked.items == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    for (index = 0; index < queue.count; index++) {
+
+        if (queue.items[index]->options->isPrecheck) {
+
+            checked.items[checked.count++] = queue.items[index];
+        }
+    }
+
+    if (checked.count > 0) {
+
+        precheckPId = StartPrecheck(&checked, &precheck);
+    }
+
+    stats.isDiscoveryDone = 1;
+    stats.pending         = queue.count;
+    WriteStats(&stats, 1);
+
+    //Grade the collected students on the workers.
+    if (options->workers > 0) {
+
+        RunCoordinator(&queue, options, &stats, &precheck);
+
+    } else {
+
+        for (index = 0; index < queue.count; index++) {
+
+            stats.pending--;
+
+            //Check if the pre-check already found the student's error.
+            ReadPrecheck(&precheck, &queue, &stats);
+
+            if (queue.items[index]->isFinished) {
+                continue;
+            }
+
+            FinishStudent(queue.items[index],
+                          GradeStudent(queue.items[index],
+                                       queue.items[index]->options), &stats);
+        }
+    }
+
+    //The pre-check is of no use once everyone is graded.
+    if (precheckPId > 0) {
+
+        StopPrecheck(precheckPId, &precheck);
+    }
+
+    WriteStats(&stats, 1);
+
+    for (current = 0; current < arguments.configCount; current++) {
+
+        assignment = &assignments[current];
+
+        //Report the C files that share too much with each other.
+        if (options[current].isPlagiarism) {
+
+            DetectPlagiarism(&assignment->representatives, &options[current]);
+        }
+
+        //Write the results again as columns for the reporting tools.
+        WriteResultsStore(&assignment->students, &assignment->unfound,
+                          &assignment->journal, options[current].storePath);
+
+        //Remember what every student cost for the next run.
+        WriteHistory(&assignment->history, &assignment->representatives,
+                     options[current].historyPath);
+        FreeHistory(&assignment->history);
+    }
+
+    //Keep grading the submissions that change from now on.
+    if (options->isWatch) {
+
+        WatchStudents(&watcher, options, &stats, &assignments->students,
+                      &assignments->unfound, &assignments->journal);
+        StopWatch(&watcher);
+    }
+
+    for (current = 0; current < arguments.configCount; current++) {
+
+        assignment = &assignments[current];
+
+        for (index = 0; index < assignment->students.count; index++) {
+
+            FreeStudent(assignment->students.items[index]);
+        }
+
+        for (index = 0; index < assignment->unfound.count; index++) {
+
+            FreeStudent(assignment->unfound.items[index]);
+        }
+
+        free(assignment->representatives.items);
+        free(assignment->students.items);
+        free(assignment->unfound.items);
+        FreeJournal(&assignment->journal);
+
+        for (index = 0; index < options[current].testCaseCount; index++) {
+
+            close(options[current].testCases[index].inputFile);
+        }
+
+        free(options[current].testCases);
+        free(options[current].configContent);
+
+        //The file names of an assignment share one allocation.
+        if (arguments.configCount > 1) {
+
+            free(options[current].resultsPath);
+        }
+    }
+
+    //The cached programs are of no use once the run is over.
+    if (options->cacheDir != 0) {
+
+        RemoveCompileCache(options->cacheDir);
+        free(options->cacheDir);
+    }
+
+    free(queue.items);
+    free(checked.items);
+    free(stats.workerOutstanding);
+    free(stats.workerBusy);
+    free(options->cpuSlots);
+    free(options);
+    free(assignments);
+    free(arguments.configPaths);
+}
+
+char *FindCFile(char *initPath, Student *student) {
+
+    //Variable declarations.
+    int  stop        = 0;
+    int  dirCounter  = 0;
+    int  isCFound    = 0;
+    int  closeResult = 0;
+    int  attempt;
+    char finalPath[MAX_SIZE];
+    char nextFile[MAX_SIZE];
+    DIR  *dir;
+
+    //Check that the path fits.
+    if (strlen(initPath) + strlen(student->archiveName != 0 ?
+                                  student->archiveName : student->name) + 2 >
+        MAX_SIZE) {
+
+        fprintf(stderr, "Error: path too long in %s.\n", student->name);
+        student->isInternalError = 1;
+
+        return 0;
+    }
+
+    //Set path name.
+    strcpy(finalPath, initPath);
+    strcat(finalPath, "/");
+    strcat(finalPath, student->archiveName != 0 ? student->archiveName :
+                      student->name);
+
+    //An archive is searched without unpacking it, a directory named like
+    //one is searched as usual.
+    if (student->archiveName != 0 && !IsDirectory(finalPath)) {
+
+        return FindArchiveCFile(finalPath, student);
+    }
+
+    while (!stop) {
+
+        //Check if found the C file.
+        if (isCFound) {
+
+            //Return final path.
+            char *retPath = (char *) malloc(
+                    strlen(finalPath) * sizeof(char) + 1);
+
+            //Check if allocation worked.
+            if (retPath == 0) {
+
+                student->isInternalError = 1;
+
+                return 0;
+            }
+
+            strcpy(retPath, finalPath);
+            strcat(retPath, "\0");
+
+            return retPath;
+        }
+
+        attempt = 0;
+
+        do {
+
+            dir = opendir(finalPath);
+        } while (dir == 0 && ShouldRetry(&attempt));
+
+        //Check if directory was opened, else only this student fails.
+        if (dir == 0) {
+
+            perror("Error: failed to open directory.\n");
+            student->isInternalError = 1;
+
+            return 0;
+        }
+
+        student->depth += 1;
+
+        dirCounter = 0;
+
+        //Checks the amount of folders the student has is legal.
+        while (1) {
+
+            errno           = 0;
+            student->dirent = readdir(dir);
+
+            //Check if read from directory, else only this student fails.
+            if (student->dirent == 0) {
+
+                if (errno != 0) {
+
+                    perror("Error: failed to read directory.\n");
+                    student->isInternalError = 1;
+                    closedir(dir);
+
+                    return 0;
+                }
+
+                break;
+            }
+
+            //Ignore inner directories and what archive tools left.
+            if (IsJunkEntry(student->dirent->d_name,
+                            student->dirent->d_type)) {
+                continue;
+            }
+
+            //Check that the path fits.
+            if (strlen(finalPath) + strlen(student->dirent->d_name) + 2 >
+                MAX_SIZE) {
+
+                fprintf(stderr, "Error: path too long in %s.\n",
+                        student->name);
+                student->isInternalError = 1;
+                closedir(dir);
+
+                return 0;
+            }
+
+            char temp[MAX_SIZE];
+            strcpy(temp, finalPath);
+            strcat(temp, "/");
+            strcat(temp, student->dirent->d_name);
+
+            if (IsEntryDirectory(temp, student->dirent->d_type)) {
+
+                strcpy(nextFile, temp);
+                dirCounter++;
+            } else if (IsCFile(temp)) {
+
+                strcpy(nextFile, temp);
+                isCFound = 1;
+                break;
+            }
+        }
+
+        closeResult = closedir(dir);
+
+        //Check if the directory was closed.
+        if (closeResult < 0) {
+
+            perror("Error: failed to close directory");
+        }
+
+        //Stop searching if more that on inner folder exists.
+        if ((dirCounter > 1) && !isCFound) {
+
+            student->isMultipleDirectories = 1;
+
+            return 0;
+        }
+
+        //Check if there were sub-directories.
+        if (dirCounter == 0 && !isCFound) {
+
+            return 0;
+        }
+
+        //Copy next name.
+        strcpy(finalPath, nextFile);
+    }
+}
+
+void HandleNoCFile(Student *student) {
+
+    //Set student's grade tp 0.
+    student->result.grade = 0;
+
+    //Set the reason for the grade.
+    if (student->isMultipleDirectories) {
+
+        strcat(student->result.feedback, ",MULTIPLE_DIRECTORIES");
+
+    } else {
+
+        strcat(student->result.feedback, ",NO_C_FILE");
+    }
+}
+
+int IsDirectory(char *path) {
+
+    struct stat pathStat;
+
+    //Check if the path exists.
+    if (stat(path, &pathStat) < 0) {
+
+        return 0;
+    }
+
+    return S_ISDIR(pathStat.st_mode);
+}
+
+int IsCFile(char *path) {
+
+    //Variable declarations.
+    int length;
+
+    length = strlen(path);
+
+    //Check if is a C file.
+    if (length > 2 && path[length - 1] == 'c' && path[length - 2] == '.') {
+
+        return 1;
+    }
+
+    return 0;
+}
+
+int WriteToFile(int file, char *message) {
+
+    //Variable declarations.
+    int    bytesWrote;
+    int    attempt = 0;
+    size_t length  = strlen(message);
+    size_t written = 0;
+
+    while (written < length) {
+
+        bytesWrote = write(file, message + written, length - written);
+
+        //Check that the message was written.
+        if (bytesWrote < 0) {
+
+            if (ShouldRetry(&attempt)) {
+                continue;
+            }
+
+            perror("Error: failed to write to file.\n");
+
+            return -1;
+        }
+
+        written += (size_t) bytesWrote;
+    }
+
+    return 0;
+}
+
+int CompileStudentFile(Student *student) {
+
+    //Variable declarations.
+    pid_t compilePId;
+    int   attempt    = 0;
+    int   sourceFile = -1;
+    int   isCached   = 0;
+    int   compileResult;
+    char  cachePath[LINE_SIZE];
+
+    //Check if another assignment already compiled the same C file.
+    if (student->options != 0 && student->options->cacheDir != 0 &&
+        student->sourceHash != 0) {
+
+        isCached      = 1;
+        compileResult = ReadCompileCache(student, cachePath);
+
+        if (compileResult >= 0) {
+
+            return compileResult;
+        }
+    }
+
+    //A C file inside an archive reaches gcc through its input.
+    if (ArchivePathLength(student->cFilePath) > 0) {
+
+        sourceFile = OpenStudentSource(student);
+
+        //Check if the C file was unpacked.
+        if (sourceFile < 0) {
+
+            return -1;
+        }
+    }
+
+    do {
+
+        compilePId = fork();
+    } while (compilePId < 0 && ShouldRetry(&attempt));
+
+    if (compilePId < 0) {
+
+        perror("Error: fork failed.\n");
+
+        if (sourceFile >= 0) {
+
+            close(sourceFile);
+        }
+
+        return -1;
+    }
+
+    if (compilePId == 0) {
+
+        char *args[]       = {"gcc", student->cFilePath, "-o",
+                              student->execFilePath, 0};
+        char *argsStdin[]  = {"gcc", "-x", "c", "-", "-o",
+                              student->execFilePath, 0};
+        int  retExec;
+
+        if (sourceFile >= 0) {
+
+            dup2(sourceFile, 0);
+            retExec = execvp("gcc", argsStdin);
+
+        } else {
+
+            retExec = execvp("gcc", args);
+        }
+
+        if (retExec == -1) {
+
+            perror("Error: execution failed.\n");
+            exit(CHILD_EXEC_FAILED);
+        }
+    }
+
+    if (sourceFile >= 0) {
+
+        close(sourceFile);
+    }
+
+    compileResult = WaitForChildExec(compilePId,
+                                     &student->status.compileStatus);
+
+    if (isCached) {
+
+        WriteCompileCache(student, cachePath, compileResult);
+    }
+
+    return compileResult;
+}
+
+int ReadCompileCache(Student *student, char *cachePath) {
+
+    //Variable declarations.
+    char entryPath[LINE_SIZE];
+
+    //The same content compiles to the same program in every assignment.
+    snprintf(cachePath, LINE_SIZE, "%s/%016llx_%lld",
+             student->options->cacheDir, student->sourceHash,
+             (long long) student->sourceSize);
+
+    //Check that the entry is of this very C file and not a collision.
+    if (!IsCachedSource(student, cachePath)) {
+
+        return -1;
+    }
+
+    snprintf(entryPath, LINE_SIZE, "%s.err", cachePath);
+
+    //Check if the C file failed to compile before.
+    if (access(entryPath, F_OK) == 0) {
+
+        return 0;
+    }
+
+    snprintf(entryPath, LINE_SIZE, "%s.out", cachePath);
+
+    //A program left from a grader that stopped would block the link.
+    unlink(student->execFilePath);
+
+    //Check if the program is there to share.
+    if (link(entryPath, student->execFilePath) == 0) {
+
+        return 1;
+    }
+
+    return -1;
+}
+
+void RemoveCompileCache(char *path) {
+
+    //Variable declarations.
+    DirLister lister;
+    int       batchCount;
+    int       entry;
+
+    OpenDirLister(&lister, path);
+
+    //The cache holds only files, every one made by this run.
+    while ((batchCount = ReadEntryBatch(&lister)) > 0) {
+
+        for (entry = 0; entry < batchCount; entry++) {
+
+            //Check if the file was deleted.
+            if (unlinkat(lister.fd, lister.names[entry], 0) < 0) {
+
+                fprintf(stderr, "Warning: failed to delete %s/%s: %s.\n",
+                        path, lister.names[entry], strerror(errno));
+            }
+        }
+    }
+
+    CloseDirLister(&lister);
+
+    //Check if the directory was deleted.
+    if (rmdir(path) < 0) {
+
+        fprintf(stderr, "Warning: failed to delete %s: %s.\n", path,
+                strerror(errno));
+    }
+}
+
+void WriteCompileCache(Student *student, char *cachePath, int compileResult) {
+
+    //Variable declarations.
+    char entryPath[LINE_SIZE];
+    int  entryFile;
+
+    //Check if gcc could not run, the next assignment tries again.
+    if (compileResult < 0) {
+
+        return;
+    }
+
+    //Check if a different C file with the same hash holds the entry.
+    if (!ClaimCacheEntry(student, cachePath)) {
+
+        return;
+    }
+
+    if (compileResult == 0) {
+
+        snprintf(entryPath, LINE_SIZE, "%s.err", cachePath);
+        entryFile = open(entryPath, O_CREAT | O_WRONLY | O_CLOEXEC, 0644);
+
+        //Check if the failure was noted.
+        if (entryFile < 0) {
+
+            fprintf(stderr, "Warning: failed to cache %s: %s.\n", entryPath,
+                    strerror(errno));
+            return;
+        }
+
+        close(entryFile);
+        return;
+    }
+
+    snprintf(entryPath, LINE_SIZE, "%s.out", cachePath);
+
+    //Another worker may have compiled the same C file at the same time.
+    if (link(student->execFilePath, entryPath) < 0 && errno != EEXIST) {
+
+        fprintf(stderr, "Warning: failed to cache %s: %s.\n", entryPath,
+                strerror(errno));
+    }
+}
+
+int IsCachedSource(Student *student, char *cachePath) {
+
+    //Variable declarations.
+    char sourcePath[LINE_SIZE];
+    int  cachedFile;
+    int  sourceFile;
+    int  isEqual;
+
+    snprintf(sourcePath, LINE_SIZE, "%s.c", cachePath);
+    cachedFile = open(sourcePath, O_RDONLY | O_CLOEXEC);
+
+    //Check if the C file was not compiled yet.
+    if (cachedFile < 0) {
+
+        return 0;
+    }
+
+    sourceFile = OpenStudentSource(student);
+    isEqual    = IsContentEqual(cachedFile, sourceFile);
+
+    close(cachedFile);
+
+    if (sourceFile >= 0) {
+
+        close(sourceFile);
+    }
+
+    return isEqual;
+}
+
+int ClaimCacheEntry(Student *student, char *cachePath) {
+
+    //Variable declarations.
+    unsigned char buffer[HASH_BUFFER_SIZE];
+    char          sourcePath[LINE_SIZE];
+    char          tempPath[LINE_SIZE];
+    int           sourceFile;
+    int           tempFile;
+    int           isCopied   = 1;
+    ssize_t       readNum;
+
+    snprintf(sourcePath, LINE_SIZE, "%s.c", cachePath);
+    snprintf(tempPath, LINE_SIZE, "%s.c.%d", cachePath, (int) getpid());
+
+    sourceFile = OpenStudentSource(student);
+    tempFile   = open(tempPath, O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC,
+                      0644);
+
+    //Check if the C file and its copy were opened.
+    if (sourceFile < 0 || tempFile < 0) {
+
+        isCopied = 0;
+    }
+
+    while (isCopied &&
+           (readNum = read(sourceFile, buffer, HASH_BUFFER_SIZE)) != 0) {
+
+        //Check if the block was copied.
+        if (readNum < 0 || write(tempFile, buffer, (size_t) readNum) !=
+                           readNum) {
+
+            isCopied = 0;
+        }
+    }
+
+    if (sourceFile >= 0) {
+
+        close(sourceFile);
+    }
+
+    if (tempFile >= 0) {
+
+        close(tempFile);
+    }
+
+    //Check if the copy took the entry, else check whose the entry is.
+    if (isCopied && link(tempPath, sourcePath) < 0 && errno != EEXIST) {
+
+        fprintf(stderr, "Warning: failed to cache %s: %s.\n", sourcePath,
+                strerror(errno));
+        isCopied = 0;
+    }
+
+    unlink(tempPath);
+
+    return isCopied && IsCachedSource(student, cachePath);
+}
+
+int ExecuteStudentFile(Student *student, int execFile, TestCase *testCase,
+                       Options *options) {
+
+    //Variable declarations.
+    pid_t   execPId;
+    int     errorPipe[2];
+    int     syncPipe[2];
+    int     childError;
+    int     attempt     = 0;
+    int     counterFiles[COUNTER_COUNT];
+    int     counter;
+    long    outputLimit = options->outputLimit;
+
+    student->isTimeOut     = 0;
+    student->isOutputLimit = 0;
+
+    //The error pipe closes by itself once the program starts.
+    while (pipe2(errorPipe, O_CLOEXEC) < 0) {
+
+        if (!ShouldRetry(&attempt)) {
+
+            perror("Error: pipe failed.\n");
+            return -1;
+        }
+    }
+
+    //The student waits on this pipe until its counters are attached.
+    while (options->isPerf && pipe2(syncPipe, O_CLOEXEC) < 0) {
+
+        if (!ShouldRetry(&attempt)) {
+
+            //Run the students without counters from now on.
+            perror("Error: pipe failed.\n");
+            options->isPerf = 0;
+        }
+    }
+
+    do {
+
+        execPId = fork();
+    } while (execPId < 0 && ShouldRetry(&attempt));
+
+    //Check if fork succeeded.
+    if (execPId < 0) {
+
+        perror("Error: fork failed.\n");
+
+        if (options->isPerf) {
+
+            close(syncPipe[0]);
+            close(syncPipe[1]);
+        }
+
+        close(errorPipe[0]);
+        close(errorPipe[1]);
+        return -1;
+    }
+
+    if (execPId == 0) {
+
+        char *argsStudent[] = {student->execFilePath, testCase->inputPath,
+                               0};
+
+        //Variable declarations.
+        char inputPath[MAX_SIZE];
+        int  studentOutputFile;
+        int  inputFile;
+        int  execValue;
+        int  closeValue;
+        int  dupResult;
+        char syncByte;
+        struct rlimit fileLimit;
+        cpu_set_t     execCpus;
+
+        close(errorPipe[0]);
+
+        //Run alone on the slot's core, away from the compile jobs.
+        if (options->isAffinity) {
+
+            CPU_ZERO(&execCpus);
+            CPU_SET(options->cpuSlots[options->cpuSlot].execCpu, &execCpus);
+            PinProcess(&execCpus);
+        }
+
+        //Wait until the parent closes the pipe, the counters are ready.
+        if (options->isPerf) {
+
+            close(syncPipe[1]);
+            read(syncPipe[0], &syncByte, 1);
+            close(syncPipe[0]);
+        }
+
+        //Let the kernel stop the student right after the output limit.
+        if (outputLimit > 0) {
+
+            fileLimit.rlim_cur = (rlim_t) outputLimit + 1;
+            fileLimit.rlim_max = (rlim_t) outputLimit + 1;
+
+            //Check if the limit was set.
+            if (setrlimit(RLIMIT_FSIZE, &fileLimit) < 0) {
+
+                perror("Error: setrlimit failed.\n");
+                ReportChildError(errorPipe[1]);
+            }
+        }
+
+        studentOutputFile = open(student->outputFilePath,
+                                 O_CREAT | O_TRUNC | O_WRONLY, 777);
+
+        //Check if studentOutputFile was opened.
+        if (studentOutputFile < 0) {
+
+            perror("Error: failed to open file.\n");
+            ReportChildError(errorPipe[1]);
+        }
+
+        //Reopen the sealed input, a file of its own reads from the start.
+        sprintf(inputPath, "/proc/self/fd/%d", testCase->inputFile);
+        inputFile = open(inputPath, O_RDONLY);
+
+        //Check if inputFile was opened.
+        if (inputFile < 0) {
+
+            perror("Error: failed to open file.\n");
+            ReportChildError(errorPipe[1]);
+        }
+
+        //Redirect input and output to files.
+        dupResult = dup2(inputFile, 0);
+
+        //Check if dup succeeded.
+        if (dupResult < 0) {
+
+            perror("Error: dup2 failed.\n");
+            ReportChildError(errorPipe[1]);
+        }
+
+        dupResult = dup2(studentOutputFile, 1);
+
+        //Check if dup succeeded.
+        if (dupResult < 0) {
+
+            perror("Error: dup2 failed.\n");
+            ReportChildError(errorPipe[1]);
+        }
+
+        closeValue = close(studentOutputFile);
+
+        //Check if output file was closed.
+        if (closeValue < 0) {
+
+            perror("Error: failed to close file.\n");
+        }
+
+        closeValue = close(inputFile);
+
+        //Check if input file was closed.
+        if (closeValue < 0) {
+
+            perror("Error: failed to close file.\n");
+        }
+
+        //Execute the open program, its file is already unlinked.
+        execValue = fexecve(execFile, argsStudent, environ);
+
+        //Check if fexecve failed.
+        if (execValue == -1) {
+
+            perror("Error: execution failed.\n");
+            ReportChildError(errorPipe[1]);
+        }
+    } else {
+
+        //Variable declarations.
+        int         exitStatus;
+        int         timerStatus;
+        ssize_t     readNum;
+        struct stat outputStat;
+
+        //Attach the counters, they start when the program is executed.
+        if (options->isPerf) {
+
+            for (counter = 0; counter < COUNTER_COUNT; counter++) {
+
+                counterFiles[counter] =
+                        options->isCounterAvailable[counter] ?
+                        OpenCounter(counter, execPId) : -1;
+            }
+
+            //Let the student go.
+            close(syncPipe[0]);
+            close(syncPipe[1]);
+        }
+
+        //Wait until the program starts, or hear why it could not.
+        close(errorPipe[1]);
+
+        do {
+
+            readNum = read(errorPipe[0], &childError, sizeof(childError));
+        } while (readNum < 0 && ShouldRetry(&attempt));
+
+        close(errorPipe[0]);
+
+        //Check if the child failed before the student's program ran.
+        if (readNum == sizeof(childError)) {
+
+            errno = childError;
+            perror("Error: failed to start the student's program.\n");
+            WaitForChildExec(execPId, &exitStatus);
+
+            if (options->isPerf) {
+
+                ReadCounters(student, counterFiles);
+            }
+
+            return -1;
+        }
+
+        //Check for timeout.
+        student->isTimeOut = TimeoutHandler(execPId, &timerStatus);
+
+        //Check if the student could not be waited for.
+        if (student->isTimeOut < 0) {
+
+            student->isTimeOut = 0;
+
+            if (options->isPerf) {
+
+                ReadCounters(student, counterFiles);
+            }
+
+            return -1;
+        }
+
+        //Check if the student was killed for writing too much.
+        if (student->isTimeOut == 0 && WIFSIGNALED(timerStatus) &&
+            WTERMSIG(timerStatus) == SIGXFSZ) {
+
+            student->isOutputLimit = 1;
+        }
+
+        //A student that ignores SIGXFSZ is caught by the output's size.
+        if (outputLimit > 0 &&
+            stat(student->outputFilePath, &outputStat) == 0 &&
+            outputStat.st_size > outputLimit) {
+
+            student->isOutputLimit = 1;
+        }
+
+        if (student->isTimeOut == 1) {
+
+            //Wait for child process to finish.
+            WaitForChildExec(execPId, &exitStatus);
+        }
+
+        //The program is done, add what it counted.
+        if (options->isPerf) {
+
+            ReadCounters(student, counterFiles);
+        }
+
+        return student->isTimeOut ? 0 : 1;
+    }
+}
+
+int CompareStudentFile(Student *student, char **correctOutputs,
+                       char *studentOutput, char **compareFlags,
+                       char *reportPath) {
+
+    //Variable declarations.
+    pid_t compPId;
+    int   attempt = 0;
+
+    do {
+
+        compPId = fork();
+    } while (compPId < 0 && ShouldRetry(&attempt));
+
+    //Check if fork succeeded.
+    if(compPId == -1){
+
+        perror("Error: fork failed.\n");
+        return -1;
+    }
+
+    if (compPId == 0) {
+
+        char *argsComp[MAX_COMPARE_FLAGS + MAX_REFERENCES + 6];
+        int  compExec;
+        int  index = 0;
+        int  reference;
+
+        //Pass the comparison mode flags before the files.
+        argsComp[index++] = "./comp.out";
+
+        while (compareFlags[index - 1] != 0) {
+
+            argsComp[index] = compareFlags[index - 1];
+            index++;
+        }
+
+        //Ask for a report of where the outputs differ.
+        if (reportPath != 0) {
+
+            argsComp[index++] = "--report";
+            argsComp[index++] = reportPath;
+        }
+
+        //The comparator takes every correct output before the student's.
+        for (reference = 0; correctOutputs[reference] != 0; reference++) {
+
+            argsComp[index++] = correctOutputs[reference];
+        }
+
+        argsComp[index++] = studentOutput;
+        argsComp[index]   = 0;
+
+        //Execute comparison.
+        compExec = execvp("./comp.out", argsComp);
+
+        //Check if execution worked.
+        if (compExec == -1) {
+
+            perror("Error: execution failed.\n");
+            exit(CHILD_EXEC_FAILED);
+        }
+    }
+
+    //Wait for child process to finish.
+    if (WaitForChildExec(compPId, &student->status.compareStatus) < 0) {
+
+        return -1;
+    }
+
+    //Only the comparator's verdicts count, anything else is its failure.
+    if (!WIFEXITED(student->status.compareStatus) ||
+        WEXITSTATUS(student->status.compareStatus) < VERDICT_GREAT_JOB ||
+        WEXITSTATUS(student->status.compareStatus) > VERDICT_BAD_OUTPUT) {
+
+        fprintf(stderr, "Error: comparing %s's output failed.\n",
+                student->name);
+        return -1;
+    }
+
+    return WEXITSTATUS(student->status.compareStatus);
+}
+
+int WaitForChildExec(pid_t pid, int *status) {
+
+    //Variable declarations.
+    int waitVal;
+    int attempt = 0;
+
+    //Wait for this child only, the pre-check runs beside it.
+    do {
+
+        waitVal = waitpid(pid, status, 0);
+    } while (waitVal == -1 && ShouldRetry(&attempt));
+
+    if (waitVal == -1) {
+
+        perror("Error: wait failed.\n");
+        return -1;
+    }
+
+    //Check status.
+    if (WIFEXITED(*status)) {
+
+        //Check if the child could not start its program.
+        if (WEXITSTATUS(*status) == CHILD_EXEC_FAILED) {
+
+            return -1;
+        }
+
+        //Check if execution succeeded.
+        if (WEXITSTATUS(*status) == 1) {
+
+            return 0;
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+int WriteStudentResult(Student *student) {
+
+    //Variable declarations.
+    char resultToWrite[LINE_SIZE];
+
+    //Check that the grade is not less a negative number.
+    if (student->result.grade < 0) {
+
+        student->result.grade = 0;
+    }
+
+    //Create student result.
+    sprintf(resultToWrite, "%s,%d%s\n", student->name, student->result.grade,
+            student->result.feedback);
+
+    //Check if the result was recorded.
+    if (WriteResultLine(resultToWrite, student->options) == 0) {
+
+        return 0;
+    }
+
+    fprintf(stderr, "Error: failed to record the result of %s.\n",
+            student->name);
+
+    //A result that could not be recorded is an internal error, try to at
+    //least record that.
+    if (student->verdict != VERDICT_INTERNAL_ERROR) {
+
+        ApplyVerdict(student, VERDICT_INTERNAL_ERROR);
+        sprintf(resultToWrite, "%s,%d%s\n", student->name,
+                student->result.grade, student->result.feedback);
+        WriteResultLine(resultToWrite, student->options);
+    }
+
+    return -1;
+}
+
+int WriteResultLine(char *resultLine, Options *options) {
+
+    //Variable declarations.
+    int results;
+    int closeValue;
+    int writeValue;
+    int attempt = 0;
+
+    //Record the result in the journal before the results file. An
+    //INTERNAL_ERROR is recorded too, so a resumed run keeps its row where
+    //the uninterrupted run put it.
+    if (WriteToJournal(resultLine, options->journalPath) < 0) {
+
+        return -1;
+    }
+
+    //Open results file.
+    do {
+
+        results = open(options->resultsPath, O_APPEND | O_WRONLY, 0644);
+    } while (results < 0 && ShouldRetry(&attempt));
+
+    //Check if results file was opened.
+    if (results < 0) {
+
+        perror("Error: failed to open file.\n");
+
+        return -1;
+    }
+
+    //Write result to file.
+    writeValue = WriteToFile(results, resultLine);
+
+    closeValue = close(results);
+
+    //Check if file was closed.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close file.\n");
+
+        return -1;
+    }
+
+    return writeValue;
+}
+
+int TimeoutHandler(pid_t pid, int *status) {
+
+    //Variable declarations.
+    long long       deadline = NowMicros() + TIMEOUT_MICROS;
+    long            pause    = POLL_MIN_MICROS;
+    int             waitResult;
+    int             attempt  = 0;
+    struct timespec sleepTime;
+
+    //Run until time runs out.
+    while (NowMicros() < deadline) {
+
+        waitResult = waitpid(pid, status, WNOHANG);
+
+        //Check if waitpid worked.
+        if (waitResult < 0) {
+
+            if (ShouldRetry(&attempt)) {
+                continue;
+            }
+
+            perror("Error: waitpid failed.\n");
+            kill(pid, SIGKILL);
+            return -1;
+        }
+
+        //Check if process status was changed.
+        if (waitResult == 0) {
+
+            //Wait a little longer every time, quick programs end quickly.
+            sleepTime.tv_sec  = 0;
+            sleepTime.tv_nsec = pause * 1000;
+            nanosleep(&sleepTime, 0);
+
+            pause = pause * 2 > POLL_MAX_MICROS ? POLL_MAX_MICROS : pause * 2;
+
+        } else {
+
+            return 0;
+        }
+    }
+
+    int killResult;
+
+    //Stop the process due to timeout.
+    killResult = kill(pid, SIGKILL);
+
+    //Check if kill worked, a program that just ended cannot be killed.
+    if (killResult < 0 && errno != ESRCH) {
+
+        perror("Error: kill failed.\n");
+        return -1;
+    }
+
+    return 1;
+}
+
+Student *InitStudent(char *name, char *dirPath) {
+
+    //Variable declarations.
+    Student *student;
+    int     index;
+
+    student = (Student *) malloc(sizeof(Student));
+
+    //Check if allocation worked.
+    if (student == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Initialize student members.
+    student->dirent         = 0;
+    student->name           = strdup(name);
+    student->homePath       = dirPath;
+    student->execFilePath   = "./student.out";
+    student->outputFilePath = "studentOutput.txt";
+    student->cFilePath      = 0;
+    student->depth          = -1;
+    student->index          = -1;
+    student->sourceHash     = 0;
+    student->sourceSize     = 0;
+    student->isDuplicate    = 0;
+    student->nextDuplicate  = 0;
+    student->reportFilePath = "compareReport.txt";
+    student->mismatchLine   = 0;
+    student->mismatchColumn = 0;
+    student->similarity     = -1;
+    student->matchedReference = 0;
+    student->failedCase       = 0;
+    student->predictedCost    = 0;
+    student->previousRunTime  = -1;
+    student->isDispatched     = 0;
+    student->worker           = -1;
+    student->isFinished       = 0;
+    student->isInternalError  = 0;
+    student->archiveName      = 0;
+    student->sourceFile       = -1;
+    student->options          = 0;
+    student->fingerprints     = 0;
+    student->fingerprintCount = 0;
+    student->verdict          = 0;
+    student->casesRun         = 0;
+
+    for (index = 0; index < COUNTER_COUNT; index++) {
+
+        student->counters[index] = -1;
+    }
+
+    for (index = 0; index < STAGE_COUNT; index++) {
+
+        student->stageTimes[index] = -1;
+    }
+    strcpy(student->result.feedback, "\0");
+    student->isMultipleDirectories = 0;
+    student->isTimeOut             = 0;
+    student->isOutputLimit         = 0;
+
+    //A student that handed in an archive is named without its extension.
+    index = ArchiveSuffixLength(name);
+
+    if (index > 0) {
+
+        student->archiveName = strdup(name);
+        student->name[strlen(name) - index] = '\0';
+    }
+
+    return student;
+}
+
+void FreeStudent(Student *student) {
+
+    free(student->name);
+    free(student->cFilePath);
+    free(student->archiveName);
+    free(student->fingerprints);
+
+    if (student->sourceFile >= 0) {
+
+        close(student->sourceFile);
+    }
+
+    free(student);
+}
+
+void HandleCompilationError(Student *student) {
+
+    //Set student's grade tp 0.
+    student->result.grade = 0;
+    strcat(student->result.feedback, ",COMPILATION_ERROR");
+}
+
+void HandleTimeout(Student *student) {
+
+    //Set student's grade tp 0.
+    student->result.grade = 0;
+    strcat(student->result.feedback, ",TIMEOUT");
+}
+
+void HandleOutputLimit(Student *student) {
+
+    //Set student's grade tp 0.
+    student->result.grade = 0;
+    strcat(student->result.feedback, ",OUTPUT_LIMIT");
+}
+
+void HandleInternalError(Student *student) {
+
+    //Set student's grade tp 0.
+    student->result.grade = 0;
+    strcat(student->result.feedback, ",INTERNAL_ERROR");
+}
+
+void HandleComparisonResult(Student *student, int compareResult) {
+
+    switch (compareResult) {
+
+        case 1:
+            strcat(student->result.feedback, ",GREAT_JOB");
+            break;
+
+        case 2:
+            //Set student's grade grade - 30.
+            student->result.grade -= 30;
+            strcat(student->result.feedback, ",SIMILLAR_OUTPUT");
+            break;
+
+        case 3:
+            //Set student's grade tp 0.
+            student->result.grade = 0;
+            strcat(student->result.feedback, ",BAD_OUTPUT");
+
+            //Tell where the output went wrong when it is known.
+            if (student->mismatchLine > 0) {
+
+                sprintf(student->result.feedback +
+                        strlen(student->result.feedback),
+                        ",FIRST_DIFF=%ld:%ld", student->mismatchLine,
+                        student->mismatchColumn);
+            }
+
+            if (student->similarity >= 0) {
+
+                sprintf(student->result.feedback +
+                        strlen(student->result.feedback),
+                        ",SIMILARITY=%.1f", student->similarity);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    //Tell which of several correct outputs was matched.
+    if ((compareResult == 1 || compareResult == 2) &&
+        student->matchedReference > 0) {
+
+        sprintf(student->result.feedback + strlen(student->result.feedback),
+                ",REFERENCE=%d", student->matchedReference);
+    }
+
+    //Check C file's depth.
+    if (student->depth > 0) {
+        strcat(student->result.feedback, ",WRONG_DIRECTORY");
+    }
+}
+
+int WriteToJournal(char *resultLine, char *path) {
+
+    //Variable declarations.
+    int journalFile;
+    int syncValue;
+    int closeValue;
+    int attempt = 0;
+
+    //Open the journal for appending.
+    do {
+
+        journalFile = open(path, O_CREAT | O_APPEND | O_WRONLY, 0644);
+    } while (journalFile < 0 && ShouldRetry(&attempt));
+
+    //Check if the journal was opened.
+    if (journalFile < 0) {
+
+        perror("Error: failed to open journal.\n");
+
+        return -1;
+    }
+
+    //Check if the line was written.
+    if (WriteToFile(journalFile, resultLine) < 0) {
+
+        close(journalFile);
+
+        return -1;
+    }
+
+    //Make sure the line reached the disk before going on.
+    syncValue = fsync(journalFile);
+
+    //Check if the journal was synced.
+    if (syncValue < 0) {
+
+        perror("Error: failed to sync journal.\n");
+        close(journalFile);
+
+        return -1;
+    }
+
+    closeValue = close(journalFile);
+
+    //Check if the journal was closed.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close journal.\n");
+
+        return -1;
+    }
+
+    return 0;
+}
+
+int CompareNames(const void *first, const void *second) {
+
+    return strcmp(*(char *const *) first, *(char *const *) second);
+}
+
+void ReplayJournal(Journal *journal, Options *options) {
+
+    //Variable declarations.
+    int         journalFile;
+    int         results;
+    int         readNum;
+    int         closeValue;
+    int         lines    = 0;
+    off_t       validEnd = 0;
+    off_t       offset   = 0;
+    off_t       index;
+    struct stat journalStat;
+
+    //A watched student may have several lines, keep only the last one.
+    RewriteResultLines(options->journalPath, 1);
+
+    journalFile = open(options->journalPath, O_RDWR);
+
+    //Check if the journal was opened.
+    if (journalFile < 0) {
+
+        perror("Error: failed to open journal.\n");
+        exit(1);
+    }
+
+    //Check the journal's size.
+    if (fstat(journalFile, &journalStat) < 0) {
+
+        perror("Error: failed to stat journal.\n");
+        exit(1);
+    }
+
+    journal->content = (char *) malloc((size_t) journalStat.st_size + 1);
+
+    //Check if allocation worked.
+    if (journal->content == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Read the whole journal.
+    while (offset < journalStat.st_size) {
+
+        readNum = read(journalFile, journal->content + offset,
+                       (size_t) (journalStat.st_size - offset));
+
+        //Check if read succeeded.
+        if (readNum < 0) {
+
+            perror("Error occurred while reading from file.\n");
+            exit(1);
+        }
+
+        //Check if the file got shorter.
+        if (readNum == 0) {
+            break;
+        }
+
+        offset += readNum;
+    }
+
+    //Only complete lines are valid, a torn last line is dropped.
+    for (index = 0; index < offset; index++) {
+
+        if (journal->content[index] == '\n') {
+
+            validEnd = index + 1;
+            lines++;
+        }
+    }
+
+    //Cut the torn line off the journal so new lines follow a complete one.
+    if (ftruncate(journalFile, validEnd) < 0) {
+
+        perror("Error: failed to truncate journal.\n");
+        exit(1);
+    }
+
+    closeValue = close(journalFile);
+
+    //Check if the journal was closed.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close journal.\n");
+        exit(1);
+    }
+
+    //Rebuild the results file from the valid lines.
+    results = open(options->resultsPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if results file was opened.
+    if (results < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    for (offset = 0; offset < validEnd; offset += readNum) {
+
+        readNum = write(results, journal->content + offset,
+                        (size_t) (validEnd - offset));
+
+        //Check that the lines were written.
+        if (readNum < 0) {
+
+            perror("Error: failed to write to file.\n");
+            exit(1);
+        }
+    }
+
+    closeValue = close(results);
+
+    //Check if file was closed.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    journal->names = (char **) malloc((lines + 1) * sizeof(char *));
+
+    //Check if allocation worked.
+    if (journal->names == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Split the lines and keep each line's student name.
+    journal->count = 0;
+    offset         = 0;
+
+    for (index = 0; index < validEnd; index++) {
+
+        //Cut the name at the first comma and the line at its end.
+        if (journal->content[index] == ',' || journal->content[index] == '\n') {
+
+            if (offset >= 0) {
+
+                journal->names[journal->count++] = journal->content + offset;
+                offset = -1;
+            }
+
+            if (journal->content[index] == '\n') {
+
+                offset = index + 1;
+            }
+
+            journal->content[index] = '\0';
+        }
+    }
+
+    qsort(journal->names, (size_t) journal->count, sizeof(char *),
+          CompareNames);
+}
+
+int IsStudentFinished(Journal *journal, char *name) {
+
+    //Check if there is anything to search.
+    if (journal->count == 0) {
+
+        return 0;
+    }
+
+    return bsearch(&name, journal->names, (size_t) journal->count,
+                   sizeof(char *), CompareNames) != 0;
+}
+
+void FreeJournal(Journal *journal) {
+
+    free(journal->names);
+    free(journal->content);
+}
+
+void CreateResultFiles(Options *options) {
+
+    //Variable declarations.
+    int results;
+    int closeValue;
+
+    results = open(options->resultsPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if results file was opened.
+    if (results < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    //Close the results file.
+    closeValue = close(results);
+
+    //Check if closed file.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    results = open(options->journalPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if journal was opened.
+    if (results < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    closeValue = close(results);
+
+    //Check if closed file.
+    if (closeValue < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+}
+
+void ParseArguments(int argc, char *argv[], Options *options) {
+
+    //Variable declarations.
+    int index;
+
+    options->configPath  = 0;
+    options->configCount = 0;
+    options->assignment  = 0;
+    options->cacheDir    = 0;
+    options->dirPath     = 0;
+    options->historyPath = 0;
+    options->isResume    = 0;
+    options->workers     = 0;
+    options->outputLimit = 0;
+    options->inputPath   = 0;
+    options->outputCount = 0;
+    options->statsPath   = 0;
+
+    options->compareFlagCount = 0;
+    options->compareFlags[0]  = 0;
+    options->isDiffFeedback   = 0;
+    options->isPrecheck       = 1;
+    options->isPerf           = 0;
+    options->testsPath        = 0;
+    options->testCases        = 0;
+    options->testCaseCount    = 0;
+    options->isWatch          = 0;
+    options->watchDebounce    = WATCH_DEBOUNCE_MICROS;
+    options->isAffinity       = 0;
+    options->cpuSlots         = 0;
+    options->cpuSlot          = 0;
+    options->resultsPath      = RESULTS_FILE;
+    options->journalPath      = JOURNAL_FILE;
+    options->groupsPath       = GROUPS_FILE;
+    options->storePath        = STORE_FILE;
+    options->isPlagiarism     = 0;
+    options->plagiarismPath   = PLAGIARISM_FILE;
+
+    options->plagiarismThreshold = PLAGIARISM_THRESHOLD;
+    options->plagiarismCommon    = PLAGIARISM_COMMON;
+    options->plagiarismStarter   = 0;
+    options->configPaths      = (char **) malloc(argc * sizeof(char *));
+
+    //Check if allocation worked.
+    if (options->configPaths == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    for (index = 1; index < argc; index++) {
+
+        if (strcmp(argv[index], "--resume") == 0) {
+
+            options->isResume = 1;
+
+        } else if (strcmp(argv[index], "--workers") == 0 && index + 1 < argc) {
+
+            options->workers = atoi(argv[++index]);
+
+            //Check that the amount of workers is legal.
+            if (options->workers < 1) {
+
+                fprintf(stderr, "Error: illegal amount of workers.\n");
+                exit(1);
+            }
+
+        } else if (strcmp(argv[index], "--output-limit") == 0 &&
+                   index + 1 < argc) {
+
+            options->outputLimit = atol(argv[++index]);
+
+            //Check that the output limit is legal.
+            if (options->outputLimit < 1) {
+
+                fprintf(stderr, "Error: illegal output limit.\n");
+                exit(1);
+            }
+
+        } else if (strcmp(argv[index], "--stats") == 0 && index + 1 < argc) {
+
+            options->statsPath = argv[++index];
+
+        } else if (strcmp(argv[index], "--tests") == 0 && index + 1 < argc) {
+
+            options->testsPath = argv[++index];
+
+        } else if (strcmp(argv[index], "--perf") == 0) {
+
+            options->isPerf = 1;
+
+        } else if (strcmp(argv[index], "--watch") == 0) {
+
+            options->isWatch = 1;
+
+        } else if (strcmp(argv[index], "--affinity") == 0) {
+
+            options->isAffinity = 1;
+
+        } else if (strcmp(argv[index], "--plagiarism") == 0) {
+
+            options->isPlagiarism = 1;
+
+        } else if (strcmp(argv[index], "--no-precheck") == 0) {
+
+            options->isPrecheck = 0;
+
+        } else if (strcmp(argv[index], "--diff-feedback") == 0) {
+
+            options->isDiffFeedback = 1;
+
+        } else if ((strcmp(argv[index], "--compare-mode") == 0 ||
+                    strcmp(argv[index], "--abs-eps") == 0 ||
+                    strcmp(argv[index], "--rel-eps") == 0 ||
+                    strcmp(argv[index], "--distance-budget") == 0 ||
+                    strcmp(argv[index], "--compare-threads") == 0) &&
+                   index + 1 < argc &&
+                   options->compareFlagCount + 2 <= MAX_COMPARE_FLAGS) {
+
+            //Hand the flag to the comparator, which names the mode --mode.
+            options->compareFlags[options->compareFlagCount++] =
+                    strcmp(argv[index], "--compare-mode") == 0 ? "--mode" :
+                    strcmp(argv[index], "--compare-threads") == 0 ?
+                    "--threads" : argv[index];
+            options->compareFlags[options->compareFlagCount++] = argv[++index];
+            options->compareFlags[options->compareFlagCount]   = 0;
+
+            //The distance is only measured for the feedback.
+            if (strcmp(argv[index - 1], "--distance-budget") == 0) {
+
+                options->isDiffFeedback = 1;
+            }
+
+        } else if (argv[index][0] != '-') {
+
+            //Every configuration is an assignment of its own.
+            options->configPaths[options->configCount++] = argv[index];
+
+        } else {
+
+            fprintf(stderr, "Error: unknown parameter %s.\n", argv[index]);
+            exit(1);
+        }
+    }
+
+    //Check that the configuration file was given.
+    if (options->configCount == 0) {
+
+        perror("Error: wrong number of parameters.\n");
+        exit(1);
+    }
+
+    options->configPath = options->configPaths[0];
+}
+
+Options *LoadAssignments(Options *options) {
+
+    //Variable declarations.
+    static char *suffixes[ASSIGNMENT_FILES] = {".results.csv",
+                                               ".results.journal",
+                                               ".groups.csv", ".results.col",
+                                               ".plagiarism.csv",
+                                               ".history.csv"};
+    Options     *assignments;
+    Options     *assignment;
+    char        *name;
+    char        *extension;
+    char        *names;
+    char        **paths[ASSIGNMENT_FILES];
+    int         index;
+    int         other;
+    int         file;
+    int         length;
+    int         workers    = 0;
+    int         isAffinity = 0;
+    char        *statsPath = 0;
+
+    assignments = (Options *) malloc(options->configCount * sizeof(Options));
+
+    //Check if allocation worked.
+    if (assignments == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    for (index = 0; index < options->configCount; index++) {
+
+        //The command line flags hold for every assignment.
+        assignment             = &assignments[index];
+        *assignment            = *options;
+        assignment->configPath = options->configPaths[index];
+        assignment->assignment = index;
+
+        LoadConfig(assignment);
+
+        //Name the assignment's files after its configuration, without the
+        //directory and the extension.
+        if (options->configCount > 1) {
+
+            name      = strrchr(assignment->configPath, '/');
+            name      = name != 0 ? name + 1 : assignment->configPath;
+            extension = strrchr(name, '.');
+            length    = extension != 0 && extension != name ?
+                        (int) (extension - name) : (int) strlen(name);
+
+            //The names share one allocation that starts at the results path.
+            names = (char *) malloc(ASSIGNMENT_FILES * (length + 20));
+
+            //Check if allocation worked.
+            if (names == 0) {
+
+                perror("Error: malloc failed.\n");
+                exit(1);
+            }
+
+            paths[0] = &assignment->resultsPath;
+            paths[1] = &assignment->journalPath;
+            paths[2] = &assignment->groupsPath;
+            paths[3] = &assignment->storePath;
+            paths[4] = &assignment->plagiarismPath;
+            paths[5] = &assignment->historyPath;
+
+            for (file = 0; file < ASSIGNMENT_FILES; file++) {
+
+                //A history the configuration names is kept.
+                if (paths[file] == &assignment->historyPath &&
+                    assignment->historyPath != 0) {
+                    continue;
+                }
+
+                *paths[file] = names;
+                names += sprintf(names, "%.*s%s", length, name,
+                                 suffixes[file]) + 1;
+            }
+        }
+
+        ValidateOptions(assignment);
+
+        //Read every input once, the workers inherit the sealed copies.
+        LoadTestCases(assignment);
+
+        //Find out which counters can be measured before the workers start.
+        if (assignment->isPerf) {
+
+            ProbeCounters(assignment);
+        }
+
+        for (other = 0; other < index; other++) {
+
+            //Check that the assignments do not write over each other.
+            if (strcmp(assignments[other].resultsPath,
+                       assignment->resultsPath) == 0 ||
+                strcmp(assignments[other].historyPath,
+                       assignment->historyPath) == 0) {
+
+                fprintf(stderr, "Error: the assignments %s and %s would "
+                                "write the same files.\n",
+                        assignments[other].configPath,
+                        assignment->configPath);
+                exit(1);
+            }
+        }
+
+        //The workers, statistics and cores are shared by every assignment.
+        if (assignment->workers > workers) {
+
+            workers = assignment->workers;
+        }
+
+        if (statsPath == 0) {
+
+            statsPath = assignment->statsPath;
+        }
+
+        isAffinity |= assignment->isAffinity;
+    }
+
+    //Check that a watch has only one students directory to follow.
+    if (options->configCount > 1) {
+
+        for (index = 0; index < options->configCount; index++) {
+
+            if (assignments[index].isWatch) {
+
+                fprintf(stderr, "Error: only a single assignment can be "
+                                "watched.\n");
+                exit(1);
+            }
+        }
+    }
+
+    assignments[0].workers    = workers;
+    assignments[0].isAffinity = isAffinity;
+
+    //Split the cores before any process that needs them starts.
+    if (isAffinity) {
+
+        PlanAffinity(&assignments[0]);
+    }
+
+    //The same C file handed in for several assignments compiles once.
+    if (options->configCount > 1) {
+
+        assignments[0].cacheDir = strdup(CACHE_DIR_TEMPLATE);
+
+        //Check if the cache directory was made.
+        if (assignments[0].cacheDir == 0 ||
+            mkdtemp(assignments[0].cacheDir) == 0) {
+
+            perror("Error: failed to create the compile cache.\n");
+            exit(1);
+        }
+    }
+
+    for (index = 1; index < options->configCount; index++) {
+
+        assignments[index].workers     = workers;
+        assignments[index].statsPath   = statsPath;
+        assignments[index].isAffinity  = assignments[0].isAffinity;
+        assignments[index].cpuSlots    = assignments[0].cpuSlots;
+        assignments[index].compilePool = assignments[0].compilePool;
+        assignments[index].cacheDir    = assignments[0].cacheDir;
+    }
+
+    assignments[0].statsPath = statsPath;
+
+    return assignments;
+}
+
+int GradeStudent(Student *student, Options *options) {
+
+    //Variable declarations.
+    int       compileResult;
+    int       caseVerdict;
+    int       verdict = VERDICT_GREAT_JOB;
+    int       execFile;
+    int       unlinkResult;
+    int       caseIndex;
+    int       isReportRead;
+    int       executeResult;
+    int       attempt = 0;
+    long long stageStart;
+    TestCase  *testCase;
+
+    //Compiles the C file.
+    stageStart    = NowMicros();
+    compileResult = CompileStudentFile(student);
+    student->stageTimes[STAGE_COMPILE] = NowMicros() - stageStart;
+
+    //Check if gcc could not be run.
+    if (compileResult < 0) {
+
+        return VERDICT_INTERNAL_ERROR;
+    }
+
+    //Check if compilation failed.
+    if (compileResult == 0) {
+
+        return VERDICT_COMPILATION_ERROR;
+    }
+
+    //Keep the program open for every test case, the file is not needed.
+    do {
+
+        execFile = open(student->execFilePath, O_RDONLY | O_CLOEXEC);
+    } while (execFile < 0 && ShouldRetry(&attempt));
+
+    //Check if the program was opened.
+    if (execFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        unlink(student->execFilePath);
+        return VERDICT_INTERNAL_ERROR;
+    }
+
+    //Unlinks exe file.
+    unlinkResult = unlink(student->execFilePath);
+
+    //Check if unlinked file, the open program still runs.
+    if (unlinkResult < 0) {
+
+        perror("Error: failed to unlink file.\n");
+    }
+
+    student->stageTimes[STAGE_EXECUTE] = 0;
+    student->stageTimes[STAGE_COMPARE] = 0;
+
+    for (caseIndex = 0; caseIndex < options->testCaseCount; caseIndex++) {
+
+        testCase     = &options->testCases[caseIndex];
+        isReportRead = options->isDiffFeedback || testCase->outputCount > 1;
+
+        //Executes the program on the test case.
+        stageStart = NowMicros();
+        executeResult = ExecuteStudentFile(student, execFile, testCase,
+                                           options);
+        student->stageTimes[STAGE_EXECUTE] += NowMicros() - stageStart;
+        student->casesRun++;
+
+        //Check if the program could not be run.
+        if (executeResult < 0) {
+
+            caseVerdict = VERDICT_INTERNAL_ERROR;
+
+        //Check if there was a timeout.
+        } else if (student->isTimeOut) {
+
+            caseVerdict = VERDICT_TIMEOUT;
+
+        //Check if the output went over the limit.
+        } else if (student->isOutputLimit) {
+
+            caseVerdict = VERDICT_OUTPUT_LIMIT;
+
+        } else {
+
+            //Compare the student's result to the correct answers.
+            stageStart  = NowMicros();
+            caseVerdict = CompareStudentFile(student, testCase->outputPaths,
+                                             student->outputFilePath,
+                                             options->compareFlags,
+                                             isReportRead ?
+                                             student->reportFilePath : 0);
+            student->stageTimes[STAGE_COMPARE] += NowMicros() - stageStart;
+
+            //Keep where the output went wrong and which output it matched.
+            if (isReportRead && caseVerdict > 0 &&
+                ReadCompareReport(student) < 0) {
+
+                caseVerdict = VERDICT_INTERNAL_ERROR;
+            }
+
+            //Check if the comparison failed.
+            if (caseVerdict < 0) {
+
+                caseVerdict = VERDICT_INTERNAL_ERROR;
+            }
+
+            //The position is only fed back when asked for.
+            if (!options->isDiffFeedback) {
+
+                student->mismatchLine = 0;
+            }
+        }
+
+        //Unlink student's output file.
+        unlinkResult = unlink(student->outputFilePath);
+
+        //Check if unlinked file, a program that never ran left none.
+        if (unlinkResult < 0 && errno != ENOENT) {
+
+            perror("Error: failed to unlink file.\n");
+        }
+
+        //Keep the worst verdict of the test cases.
+        if (VerdictRank(caseVerdict) > VerdictRank(verdict)) {
+
+            verdict = caseVerdict;
+        }
+
+        //Check if the case already decided the grade.
+        if (caseVerdict != VERDICT_GREAT_JOB &&
+            caseVerdict != VERDICT_SIMILAR_OUTPUT) {
+
+            //Name the failed case only when there are several.
+            if (options->testCaseCount > 1) {
+
+                student->failedCase = caseIndex + 1;
+            }
+            break;
+        }
+    }
+
+    //Check if the program was closed.
+    if (close(execFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+    }
+
+    return verdict;
+}
+
+void AddStudent(StudentList *list, Student *student) {
+
+    //Check if the list is full.
+    if (list->count == list->capacity) {
+
+        list->capacity = list->capacity == 0 ? 64 : list->capacity * 2;
+        list->items    = (Student **) realloc(list->items,
+                                              list->capacity *
+                                              sizeof(Student *));
+
+        //Check if allocation worked.
+        if (list->items == 0) {
+
+            perror("Error: realloc failed.\n");
+            exit(1);
+        }
+    }
+
+    student->index = list->count;
+    list->items[list->count++] = student;
+}
+
+int FillLineReader(LineReader *reader) {
+
+    //Variable declarations.
+    int readNum;
+    int attempt = 0;
+
+    //Check that a line can still fit.
+    if (reader->length == LINE_SIZE) {
+
+        fprintf(stderr, "Error: message line too long.\n");
+
+        return -1;
+    }
+
+    do {
+
+        readNum = read(reader->fd, reader->buffer + reader->length,
+                       LINE_SIZE - reader->length);
+    } while (readNum < 0 && ShouldRetry(&attempt));
+
+    //Check if read succeeded.
+    if (readNum < 0) {
+
+        perror("Error occurred while reading from socket.\n");
+
+        return -1;
+    }
+
+    reader->length += readNum;
+
+    return readNum;
+}
+
+int NextLine(LineReader *reader, char *line) {
+
+    //Variable declarations.
+    char *end;
+    int  lineLength;
+
+    end = memchr(reader->buffer, '\n', (size_t) reader->length);
+
+    //Check if a full line arrived.
+    if (end == 0) {
+
+        return 0;
+    }
+
+    lineLength = (int) (end - reader->buffer);
+    memcpy(line, reader->buffer, (size_t) lineLength);
+    line[lineLength] = '\0';
+
+    //Move the rest of the bytes to the start.
+    reader->length -= lineLength + 1;
+    memmove(reader->buffer, end + 1, (size_t) reader->length);
+
+    return 1;
+}
+
+void RunWorker(int socket, int slot, Options *options) {
+
+    //Variable declarations.
+    char               execFilePath[MAX_SIZE];
+    char               outputFilePath[MAX_SIZE];
+    char               reportFilePath[MAX_SIZE];
+    char               line[LINE_SIZE];
+    char               message[LINE_SIZE];
+    int                isRunning  = 1;
+    int                isIdleSent = 1;
+    int                head       = 0;
+    int                tail       = 0;
+    int                index;
+    int                assignment;
+    int                verdict;
+    int                pathStart;
+    int                give;
+    int                length;
+    long long          sourceSize;
+    unsigned long long sourceHash;
+    struct pollfd      pollSocket;
+    StudentList        tasks      = {0, 0, 0};
+    LineReader         *reader;
+    Student            *student;
+
+    //Move to the slot's node first, so its memory is touched there.
+    for (index = 0; index < options->configCount; index++) {
+
+        options[index].cpuSlot = slot;
+    }
+
+    if (options->isAffinity) {
+
+        PinProcess(&options->cpuSlots[slot].compileCpus);
+    }
+
+    reader = (LineReader *) malloc(sizeof(LineReader));
+
+    //Check if allocation worked.
+    if (reader == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    reader->fd     = socket;
+    reader->length = 0;
+
+    //Every worker compiles and runs into its own files.
+    sprintf(execFilePath, "./student_%d.out", slot);
+    sprintf(outputFilePath, "studentOutput_%d.txt", slot);
+    sprintf(reportFilePath, "compareReport_%d.txt", slot);
+
+    pollSocket.fd     = socket;
+    pollSocket.events = POLLIN;
+
+    while (isRunning) {
+
+        //Block for messages when out of work, else only check for them.
+        if (head == tail) {
+
+            //Tell the coordinator once that the work ran out.
+            if (!isIdleSent) {
+
+                //Check if the coordinator is gone.
+                if (WriteToFile(socket, "IDLE\n") < 0) {
+                    break;
+                }
+
+                isIdleSent = 1;
+            }
+
+            //Check if the coordinator is gone.
+            if (FillLineReader(reader) <= 0) {
+                break;
+            }
+
+        } else if (poll(&pollSocket, 1, 0) > 0) {
+
+            //Check if the coordinator is gone.
+            if (FillLineReader(reader) <= 0) {
+                break;
+            }
+        }
+
+        while (NextLine(reader, line)) {
+
+            if (sscanf(line, "TASK %d %d %llx %lld %n", &index,
+                       &assignment, &sourceHash, &sourceSize,
+                       &pathStart) == 4 &&
+                assignment >= 0 && assignment < options->configCount) {
+
+                student = InitStudent("", "");
+                student->options        = &options[assignment];
+                student->sourceHash     = sourceHash;
+                student->sourceSize     = (off_t) sourceSize;
+                student->cFilePath      = strdup(line + pathStart);
+                student->execFilePath   = execFilePath;
+
+                //The worker opens the C file itself, an archived one is
+                //unpacked again when it is compiled.
+                student->sourceFile     = -1;
+                student->outputFilePath = outputFilePath;
+                student->reportFilePath = reportFilePath;
+
+                //Reset the queue once it was drained.
+                if (head == tail) {
+
+                    head = tail = tasks.count = 0;
+                }
+
+                //Keep the coordinator's index instead of the queue position.
+                AddStudent(&tasks, student);
+                student->index = index;
+                tail       = tasks.count;
+                isIdleSent = 0;
+
+            } else if (strcmp(line, "STEAL") == 0) {
+
+                //Give back the unstarted second half of the queue.
+                give   = (tail - head + 1) / 2;
+                length = sprintf(message, "RETURN %d", give);
+
+                while (give > 0) {
+
+                    student = tasks.items[--tail];
+                    length += sprintf(message + length, " %d",
+                                      student->index);
+                    FreeStudent(student);
+                    give--;
+                }
+
+                tasks.count = tail;
+                strcpy(message + length, "\n");
+
+                //Check if the coordinator is gone.
+                if (WriteToFile(socket, message) < 0) {
+
+                    isRunning = 0;
+                }
+
+            } else if (strcmp(line, "QUIT") == 0) {
+
+                isRunning = 0;
+            }
+        }
+
+        //Grade the next student in the queue.
+        if (isRunning && head < tail) {
+
+            student = tasks.items[head++];
+            verdict = GradeStudent(student, student->options);
+
+            sprintf(message, "DONE %d %d %lld %lld %lld %ld %ld %.1f %d %d "
+                             "%d %lld %lld %lld %lld %lld\n",
+                    student->index, verdict,
+                    student->stageTimes[STAGE_COMPILE],
+                    student->stageTimes[STAGE_EXECUTE],
+                    student->stageTimes[STAGE_COMPARE],
+                    student->mismatchLine, student->mismatchColumn,
+                    student->similarity, student->matchedReference,
+                    student->failedCase, student->casesRun,
+                    student->counters[COUNTER_INSTRUCTIONS],
+                    student->counters[COUNTER_CYCLES],
+                    student->counters[COUNTER_CACHE_MISSES],
+                    student->counters[COUNTER_BRANCH_MISSES],
+                    student->counters[COUNTER_TASK_CLOCK]);
+            FreeStudent(student);
+
+            //Check if the coordinator is gone.
+            if (WriteToFile(socket, message) < 0) {
+
+                isRunning = 0;
+            }
+        }
+    }
+
+    free(tasks.items);
+    free(reader);
+}
+
+int SendBatch(Worker *workers, int worker, StudentList *students,
+              int *pending, int *pendingStart, int *pendingSize,
+              int workerCount) {
+
+    //Variable declarations.
+    char    message[LINE_SIZE];
+    int     batch;
+    Student *student;
+
+    //Split what is left evenly, but never more than a full batch.
+    batch = (*pendingSize + workerCount - 1) / workerCount;
+
+    if (batch > WORKER_BATCH) {
+
+        batch = WORKER_BATCH;
+    }
+
+    while (batch > 0 && *pendingSize > 0) {
+
+        student = students->items[pending[*pendingStart]];
+        *pendingStart = (*pendingStart + 1) % students->count;
+        (*pendingSize)--;
+
+        //Skip the students the pre-check already finished.
+        if (student->isFinished) {
+            continue;
+        }
+
+        batch--;
+
+        //Only the path and the hash of the C file are sent, so a worker needs
+        //nothing of the coordinator but the submissions.
+        sprintf(message, "TASK %d %d %llx %lld %s\n", student->index,
+                student->options->assignment, student->sourceHash,
+                (long long) student->sourceSize, student->cFilePath);
+
+        //Check if the worker is gone, the student stays in the queue.
+        if (WriteToFile(workers[worker].reader.fd, message) < 0) {
+
+            *pendingStart = (*pendingStart + students->count - 1) %
+                            students->count;
+            (*pendingSize)++;
+
+            return -1;
+        }
+
+        workers[worker].outstanding++;
+        workers[worker].isIdle = 0;
+        student->isDispatched  = 1;
+        student->worker        = worker;
+
+        //A slow student closes the batch, the rest go to other workers.
+        if (student->predictedCost >= HEAVY_COST_MICROS) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+void RemoveWorker(Worker *workers, int worker, StudentList *students,
+                  int *pending, int pendingStart, int *pendingSize) {
+
+    //Variable declarations.
+    int     index;
+    Student *student;
+
+    fprintf(stderr, "Warning: worker %d exited, its students go to the other "
+                    "workers.\n", worker);
+
+    //Make sure the worker is gone before reaping it.
+    kill(workers[worker].pid, SIGKILL);
+    close(workers[worker].reader.fd);
+    waitpid(workers[worker].pid, 0, 0);
+
+    //What the worker graded but did not report is graded again.
+    for (index = 0; index < students->count; index++) {
+
+        student = students->items[index];
+
+        if (!student->isDispatched || student->isFinished ||
+            student->worker != worker) {
+            continue;
+        }
+
+        student->isDispatched = 0;
+        pending[(pendingStart + *pendingSize) % students->count] = index;
+        (*pendingSize)++;
+    }
+
+    workers[worker].reader.fd      = -1;
+    workers[worker].outstanding    = 0;
+    workers[worker].isIdle         = 0;
+    workers[worker].isStealPending = 0;
+    workers[worker].isAlive        = 0;
+}
+
+void RunCoordinator(StudentList *students, Options *options, Stats *stats,
+                    LineReader *precheck) {
+
+    //Variable declarations.
+    char          line[LINE_SIZE];
+    int           sockets[2];
+    int           *pending;
+    int           pendingStart = 0;
+    int           pendingSize  = 0;
+    int           finished     = 0;
+    int           workerCount = options->workers;
+    int           aliveCount;
+    long long     stageTimes[STAGE_COUNT];
+    long          mismatchLine;
+    long          mismatchColumn;
+    double        similarity;
+    int           matchedReference;
+    int           failedCase;
+    int           casesRun;
+    long long     counters[COUNTER_COUNT];
+    int           index;
+    int           other;
+    int           verdict;
+    int           count;
+    int           offset;
+    int           victim;
+    int           isStealing;
+    int           attempt;
+    Worker        *workers;
+    struct pollfd *pollSockets;
+
+    //Check if there is anything to grade.
+    if (students->count == 0) {
+
+        return;
+    }
+
+    //A watch grades in rounds, every one with its own workers.
+    free(stats->workerOutstanding);
+    free(stats->workerBusy);
+
+    stats->workerCount       = workerCount;
+    stats->workerOutstanding = (int *) calloc(workerCount, sizeof(int));
+    stats->workerBusy        = (long long *) calloc(workerCount,
+                                                    sizeof(long long));
+    workers     = (Worker *) malloc(workerCount * sizeof(Worker));
+    pollSockets = (struct pollfd *) malloc((workerCount + 1) *
+                                           sizeof(struct pollfd));
+    pending     = (int *) malloc(students->count * sizeof(int));
+
+    //Check if allocation worked.
+    if (workers == 0 || pollSockets == 0 || pending == 0 ||
+        stats->workerOutstanding == 0 || stats->workerBusy == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //All the students start in the shared queue.
+    for (index = 0; index < students->count; index++) {
+
+        pending[index] = index;
+    }
+
+    pendingSize = students->count;
+
+    //A worker that died should be noticed by its socket, not by a signal.
+    signal(SIGPIPE, SIG_IGN);
+
+    //Start the workers.
+    for (index = 0; index < workerCount; index++) {
+
+        //Check if the socket pair was created. The students' programs must
+        //not hold a worker's socket, or its death is never noticed.
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0,
+                       sockets) < 0) {
+
+            perror("Error: socketpair failed.\n");
+            exit(1);
+        }
+
+        attempt = 0;
+
+        do {
+
+            workers[index].pid = fork();
+        } while (workers[index].pid < 0 && ShouldRetry(&attempt));
+
+        //Check if fork succeeded.
+        if (workers[index].pid < 0) {
+
+            perror("Error: fork failed.\n");
+            exit(1);
+        }
+
+        if (workers[index].pid == 0) {
+
+            //Keep only this worker's end of the sockets.
+            for (other = 0; other < index; other++) {
+
+                close(workers[other].reader.fd);
+            }
+
+            //The pre-check only talks to the coordinator.
+            if (precheck->fd >= 0) {
+
+                close(precheck->fd);
+            }
+
+            close(sockets[0]);
+            RunWorker(sockets[1], index, options);
+            exit(0);
+        }
+
+        close(sockets[1]);
+
+        workers[index].reader.fd      = sockets[0];
+        workers[index].reader.length  = 0;
+        workers[index].outstanding    = 0;
+        workers[index].isIdle         = 1;
+        workers[index].isStealPending = 0;
+        workers[index].isAlive        = 1;
+        pollSockets[index].fd         = sockets[0];
+        pollSockets[index].events     = POLLIN;
+    }
+
+    //The pre-check is polled after the workers, -1 once it is done.
+    pollSockets[workerCount].events = POLLIN;
+
+    while (finished < students->count) {
+
+        isStealing = 0;
+        victim     = -1;
+        aliveCount = 0;
+
+        //Count the workers still running.
+        for (index = 0; index < workerCount; index++) {
+
+            aliveCount += workers[index].isAlive;
+        }
+
+        //Check if any worker is left to grade the rest.
+        if (aliveCount == 0) {
+
+            fprintf(stderr, "Error: every worker exited.\n");
+            exit(1);
+        }
+
+        //Hand out work to the idle workers.
+        for (index = 0; index < workerCount; index++) {
+
+            //Check if the worker died.
+            if (workers[index].isIdle && pendingSize > 0 &&
+                SendBatch(workers, index, students, pending, &pendingStart,
+                          &pendingSize, aliveCount) < 0) {
+
+                RemoveWorker(workers, index, students, pending, pendingStart,
+                             &pendingSize);
+            }
+
+            if (!workers[index].isAlive) {
+                continue;
+            }
+
+            isStealing |= workers[index].isStealPending;
+
+            //Remember the busiest worker.
+            if (victim < 0 ||
+                workers[index].outstanding > workers[victim].outstanding) {
+
+                victim = index;
+            }
+        }
+
+        //Steal for the idle workers once the shared queue ran dry.
+        if (pendingSize == 0 && !isStealing &&
+            workers[victim].outstanding > 1) {
+
+            for (index = 0; index < workerCount; index++) {
+
+                if (workers[index].isIdle) {
+
+                    //Check if the worker died.
+                    if (WriteToFile(workers[victim].reader.fd,
+                                    "STEAL\n") < 0) {
+
+                        RemoveWorker(workers, victim, students, pending,
+                                     pendingStart, &pendingSize);
+                        break;
+                    }
+
+                    workers[victim].isStealPending = 1;
+                    break;
+                }
+            }
+        }
+
+        //Refresh the queue depths in the statistics.
+        for (index = 0; index < workerCount; index++) {
+
+            stats->workerOutstanding[index] = workers[index].outstanding;
+        }
+
+        stats->pending = pendingSize;
+        WriteStats(stats, 0);
+
+        //A dead worker is not polled.
+        for (index = 0; index < workerCount; index++) {
+
+            pollSockets[index].fd = workers[index].reader.fd;
+        }
+
+        pollSockets[workerCount].fd = precheck->fd;
+
+        //Wait for messages from the workers, waking up for the statistics.
+        if (poll(pollSockets, workerCount + 1,
+                 stats->path != 0 ? STATS_INTERVAL / 1000 : -1) < 0) {
+
+            perror("Error: poll failed.\n");
+            exit(1);
+        }
+
+        //Finish the students the pre-check found.
+        if (pollSockets[workerCount].revents != 0) {
+
+            finished += ReadPrecheck(precheck, students, stats);
+        }
+
+        for (index = 0; index < workerCount; index++) {
+
+            //Check if the worker sent anything.
+            if (pollSockets[index].revents == 0) {
+                continue;
+            }
+
+            //Check if the worker died.
+            if (FillLineReader(&workers[index].reader) <= 0) {
+
+                RemoveWorker(workers, index, students, pending, pendingStart,
+                             &pendingSize);
+                continue;
+            }
+
+            while (NextLine(&workers[index].reader, line)) {
+
+                if (sscanf(line, "DONE %d %d %lld %lld %lld %ld %ld %lf %d %d "
+                                 "%d %lld %lld %lld %lld %lld",
+                           &other, &verdict, &stageTimes[STAGE_COMPILE],
+                           &stageTimes[STAGE_EXECUTE],
+                           &stageTimes[STAGE_COMPARE], &mismatchLine,
+                           &mismatchColumn, &similarity, &matchedReference,
+                           &failedCase, &casesRun,
+                           &counters[COUNTER_INSTRUCTIONS],
+                           &counters[COUNTER_CYCLES],
+                           &counters[COUNTER_CACHE_MISSES],
+                           &counters[COUNTER_BRANCH_MISSES],
+                           &counters[COUNTER_TASK_CLOCK]) == 16) {
+
+                    students->items[other]->matchedReference =
+                            matchedReference;
+                    students->items[other]->failedCase = failedCase;
+                    students->items[other]->casesRun   = casesRun;
+
+                    memcpy(students->items[other]->counters, counters,
+                           sizeof(counters));
+
+                    students->items[other]->mismatchLine   = mismatchLine;
+                    students->items[other]->mismatchColumn = mismatchColumn;
+                    students->items[other]->similarity     = similarity;
+
+                    //Count the time the worker was busy with the student.
+                    for (count = 0; count < STAGE_COUNT; count++) {
+
+                        students->items[other]->stageTimes[count] =
+                                stageTimes[count];
+
+                        if (stageTimes[count] > 0) {
+
+                            stats->workerBusy[index] += stageTimes[count];
+                        }
+                    }
+
+                    FinishStudent(students->items[other], verdict, stats);
+
+                    students->items[other]->isDispatched = 0;
+                    workers[index].outstanding--;
+                    finished++;
+
+                } else if (strcmp(line, "IDLE") == 0) {
+
+                    workers[index].isIdle = 1;
+
+                } else if (sscanf(line, "RETURN %d%n", &count,
+                                  &offset) == 1) {
+
+                    //Put the returned students back in the shared queue.
+                    while (count > 0 &&
+                           sscanf(line + offset, " %d%n", &other,
+                                  &verdict) == 1) {
+
+                        offset += verdict;
+                        students->items[other]->isDispatched = 0;
+                        pending[(pendingStart + pendingSize) %
+                                students->count] = other;
+                        pendingSize++;
+                        workers[index].outstanding--;
+                        count--;
+                    }
+
+                    workers[index].isStealPending = 0;
+                }
+            }
+        }
+    }
+
+    //Stop the workers, one that already left does not need to be told.
+    for (index = 0; index < workerCount; index++) {
+
+        if (!workers[index].isAlive) {
+            continue;
+        }
+
+        WriteToFile(workers[index].reader.fd, "QUIT\n");
+        close(workers[index].reader.fd);
+        waitpid(workers[index].pid, 0, 0);
+    }
+
+    //Write the final statistics while the worker counters still exist.
+    stats->pending = 0;
+
+    for (index = 0; index < workerCount; index++) {
+
+        stats->workerOutstanding[index] = 0;
+    }
+
+    WriteStats(stats, 1);
+
+    free(pending);
+    free(pollSockets);
+    free(workers);
+}
+
+void ApplyVerdict(Student *student, int verdict) {
+
+    //Variable declarations.
+    static char *counterNames[COUNTER_COUNT] = {"INSTRUCTIONS", "CYCLES",
+                                                "CACHE_MISSES",
+                                                "BRANCH_MISSES", "CPU_US"};
+    int         counter;
+
+    student->verdict = verdict;
+
+    //Set student's grade tp 100 - 10 * depth.
+    student->result.grade = 100 - (10 * student->depth);
+    strcpy(student->result.feedback, "\0");
+
+    switch (verdict) {
+
+        case VERDICT_COMPILATION_ERROR:
+            HandleCompilationError(student);
+            break;
+
+        case VERDICT_TIMEOUT:
+            HandleTimeout(student);
+            break;
+
+        case VERDICT_OUTPUT_LIMIT:
+            HandleOutputLimit(student);
+            break;
+
+        case VERDICT_INTERNAL_ERROR:
+            HandleInternalError(student);
+            break;
+
+        default:
+            HandleComparisonResult(student, verdict);
+            break;
+    }
+
+    //Tell which test case failed when there are several.
+    if (student->failedCase > 0) {
+
+        sprintf(student->result.feedback + strlen(student->result.feedback),
+                ",CASE=%d", student->failedCase);
+    }
+
+    //Report what the student's runs counted.
+    for (counter = 0; counter < COUNTER_COUNT; counter++) {
+
+        if (student->counters[counter] < 0) {
+            continue;
+        }
+
+        //The task clock counts nanoseconds.
+        sprintf(student->result.feedback + strlen(student->result.feedback),
+                ",%s=%lld", counterNames[counter],
+                counter == COUNTER_TASK_CLOCK ?
+                student->counters[counter] / 1000 : student->counters[counter]);
+    }
+
+    //Normalize the instructions so runs over different cases compare.
+    if (student->counters[COUNTER_INSTRUCTIONS] >= 0 && student->casesRun > 0) {
+
+        sprintf(student->result.feedback + strlen(student->result.feedback),
+                ",INSTRUCTIONS_PER_TEST=%lld",
+                student->counters[COUNTER_INSTRUCTIONS] / student->casesRun);
+    }
+}
+
+void FinishStudent(Student *student, int verdict, Stats *stats) {
+
+    //Variable declarations.
+    Student *member;
+    int     stage;
+    int     bucket;
+    long    millis;
+    double  change;
+
+    student->isFinished = 1;
+
+    //The duplicates share the verdict but keep their own depth penalty.
+    for (member = student; member != 0; member = member->nextDuplicate) {
+
+        member->mismatchLine   = student->mismatchLine;
+        member->mismatchColumn = student->mismatchColumn;
+        member->similarity     = student->similarity;
+        member->matchedReference = student->matchedReference;
+        member->failedCase       = student->failedCase;
+        member->casesRun         = student->casesRun;
+
+        //A duplicate ran nothing itself, it has what its group measured.
+        if (member != student) {
+
+            memcpy(member->counters, student->counters,
+                   sizeof(member->counters));
+            memcpy(member->stageTimes, student->stageTimes,
+                   sizeof(member->stageTimes));
+        }
+
+        ApplyVerdict(member, verdict);
+        WriteStudentResult(member);
+
+        //Count the student in the statistics, a result that could not be
+        //recorded counts as an INTERNAL_ERROR.
+        if (member->verdict > 0 && member->verdict < VERDICT_COUNT) {
+
+            stats->verdicts[member->verdict]++;
+        }
+
+        if (member != student) {
+
+            stats->duplicates++;
+        }
+
+        stats->written++;
+    }
+
+    //Only the graded student went through the stages.
+    for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+        if (student->stageTimes[stage] < 0) {
+            continue;
+        }
+
+        //Find the power of two bucket of the time in milliseconds.
+        millis = (long) (student->stageTimes[stage] / 1000);
+
+        for (bucket = 0; bucket < HISTOGRAM_BUCKETS - 1 && millis > 0;
+             bucket++) {
+
+            millis >>= 1;
+        }
+
+        stats->stageDone[stage]++;
+        stats->stageTotal[stage] += student->stageTimes[stage];
+        stats->stageSquares[stage] += student->stageTimes[stage] / 1000.0 *
+                                      (student->stageTimes[stage] / 1000.0);
+        stats->histograms[stage][bucket]++;
+    }
+
+    //The same program on the same input should take the same time again.
+    if (student->previousRunTime > 0 &&
+        student->stageTimes[STAGE_EXECUTE] >= 0 &&
+        student->stageTimes[STAGE_COMPARE] >= 0) {
+
+        change = (double) (student->stageTimes[STAGE_EXECUTE] +
+                           student->stageTimes[STAGE_COMPARE] -
+                           student->previousRunTime) /
+                 student->previousRunTime;
+
+        stats->runChanges++;
+        stats->runChangeTotal   += change;
+        stats->runChangeSquares += change * change;
+    }
+
+    WriteStats(stats, 0);
+}
+
+int HashSourceFile(Student *student) {
+
+    //Variable declarations.
+    unsigned char      buffer[HASH_BUFFER_SIZE];
+    unsigned long long hash = 14695981039346656037ULL;
+    int                sourceFile;
+    int                readNum;
+    int                index;
+    int                attempt  = 0;
+    int                isKept;
+    char               *source  = 0;
+    size_t             capacity = 0;
+
+    //The C file is read only here, kept whole if it gets fingerprinted.
+    isKept = student->options != 0 && student->options->isPlagiarism;
+
+    //A watched student that changed is unpacked again.
+    if (student->sourceFile >= 0) {
+
+        close(student->sourceFile);
+        student->sourceFile = -1;
+    }
+
+    do {
+
+        sourceFile = OpenSourceFile(student->cFilePath);
+    } while (sourceFile < 0 && ShouldRetry(&attempt));
+
+    //Check if the C file was opened.
+    if (sourceFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        return -1;
+    }
+
+    //Hash the file with 64 bit FNV-1a.
+    while ((readNum = read(sourceFile, buffer, HASH_BUFFER_SIZE)) > 0) {
+
+        for (index = 0; index < readNum; index++) {
+
+            hash ^= buffer[index];
+            hash *= 1099511628211ULL;
+        }
+
+        //A C file too big to be written by hand is not compared.
+        if (isKept && student->sourceSize + readNum > ARCHIVE_MAX_SOURCE) {
+
+            isKept = 0;
+
+        } else if (isKept) {
+
+            //Check if the copy needs room.
+            if ((size_t) student->sourceSize + readNum > capacity) {
+
+                capacity = capacity == 0 ? HASH_BUFFER_SIZE : capacity * 2;
+                source   = (char *) realloc(source, capacity);
+
+                //Check if allocation worked.
+                if (source == 0) {
+
+                    perror("Error: realloc failed.\n");
+                    exit(1);
+                }
+            }
+
+            memcpy(source + student->sourceSize, buffer, (size_t) readNum);
+        }
+
+        student->sourceSize += readNum;
+    }
+
+    //Check if read succeeded.
+    if (readNum < 0) {
+
+        perror("Error occurred while reading from file.\n");
+        close(sourceFile);
+        free(source);
+        return -1;
+    }
+
+    if (isKept) {
+
+        FingerprintSource(student, source, (size_t) student->sourceSize);
+    }
+
+    free(source);
+
+    //Keep an unpacked C file for the stages that read it again.
+    if (ArchivePathLength(student->cFilePath) > 0) {
+
+        student->sourceFile = sourceFile;
+
+    } else if (close(sourceFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+    }
+
+    student->sourceHash = hash;
+
+    return 0;
+}
+
+int CompareSources(const void *first, const void *second) {
+
+    //Variable declarations.
+    Student *student1 = *(Student *const *) first;
+    Student *student2 = *(Student *const *) second;
+
+    if (student1->sourceHash != student2->sourceHash) {
+
+        return student1->sourceHash < student2->sourceHash ? -1 : 1;
+    }
+
+    if (student1->sourceSize != student2->sourceSize) {
+
+        return student1->sourceSize < student2->sourceSize ? -1 : 1;
+    }
+
+    return student1->index - student2->index;
+}
+
+int IsSourceEqual(Student *student1, Student *student2) {
+
+    //Variable declarations.
+    int file1;
+    int file2;
+    int isEqual;
+
+    file1   = OpenStudentSource(student1);
+    file2   = OpenStudentSource(student2);
+    isEqual = IsContentEqual(file1, file2);
+
+    if (file1 >= 0) {
+
+        close(file1);
+    }
+
+    if (file2 >= 0) {
+
+        close(file2);
+    }
+
+    return isEqual;
+}
+
+int IsContentEqual(int file1, int file2) {
+
+    //Variable declarations.
+    unsigned char buffer1[HASH_BUFFER_SIZE];
+    unsigned char buffer2[HASH_BUFFER_SIZE];
+    ssize_t       readNum1;
+    ssize_t       readNum2;
+
+    //Check if the files were opened.
+    if (file1 < 0 || file2 < 0) {
+
+        return 0;
+    }
+
+    do {
+
+        readNum1 = read(file1, buffer1, HASH_BUFFER_SIZE);
+        readNum2 = read(file2, buffer2, HASH_BUFFER_SIZE);
+
+        //Check if the blocks differ.
+        if (readNum1 < 0 || readNum1 != readNum2 ||
+            memcmp(buffer1, buffer2, (size_t) readNum1) != 0) {
+
+            return 0;
+        }
+    } while (readNum1 == HASH_BUFFER_SIZE);
+
+    return 1;
+}
+
+void FingerprintSource(Student *student, char *source, size_t size) {
+
+    //Variable declarations.
+    unsigned int *tokens;
+    unsigned int *prints;
+    unsigned int hash;
+    int          tokenCount;
+    int          hashCount;
+    int          printCount = 0;
+    int          distinct   = 0;
+    int          index;
+    int          start;
+    int          smallest;
+    int          chosen     = -1;
+
+    tokens = (unsigned int *) malloc((size + 1) * sizeof(unsigned int));
+
+    //Check if allocation worked.
+    if (tokens == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    tokenCount = TokenizeSource(source, size, tokens);
+    hashCount  = tokenCount - PLAGIARISM_KGRAM + 1;
+
+    //Check if the file is too short to share anything worth reporting.
+    if (hashCount < PLAGIARISM_WINDOW) {
+
+        free(tokens);
+        return;
+    }
+
+    //Every k-gram's hash takes the place of its first token, which no
+    //later k-gram needs.
+    for (index = 0; index < hashCount; index++) {
+
+        hash = 2166136261U;
+
+        for (start = index; start < index + PLAGIARISM_KGRAM; start++) {
+
+            hash ^= tokens[start];
+            hash *= 16777619U;
+        }
+
+        tokens[index] = hash;
+    }
+
+    prints = (unsigned int *) malloc(hashCount * sizeof(unsigned int));
+
+    //Check if allocation worked.
+    if (prints == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Keep the smallest hash of every window, the rightmost one on a tie,
+    //once for as long as it stays the smallest.
+    for (start = 0; start + PLAGIARISM_WINDOW <= hashCount; start++) {
+
+        smallest = start;
+
+        for (index = start + 1; index < start + PLAGIARISM_WINDOW; index++) {
+
+            if (tokens[index] <= tokens[smallest]) {
+
+                smallest = index;
+            }
+        }
+
+        if (smallest != chosen) {
+
+            prints[printCount++] = tokens[smallest];
+            chosen               = smallest;
+        }
+    }
+
+    //A fingerprint counts once however often the file has it.
+    qsort(prints, (size_t) printCount, sizeof(unsigned int), ComparePrints);
+
+    for (index = 0; index < printCount; index++) {
+
+        if (distinct == 0 || prints[index] != prints[distinct - 1]) {
+
+            prints[distinct++] = prints[index];
+        }
+    }
+
+    free(tokens);
+
+    student->fingerprints     = prints;
+    student->fingerprintCount = distinct;
+}
+
+int TokenizeSource(char *source, size_t size, unsigned int *tokens) {
+
+    //Variable declarations.
+    size_t       position    = 0;
+    size_t       start;
+    int          count       = 0;
+    int          isLineStart = 1;
+    unsigned int hash;
+    char         quote;
+
+    while (position < size) {
+
+        //Skip spaces, a new line may start a preprocessor line.
+        if (isspace((unsigned char) source[position])) {
+
+            if (source[position] == '\n') {
+
+                isLineStart = 1;
+            }
+
+            position++;
+            continue;
+        }
+
+        //Skip preprocessor lines, every file has the same includes.
+        if (isLineStart && source[position] == '#') {
+
+            while (position < size && source[position] != '\n') {
+
+                //A backslash carries the line on.
+                if (source[position] == '\\') {
+
+                    position++;
+                }
+
+                position++;
+            }
+
+            continue;
+        }
+
+        isLineStart = 0;
+
+        //Skip comments.
+        if (source[position] == '/' && position + 1 < size &&
+            source[position + 1] == '/') {
+
+            while (position < size && source[position] != '\n') {
+
+                position++;
+            }
+
+            continue;
+        }
+
+        if (source[position] == '/' && position + 1 < size &&
+            source[position + 1] == '*') {
+
+            position += 2;
+
+            while (position + 1 < size && (source[position] != '*' ||
+                                           source[position + 1] != '/')) {
+
+                position++;
+            }
+
+            position += 2;
+            continue;
+        }
+
+        start = position;
+
+        //Names are all alike, keywords keep their spelling.
+        if (isalpha((unsigned char) source[position]) ||
+            source[position] == '_') {
+
+            while (position < size &&
+                   (isalnum((unsigned char) source[position]) ||
+                    source[position] == '_')) {
+
+                position++;
+            }
+
+            if (!IsCKeyword(source + start, position - start)) {
+
+                tokens[count++] = TOKEN_NAME;
+                continue;
+            }
+
+            hash = 2166136261U;
+
+            for (; start < position; start++) {
+
+                hash ^= (unsigned char) source[start];
+                hash *= 16777619U;
+            }
+
+            tokens[count++] = hash;
+            continue;
+        }
+
+        //Numbers, with their suffixes and exponents.
+        if (isdigit((unsigned char) source[position]) ||
+            (source[position] == '.' && position + 1 < size &&
+             isdigit((unsigned char) source[position + 1]))) {
+
+            while (position < size &&
+                   (isalnum((unsigned char) source[position]) ||
+                    source[position] == '.' || source[position] == '_' ||
+                    ((source[position] == '+' || source[position] == '-') &&
+                     strchr("eEpP", source[position - 1]) != 0))) {
+
+                position++;
+            }
+
+            tokens[count++] = TOKEN_NUMBER;
+            continue;
+        }
+
+        //String and character literals, with their escapes.
+        if (source[position] == '"' || source[position] == '\'') {
+
+            quote = source[position++];
+
+            while (position < size && source[position] != quote &&
+                   source[position] != '\n') {
+
+                if (source[position] == '\\') {
+
+                    position++;
+                }
+
+                position++;
+            }
+
+            position++;
+            tokens[count++] = quote == '"' ? TOKEN_STRING : TOKEN_CHAR;
+            continue;
+        }
+
+        //Every other character is a token of its own.
+        tokens[count++] = (unsigned char) source[position++];
+    }
+
+    return count;
+}
+
+int IsCKeyword(char *word, size_t length) {
+
+    //Variable declarations.
+    static char *keywords[] = {"auto", "break", "case", "char", "const",
+                               "continue", "default", "do", "double", "else",
+                               "enum", "extern", "float", "for", "goto", "if",
+                               "int", "long", "register", "return", "short",
+                               "signed", "sizeof", "static", "struct",
+                               "switch", "typedef", "union", "unsigned",
+                               "void", "volatile", "while", 0};
+    int         index;
+
+    for (index = 0; keywords[index] != 0; index++) {
+
+        if (strlen(keywords[index]) == length &&
+            strncmp(keywords[index], word, length) == 0) {
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int ComparePrints(const void *first, const void *second) {
+
+    //Variable declarations.
+    unsigned int print1 = *(const unsigned int *) first;
+    unsigned int print2 = *(const unsigned int *) second;
+
+    return print1 < print2 ? -1 : print1 > print2;
+}
+
+void SortPrintEntries(PrintEntry *entries, int count) {
+
+    //Variable declarations.
+    int        counts[256];
+    int        shift;
+    int        index;
+    int        total;
+    int        bucket;
+    PrintEntry *sorted;
+    PrintEntry *swap;
+
+    sorted = (PrintEntry *) malloc((count + 1) * sizeof(PrintEntry));
+
+    //Check if allocation worked.
+    if (sorted == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Every pass keeps the order of the last, the lowest byte goes first.
+    for (shift = 0; shift < 32; shift += 8) {
+
+        memset(counts, 0, sizeof(counts));
+
+        for (index = 0; index < count; index++) {
+
+            counts[(entries[index].print >> shift) & 0xff]++;
+        }
+
+        for (bucket = 0, total = 0; bucket < 256; bucket++) {
+
+            index          = counts[bucket];
+            counts[bucket] = total;
+            total         += index;
+        }
+
+        for (index = 0; index < count; index++) {
+
+            sorted[counts[(entries[index].print >> shift) & 0xff]++] =
+                    entries[index];
+        }
+
+        swap    = entries;
+        entries = sorted;
+        sorted  = swap;
+    }
+
+    //An even amount of passes leaves the result in the caller's array.
+    free(sorted);
+}
+
+void DetectPlagiarism(StudentList *students, Options *options) {
+
+    //Variable declarations.
+    char           line[LINE_SIZE];
+    int            reportFile;
+    int            index;
+    int            print;
+    int            end;
+    int            threadCount;
+    int            pairCount = 0;
+    int            commonCount;
+    int            isCommon;
+    int            starterCount = 0;
+    unsigned int   *starterPrints = 0;
+    pthread_t      threads[MAX_PLAGIARISM_THREADS];
+    SimilarityTask tasks[MAX_PLAGIARISM_THREADS];
+    SimilarityJob  job;
+    SimilarPair    *pairs;
+    Student        *student;
+
+    job.students   = students;
+    job.threshold  = options->plagiarismThreshold;
+    job.entryCount = 0;
+    job.offsets    = (int *) malloc((students->count + 1) * sizeof(int));
+    job.rareCounts = (int *) calloc(students->count + 1, sizeof(int));
+
+    //Check if allocation worked.
+    if (job.offsets == 0 || job.rareCounts == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    for (index = 0; index < students->count; index++) {
+
+        job.offsets[index] = job.entryCount;
+        job.entryCount    += students->items[index]->fingerprintCount;
+    }
+
+    job.entries  = (PrintEntry *) malloc((job.entryCount + 1) *
+                                         sizeof(PrintEntry));
+    job.postings = (int *) malloc((job.entryCount + 1) * sizeof(int));
+
+    //Check if allocation worked.
+    if (job.entries == 0 || job.postings == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //The inverted index lists every C file a fingerprint is found in.
+    for (index = 0; index < students->count; index++) {
+
+        student = students->items[index];
+
+        for (print = 0; print < student->fingerprintCount; print++) {
+
+            job.entries[job.offsets[index] + print].print    =
+                    student->fingerprints[print];
+            job.entries[job.offsets[index] + print].source   = index;
+            job.entries[job.offsets[index] + print].position =
+                    job.offsets[index] + print;
+        }
+    }
+
+    SortPrintEntries(job.entries, job.entryCount);
+
+    //A solution leaked to many students must stay, so what counts as
+    //common grows with the assignment, and never goes below a few files.
+    commonCount = (int) ((long long) students->count *
+                         options->plagiarismCommon / 100);
+
+    if (commonCount < PLAGIARISM_MIN_COMMON) {
+
+        commonCount = PLAGIARISM_MIN_COMMON;
+    }
+
+    if (options->plagiarismStarter != 0) {
+
+        starterPrints = LoadStarterPrints(options->plagiarismStarter,
+                                          &starterCount);
+    }
+
+    //Point every fingerprint at its C files once, so scoring never
+    //searches. Code of the starter file or of most C files came with the
+    //assignment.
+    for (index = 0; index < job.entryCount; index = end) {
+
+        for (end = index + 1; end < job.entryCount &&
+                              job.entries[end].print ==
+                              job.entries[index].print; end++) {
+        }
+
+        isCommon = end - index > commonCount ||
+                   (starterCount > 0 &&
+                    bsearch(&job.entries[index].print, starterPrints,
+                            (size_t) starterCount, sizeof(unsigned int),
+                            ComparePrints) != 0);
+
+        for (print = index; print < end; print++) {
+
+            if (isCommon) {
+
+                job.postings[job.entries[print].position] = -1;
+
+            } else {
+
+                job.postings[job.entries[print].position] = index;
+                job.rareCounts[job.entries[print].source]++;
+            }
+        }
+    }
+
+    //The workers are done, every processor can score.
+    threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (threadCount > MAX_PLAGIARISM_THREADS) {
+
+        threadCount = MAX_PLAGIARISM_THREADS;
+    }
+
+    if (threadCount > students->count) {
+
+        threadCount = students->count;
+    }
+
+    if (threadCount < 1) {
+
+        threadCount = 1;
+    }
+
+    job.threadCount = threadCount;
+
+    for (index = 0; index < threadCount; index++) {
+
+        tasks[index].job          = &job;
+        tasks[index].thread       = index;
+        tasks[index].pairs        = 0;
+        tasks[index].pairCount    = 0;
+        tasks[index].pairCapacity = 0;
+
+        //Check if the thread was started.
+        if (pthread_create(&threads[index], 0, ScoreSources,
+                           &tasks[index]) != 0) {
+
+            perror("Error: pthread_create failed.\n");
+            exit(1);
+        }
+    }
+
+    for (index = 0; index < threadCount; index++) {
+
+        pthread_join(threads[index], 0);
+        pairCount += tasks[index].pairCount;
+    }
+
+    pairs = (SimilarPair *) malloc((pairCount + 1) * sizeof(SimilarPair));
+
+    //Check if allocation worked.
+    if (pairs == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    pairCount = 0;
+
+    for (index = 0; index < threadCount; index++) {
+
+        memcpy(pairs + pairCount, tasks[index].pairs,
+               tasks[index].pairCount * sizeof(SimilarPair));
+        pairCount += tasks[index].pairCount;
+        free(tasks[index].pairs);
+    }
+
+    qsort(pairs, (size_t) pairCount, sizeof(SimilarPair),
+          CompareSimilarPairs);
+
+    reportFile = open(options->plagiarismPath, O_CREAT | O_TRUNC | O_WRONLY,
+                      0644);
+
+    //Check if the report was opened.
+    if (reportFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    for (index = 0; index < pairCount; index++) {
+
+        snprintf(line, LINE_SIZE, "%s,%s,%d,%d\n", pairs[index].first->name,
+                 pairs[index].second->name, pairs[index].percent,
+                 pairs[index].shared);
+
+        //Check if the pair was written, the grading does not depend on it.
+        if (WriteToFile(reportFile, line) < 0) {
+
+            fprintf(stderr, "Warning: %s is incomplete.\n",
+                    options->plagiarismPath);
+            break;
+        }
+    }
+
+    //Check if the report was closed.
+    if (close(reportFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    free(pairs);
+    free(job.entries);
+    free(job.postings);
+    free(job.offsets);
+    free(job.rareCounts);
+    free(starterPrints);
+}
+
+unsigned int *LoadStarterPrints(char *path, int *count) {
+
+    //Variable declarations.
+    char         *source;
+    size_t       size;
+    unsigned int *prints;
+    Student      *starter;
+
+    source  = ReadWholeFile(path, &size);
+    starter = InitStudent("", "");
+
+    FingerprintSource(starter, source, size);
+
+    prints                = starter->fingerprints;
+    *count                = starter->fingerprintCount;
+    starter->fingerprints = 0;
+
+    FreeStudent(starter);
+    free(source);
+
+    return prints;
+}
+
+void *ScoreSources(void *task) {
+
+    //Variable declarations.
+    SimilarityTask *work     = (SimilarityTask *) task;
+    SimilarityJob  *job      = work->job;
+    StudentList    *students = job->students;
+    int            *shared;
+    int            *touched;
+    int            touchedCount;
+    int            source;
+    int            other;
+    int            print;
+    int            index;
+    int            entry;
+    int            smaller;
+    int            percent;
+    Student        *student;
+    SimilarPair    *pair;
+
+    shared  = (int *) calloc(students->count, sizeof(int));
+    touched = (int *) malloc(students->count * sizeof(int));
+
+    //Check if allocation worked.
+    if (shared == 0 || touched == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    for (source = work->thread; source < students->count;
+         source += job->threadCount) {
+
+        student      = students->items[source];
+        touchedCount = 0;
+
+        for (print = 0; print < student->fingerprintCount; print++) {
+
+            entry = job->postings[job->offsets[source] + print];
+
+            //Check if the fingerprint is too common to mean anything.
+            if (entry < 0) {
+                continue;
+            }
+
+            //Count it for every later C file that has it too, each pair is
+            //scored by its first student only.
+            for (index = entry; index < job->entryCount &&
+                                job->entries[index].print ==
+                                job->entries[entry].print; index++) {
+
+                other = job->entries[index].source;
+
+                if (other > source && shared[other]++ == 0) {
+
+                    touched[touchedCount++] = other;
+                }
+            }
+        }
+
+        for (index = 0; index < touchedCount; index++) {
+
+            other   = touched[index];
+            smaller = job->rareCounts[other] < job->rareCounts[source] ?
+                      job->rareCounts[other] : job->rareCounts[source];
+            percent = (int) (shared[other] * 100LL / smaller);
+
+            //Check if the pair shares enough to be reported.
+            if (shared[other] >= PLAGIARISM_MIN_SHARED &&
+                percent >= job->threshold) {
+
+                //Check if the pairs need room.
+                if (work->pairCount == work->pairCapacity) {
+
+                    work->pairCapacity = work->pairCapacity == 0 ? 64 :
+                                         work->pairCapacity * 2;
+                    work->pairs = (SimilarPair *)
+                            realloc(work->pairs, work->pairCapacity *
+                                                 sizeof(SimilarPair));
+
+                    //Check if allocation worked.
+                    if (work->pairs == 0) {
+
+                        perror("Error: realloc failed.\n");
+                        exit(1);
+                    }
+                }
+
+                pair = &work->pairs[work->pairCount++];
+
+                //Name the pair in the order of the names.
+                if (strcmp(student->name, students->items[other]->name) < 0) {
+
+                    pair->first  = student;
+                    pair->second = students->items[other];
+
+                } else {
+
+                    pair->first  = students->items[other];
+                    pair->second = student;
+                }
+
+                pair->shared  = shared[other];
+                pair->percent = percent;
+            }
+
+            shared[other] = 0;
+        }
+    }
+
+    free(shared);
+    free(touched);
+
+    return 0;
+}
+
+int CompareSimilarPairs(const void *first, const void *second) {
+
+    //Variable declarations.
+    const SimilarPair *pair1 = (const SimilarPair *) first;
+    const SimilarPair *pair2 = (const SimilarPair *) second;
+    int               order;
+
+    if (pair1->percent != pair2->percent) {
+
+        return pair2->percent - pair1->percent;
+    }
+
+    if (pair1->shared != pair2->shared) {
+
+        return pair2->shared - pair1->shared;
+    }
+
+    order = strcmp(pair1->first->name, pair2->first->name);
+
+    return order != 0 ? order : strcmp(pair1->second->name,
+                                       pair2->second->name);
+}
+
+void GroupDuplicates(StudentList *students, StudentList *representatives,
+                     char *path) {
+
+    //Variable declarations.
+    int     groupsFile;
+    int     isFailed = 0;
+    int     start;
+    int     end;
+    int     leader;
+    int     index;
+    int     size;
+    char    line[MAX_SIZE];
+    Student *last;
+    Student **sorted;
+
+    groupsFile = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if groups file was opened.
+    if (groupsFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    sorted = (Student **) malloc((students->count + 1) * sizeof(Student *));
+
+    //Check if allocation worked.
+    if (sorted == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    memcpy(sorted, students->items, students->count * sizeof(Student *));
+    qsort(sorted, (size_t) students->count, sizeof(Student *),
+          CompareSources);
+
+    for (start = 0; start < students->count; start = end) {
+
+        //Find the run of students with the same hash and size.
+        for (end = start + 1;
+             end < students->count &&
+             sorted[start]->sourceHash == sorted[end]->sourceHash &&
+             sorted[start]->sourceSize == sorted[end]->sourceSize; end++) {
+        }
+
+        //The hash may collide, so the run splits into groups of equal bytes,
+        //every group led by its first student.
+        for (leader = start; leader < end; leader++) {
+
+            if (sorted[leader]->isDuplicate) {
+                continue;
+            }
+
+            last = sorted[leader];
+            size = 1;
+
+            for (index = leader + 1; index < end; index++) {
+
+                //Check if the C file is a copy of the leader's.
+                if (sorted[index]->isDuplicate ||
+                    !IsSourceEqual(sorted[leader], sorted[index])) {
+                    continue;
+                }
+
+                last->nextDuplicate        = sorted[index];
+                sorted[index]->isDuplicate = 1;
+                last                       = sorted[index];
+                size++;
+            }
+
+            //Check if the leader's hash collided with a different C file.
+            if (size < end - start && leader == start) {
+
+                fprintf(stderr, "Warning: %s shares its C file's hash with a "
+                                "different C file.\n", sorted[leader]->name);
+            }
+
+            //Report groups of more than one student.
+            if (size > 1) {
+
+                sprintf(line, "%d", size);
+                isFailed |= WriteToFile(groupsFile, line);
+
+                for (last = sorted[leader]; last != 0;
+                     last = last->nextDuplicate) {
+
+                    isFailed |= WriteToFile(groupsFile, ",");
+                    isFailed |= WriteToFile(groupsFile, last->name);
+                }
+
+                isFailed |= WriteToFile(groupsFile, "\n");
+            }
+        }
+    }
+
+    //Keep the discovery order among the students that will be graded.
+    for (index = 0; index < students->count; index++) {
+
+        if (!students->items[index]->isDuplicate) {
+
+            AddStudent(representatives, students->items[index]);
+        }
+    }
+
+    free(sorted);
+
+    //The grading does not depend on the groups file.
+    if (isFailed) {
+
+        fprintf(stderr, "Warning: %s is incomplete.\n", path);
+    }
+
+    //Check if groups file was closed.
+    if (close(groupsFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+}
+
+long long NowMicros(void) {
+
+    //Variable declarations.
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+void WriteStats(Stats *stats, int isForced) {
+
+    //Variable declarations.
+    static char *stageNames[STAGE_COUNT]     = {"compile", "execute",
+                                                "compare"};
+    static char *verdictNames[VERDICT_COUNT] = {"", "GREAT_JOB",
+                                                "SIMILLAR_OUTPUT",
+                                                "BAD_OUTPUT",
+                                                "COMPILATION_ERROR",
+                                                "TIMEOUT", "OUTPUT_LIMIT",
+                                                "INTERNAL_ERROR"};
+    char        tempPath[LINE_SIZE];
+    char        line[LINE_SIZE];
+    int         statsFile;
+    int         isFailed = 0;
+    int         index;
+    int         bucket;
+    int         remaining;
+    double      elapsed;
+    double      throughput;
+    double      mean;
+    long long   now;
+
+    //Check if statistics were asked for.
+    if (stats->path == 0) {
+
+        return;
+    }
+
+    now = NowMicros();
+
+    //Check if the file was written recently.
+    if (!isForced && now - stats->lastWrite < STATS_INTERVAL) {
+
+        return;
+    }
+
+    stats->lastWrite = now;
+    elapsed          = (now - stats->startTime) / 1000000.0;
+    throughput       = elapsed > 0 ? stats->written / elapsed : 0;
+    remaining        = stats->discovered - stats->written;
+
+    sprintf(tempPath, "%s.tmp", stats->path);
+    statsFile = open(tempPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the statistics file was opened, else try on the next round.
+    if (statsFile < 0) {
+
+        perror("Error: failed to open file.\n");
+
+        return;
+    }
+
+    //Progress.
+    sprintf(line, "elapsed_seconds %.1f\n"
+                  "discovery_done %d\n"
+                  "students_discovered %d\n"
+                  "students_skipped_by_journal %d\n"
+                  "students_with_c_file %d\n"
+                  "students_written %d\n"
+                  "students_remaining %d\n"
+                  "students_per_second %.2f\n",
+            elapsed, stats->isDiscoveryDone, stats->discovered,
+            stats->skipped, stats->located, stats->written, remaining,
+            throughput);
+    isFailed |= WriteToFile(statsFile, line);
+
+    //The estimate is only known once every student was found.
+    if (stats->isDiscoveryDone && throughput > 0) {
+
+        sprintf(line, "eta_seconds %.0f\n", remaining / throughput);
+        isFailed |= WriteToFile(statsFile, line);
+    }
+
+    sprintf(line, "duplicates_fanned_out %d\n"
+                  "verdict_NO_C_FILE %d\n"
+                  "verdict_MULTIPLE_DIRECTORIES %d\n"
+                  "precheck_compilation_errors %d\n"
+                  "students_regraded %d\n",
+            stats->duplicates, stats->noCFile, stats->multipleDirectories,
+            stats->prechecked, stats->regraded);
+    isFailed |= WriteToFile(statsFile, line);
+
+    for (index = 1; index < VERDICT_COUNT; index++) {
+
+        sprintf(line, "verdict_%s %d\n", verdictNames[index],
+                stats->verdicts[index]);
+        isFailed |= WriteToFile(statsFile, line);
+    }
+
+    //Stages and their latency histograms.
+    for (index = 0; index < STAGE_COUNT; index++) {
+
+        mean = stats->stageDone[index] > 0 ?
+               stats->stageTotal[index] / 1000.0 / stats->stageDone[index] : 0;
+
+        sprintf(line, "stage_%s_done %d\n"
+                      "stage_%s_mean_ms %.1f\n"
+                      "stage_%s_stddev_ms %.1f\n"
+                      "stage_%s_latency_ms",
+                stageNames[index], stats->stageDone[index],
+                stageNames[index], mean, stageNames[index],
+                stats->stageDone[index] > 0 ?
+                sqrt(fmax(stats->stageSquares[index] /
+                          stats->stageDone[index] - mean * mean, 0)) : 0,
+                stageNames[index]);
+        isFailed |= WriteToFile(statsFile, line);
+
+        for (bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+
+            sprintf(line, " <%d:%d", 1 << bucket,
+                    stats->histograms[index][bucket]);
+            isFailed |= WriteToFile(statsFile, line);
+        }
+
+        isFailed |= WriteToFile(statsFile, "\n");
+    }
+
+    //How much the run times moved since the previous run.
+    mean = stats->runChanges > 0 ?
+           stats->runChangeTotal / stats->runChanges : 0;
+
+    sprintf(line, "run_time_compared %d\n"
+                  "run_time_change_mean_pct %.1f\n"
+                  "run_time_change_stddev_pct %.1f\n",
+            stats->runChanges, mean * 100,
+            stats->runChanges > 0 ?
+            sqrt(fmax(stats->runChangeSquares / stats->runChanges -
+                      mean * mean, 0)) * 100 : 0);
+    isFailed |= WriteToFile(statsFile, line);
+
+    //Queues and workers.
+    sprintf(line, "queue_pending %d\n", stats->pending);
+    isFailed |= WriteToFile(statsFile, line);
+
+    for (index = 0; index < stats->workerCount; index++) {
+
+        sprintf(line, "worker_%d_outstanding %d\n"
+                      "worker_%d_utilization %.2f\n",
+                index, stats->workerOutstanding[index], index,
+                elapsed > 0 ? stats->workerBusy[index] / 1000000.0 / elapsed :
+                0);
+        isFailed |= WriteToFile(statsFile, line);
+    }
+
+    //Check if the statistics were written and closed, else keep the old ones.
+    if (close(statsFile) < 0 || isFailed) {
+
+        fprintf(stderr, "Warning: failed to write %s.\n", stats->path);
+        unlink(tempPath);
+
+        return;
+    }
+
+    //Replace the old statistics at once.
+    if (rename(tempPath, stats->path) < 0) {
+
+        perror("Error: failed to rename file.\n");
+    }
+}
+
+int ReadCompareReport(Student *student) {
+
+    //Variable declarations.
+    char      report[LINE_SIZE];
+    int       reportFile;
+    int       readNum;
+    long long offset;
+    long      distance;
+
+    reportFile = open(student->reportFilePath, O_RDONLY);
+
+    //Check if the comparator wrote a report.
+    if (reportFile < 0) {
+
+        return 0;
+    }
+
+    readNum = read(reportFile, report, LINE_SIZE - 1);
+
+    //Check if read succeeded.
+    if (readNum < 0) {
+
+        perror("Error occurred while reading from file.\n");
+        close(reportFile);
+        return -1;
+    }
+
+    report[readNum] = '\0';
+
+    //Check if the file was closed.
+    if (close(reportFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+    }
+
+    //Keep the position only if the outputs differ.
+    if (sscanf(report, "offset %lld line %ld column %ld distance %ld "
+                       "similarity %lf reference %d", &offset,
+               &student->mismatchLine, &student->mismatchColumn, &distance,
+               &student->similarity, &student->matchedReference) != 6 ||
+        offset < 0) {
+
+        student->mismatchLine   = 0;
+        student->mismatchColumn = 0;
+    }
+
+    //Check if the report was unlinked.
+    if (unlink(student->reportFilePath) < 0) {
+
+        perror("Error: failed to unlink file.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+char *ReadWholeFile(char *path, size_t *size) {
+
+    //Variable declarations.
+    int         file;
+    ssize_t     readNum;
+    size_t      offset = 0;
+    char        *content;
+    struct stat fileStat;
+
+    file = open(path, O_RDONLY);
+
+    //Check if the file was opened.
+    if (file < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    //Check the file's size.
+    if (fstat(file, &fileStat) < 0) {
+
+        perror("Error: failed to stat file.\n");
+        exit(1);
+    }
+
+    content = (char *) malloc((size_t) fileStat.st_size + 1);
+
+    //Check if allocation worked.
+    if (content == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    while (offset < (size_t) fileStat.st_size) {
+
+        readNum = read(file, content + offset,
+                       (size_t) fileStat.st_size - offset);
+
+        //Check if read succeeded.
+        if (readNum < 0) {
+
+            perror("Error occurred while reading from file.\n");
+            exit(1);
+        }
+
+        //Check if the file got shorter.
+        if (readNum == 0) {
+            break;
+        }
+
+        offset += (size_t) readNum;
+    }
+
+    content[offset] = '\0';
+    *size = offset;
+
+    //Check if the file was closed.
+    if (close(file) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    return content;
+}
+
+void LoadTestCases(Options *options) {
+
+    //Variable declarations.
+    char     *list;
+    char     *line;
+    char     *next;
+    char     *word;
+    char     *place;
+    size_t   size;
+    int      capacity = 0;
+    int      index;
+    TestCase *testCase;
+
+    //Check if there is only the configuration's case.
+    if (options->testsPath == 0) {
+
+        options->testCases = (TestCase *) calloc(1, sizeof(TestCase));
+
+        //Check if allocation worked.
+        if (options->testCases == 0) {
+
+            perror("Error: malloc failed.\n");
+            exit(1);
+        }
+
+        options->testCases[0].inputPath   = options->inputPath;
+        options->testCases[0].outputCount = options->outputCount;
+
+        memcpy(options->testCases[0].outputPaths, options->outputPaths,
+               sizeof(options->outputPaths));
+
+        options->testCaseCount = 1;
+
+    } else {
+
+        //The list stays in memory, the cases point into it.
+        list = ReadWholeFile(options->testsPath, &size);
+
+        for (line = list; line != 0 && *line != '\0'; line = next) {
+
+            next = strchr(line, '\n');
+
+            if (next != 0) {
+
+                *next++ = '\0';
+            }
+
+            word = strtok_r(line, " \t\r", &place);
+
+            //Skip empty lines.
+            if (word == 0) {
+                continue;
+            }
+
+            //Make room for another case.
+            if (options->testCaseCount == capacity) {
+
+                capacity = capacity == 0 ? 16 : capacity * 2;
+                options->testCases = (TestCase *) realloc(
+                        options->testCases, capacity * sizeof(TestCase));
+
+                //Check if allocation worked.
+                if (options->testCases == 0) {
+
+                    perror("Error: realloc failed.\n");
+                    exit(1);
+                }
+            }
+
+            testCase = &options->testCases[options->testCaseCount++];
+            testCase->inputPath   = word;
+            testCase->outputCount = 0;
+
+            while ((word = strtok_r(0, " \t\r", &place)) != 0 &&
+                   testCase->outputCount < MAX_REFERENCES) {
+
+                testCase->outputPaths[testCase->outputCount++] = word;
+            }
+
+            testCase->outputPaths[testCase->outputCount] = 0;
+
+            //Check that the case has a correct output.
+            if (testCase->outputCount == 0) {
+
+                fprintf(stderr, "Error: test case %s has no output.\n",
+                        testCase->inputPath);
+                exit(1);
+            }
+        }
+
+        //Check that there is a case.
+        if (options->testCaseCount == 0) {
+
+            fprintf(stderr, "Error: no test cases in %s.\n",
+                    options->testsPath);
+            exit(1);
+        }
+    }
+
+    for (index = 0; index < options->testCaseCount; index++) {
+
+        options->testCases[index].inputFile =
+                LoadSealedInput(options->testCases[index].inputPath);
+    }
+}
+
+int LoadSealedInput(char *path) {
+
+    //Variable declarations.
+    char    *data;
+    char    procPath[MAX_SIZE];
+    int     inputFile;
+    int     checkFile;
+    size_t  size;
+    size_t  written = 0;
+    ssize_t writeNum;
+
+    data      = ReadWholeFile(path, &size);
+    inputFile = memfd_create("input", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    //Check if the memory file was created.
+    if (inputFile < 0) {
+
+        perror("Error: memfd_create failed.\n");
+        exit(1);
+    }
+
+    while (written < size) {
+
+        writeNum = write(inputFile, data + written, size - written);
+
+        //Check if write succeeded.
+        if (writeNum < 0) {
+
+            perror("Error: failed to write to file.\n");
+            exit(1);
+        }
+
+        written += (size_t) writeNum;
+    }
+
+    free(data);
+
+    //Check that the input can no longer change.
+    if (fcntl(inputFile, F_ADD_SEALS, F_SEAL_WRITE | F_SEAL_SHRINK |
+                                      F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+
+        perror("Error: failed to seal the input.\n");
+        exit(1);
+    }
+
+    //Check that the students will be able to reopen it.
+    sprintf(procPath, "/proc/self/fd/%d", inputFile);
+    checkFile = open(procPath, O_RDONLY | O_CLOEXEC);
+
+    if (checkFile < 0) {
+
+        perror("Error: failed to reopen the input, is /proc mounted?\n");
+        exit(1);
+    }
+
+    close(checkFile);
+
+    return inputFile;
+}
+
+int VerdictRank(int verdict) {
+
+    switch (verdict) {
+
+        case VERDICT_GREAT_JOB:
+            return 0;
+
+        case VERDICT_SIMILAR_OUTPUT:
+            return 1;
+
+        case VERDICT_BAD_OUTPUT:
+            return 2;
+
+        case VERDICT_OUTPUT_LIMIT:
+            return 3;
+
+        case VERDICT_TIMEOUT:
+            return 4;
+
+        default:
+            return 5;
+    }
+}
+
+void LoadHistory(History *history, char *path) {
+
+    //Variable declarations.
+    char         *line;
+    char         *next;
+    char         *comma;
+    size_t       size;
+    int          capacity = 0;
+    HistoryEntry *entry;
+
+    //Check if a previous run left a history.
+    if (access(path, F_OK) < 0) {
+
+        //Check if the history is missing rather than unreadable.
+        if (errno != ENOENT) {
+
+            perror("Error: failed to access history.\n");
+            exit(1);
+        }
+
+        return;
+    }
+
+    history->content = ReadWholeFile(path, &size);
+
+    for (line = history->content; line != 0 && *line != '\0'; line = next) {
+
+        next = strchr(line, '\n');
+
+        //Skip a torn last line.
+        if (next == 0) {
+            break;
+        }
+
+        *next++ = '\0';
+        comma   = strchr(line, ',');
+
+        //Skip lines that are not entries.
+        if (comma == 0) {
+            continue;
+        }
+
+        //Make room for another entry.
+        if (history->count == capacity) {
+
+            capacity = capacity == 0 ? 64 : capacity * 2;
+            history->entries = (HistoryEntry *) realloc(
+                    history->entries, capacity * sizeof(HistoryEntry));
+
+            //Check if allocation worked.
+            if (history->entries == 0) {
+
+                perror("Error: realloc failed.\n");
+                exit(1);
+            }
+        }
+
+        entry   = &history->entries[history->count];
+        *comma  = '\0';
+
+        //Check that the entry is complete.
+        if (sscanf(comma + 1, "%lld,%lld,%lld", &entry->sourceSize,
+                   &entry->compileTime, &entry->runTime) != 3) {
+            continue;
+        }
+
+        entry->name   = line;
+        entry->isUsed = 0;
+        history->count++;
+    }
+
+    qsort(history->entries, (size_t) history->count, sizeof(HistoryEntry),
+          CompareHistoryEntries);
+}
+
+int CompareHistoryEntries(const void *first, const void *second) {
+
+    return strcmp(((HistoryEntry *) first)->name,
+                  ((HistoryEntry *) second)->name);
+}
+
+void ScheduleStudents(StudentList *representatives, StudentList *students,
+                      History *history) {
+
+    //Variable declarations.
+    int          index;
+    long long    totalSize    = 0;
+    long long    totalCompile = 0;
+    long long    totalRun     = 0;
+    HistoryEntry key;
+    HistoryEntry *entry;
+    Student      *student;
+
+    //Learn the average costs of the previous runs.
+    for (index = 0; index < history->count; index++) {
+
+        totalSize    += history->entries[index].sourceSize;
+        totalCompile += history->entries[index].compileTime;
+        totalRun     += history->entries[index].runTime;
+    }
+
+    //Students found again keep their history, the others are forgotten.
+    for (index = 0; index < students->count; index++) {
+
+        key.name = students->items[index]->name;
+        entry    = history->count == 0 ? 0 :
+                   (HistoryEntry *) bsearch(&key, history->entries,
+                                            (size_t) history->count,
+                                            sizeof(HistoryEntry),
+                                            CompareHistoryEntries);
+
+        if (entry != 0) {
+
+            entry->isUsed = 1;
+        }
+
+        student = students->items[index];
+
+        //Check if the student was graded before.
+        if (entry != 0) {
+
+            student->predictedCost   = entry->compileTime + entry->runTime;
+            student->previousRunTime = entry->runTime;
+
+        //Check if there are averages to guess from.
+        } else if (history->count > 0 && totalSize > 0) {
+
+            //Compiling grows with the C file, running is the usual one.
+            student->predictedCost =
+                    (long long) ((double) totalCompile / totalSize *
+                                 student->sourceSize) +
+                    totalRun / history->count;
+
+        } else {
+
+            student->predictedCost = DEFAULT_COMPILE_MICROS;
+        }
+    }
+
+    //Longest first, then keep the directory order.
+    qsort(representatives->items, (size_t) representatives->count,
+          sizeof(Student *), CompareCosts);
+
+    for (index = 0; index < representatives->count; index++) {
+
+        representatives->items[index]->index = index;
+    }
+}
+
+int CompareCosts(const void *first, const void *second) {
+
+    //Variable declarations.
+    Student *student1 = *(Student **) first;
+    Student *student2 = *(Student **) second;
+
+    if (student1->predictedCost != student2->predictedCost) {
+
+        return student1->predictedCost > student2->predictedCost ? -1 : 1;
+    }
+
+    return student1->index - student2->index;
+}
+
+void QueueAssignments(Assignment *assignments, Options *options,
+                      StudentList *queue) {
+
+    //Variable declarations.
+    int     count = options->configCount;
+    int     index;
+    int     best;
+    int     *next;
+    double  *queued;
+    double  *total;
+    Student *student;
+
+    next   = (int *) calloc(count, sizeof(int));
+    queued = (double *) calloc(count, sizeof(double));
+    total  = (double *) calloc(count, sizeof(double));
+
+    //Check if allocation worked.
+    if (next == 0 || queued == 0 || total == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //A student is never free, so an assignment of unknown costs moves too.
+    for (index = 0; index < count; index++) {
+
+        for (best = 0; best < assignments[index].representatives.count;
+             best++) {
+
+            total[index] += assignments[index].representatives.items[best]->
+                                    predictedCost + 1;
+        }
+    }
+
+    while (1) {
+
+        best = -1;
+
+        //Find the assignment furthest behind, each keeps its own order.
+        for (index = 0; index < count; index++) {
+
+            if (next[index] == assignments[index].representatives.count) {
+                continue;
+            }
+
+            if (best < 0 ||
+                queued[index] / total[index] < queued[best] / total[best]) {
+
+                best = index;
+            }
+        }
+
+        //Check if every student was queued.
+        if (best < 0) {
+            break;
+        }
+
+        student = assignments[best].representatives.items[next[best]++];
+        queued[best] += student->predictedCost + 1;
+
+        //The student's position in the queue is its index from now on.
+        AddStudent(queue, student);
+    }
+
+    free(next);
+    free(queued);
+    free(total);
+}
+
+void WriteHistory(History *history, StudentList *representatives,
+                  char *path) {
+
+    //Variable declarations.
+    char      tempPath[LINE_SIZE];
+    int       historyFile;
+    int       isFailed = 0;
+    int       index;
+    int       stage;
+    long long times[STAGE_COUNT];
+    char      line[LINE_SIZE];
+    Student   *student;
+    Student   *member;
+
+    sprintf(tempPath, "%s.tmp", path);
+    historyFile = open(tempPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the history was opened.
+    if (historyFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    //Every student in a group cost what grading the group did.
+    for (index = 0; index < representatives->count; index++) {
+
+        student = representatives->items[index];
+
+        for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+            times[stage] = student->stageTimes[stage] > 0 ?
+                           student->stageTimes[stage] : 0;
+        }
+
+        for (member = student; member != 0; member = member->nextDuplicate) {
+
+            sprintf(line, "%s,%lld,%lld,%lld\n", member->name,
+                    (long long) member->sourceSize, times[STAGE_COMPILE],
+                    times[STAGE_EXECUTE] + times[STAGE_COMPARE]);
+            isFailed |= WriteToFile(historyFile, line);
+        }
+    }
+
+    //Keep the students this run did not grade, like resumed ones.
+    for (index = 0; index < history->count; index++) {
+
+        if (history->entries[index].isUsed) {
+            continue;
+        }
+
+        sprintf(line, "%s,%lld,%lld,%lld\n", history->entries[index].name,
+                history->entries[index].sourceSize,
+                history->entries[index].compileTime,
+                history->entries[index].runTime);
+        isFailed |= WriteToFile(historyFile, line);
+    }
+
+    //Check if the history was written and closed, else keep the old one.
+    if (close(historyFile) < 0 || isFailed) {
+
+        fprintf(stderr, "Warning: failed to write %s.\n", path);
+        unlink(tempPath);
+
+        return;
+    }
+
+    //Replace the old history in one step.
+    if (rename(tempPath, path) < 0) {
+
+        perror("Error: failed to rename file.\n");
+        exit(1);
+    }
+}
+
+void FreeHistory(History *history) {
+
+    free(history->entries);
+    free(history->content);
+}
+
+pid_t StartPrecheck(StudentList *students, LineReader *precheck) {
+
+    //Variable declarations.
+    int   pipeEnds[2];
+    pid_t precheckPId;
+
+    //Check if the pipe was created.
+    if (pipe(pipeEnds) < 0) {
+
+        perror("Error: pipe failed.\n");
+        exit(1);
+    }
+
+    precheckPId = fork();
+
+    //Check if fork succeeded.
+    if (precheckPId < 0) {
+
+        perror("Error: fork failed.\n");
+        exit(1);
+    }
+
+    if (precheckPId == 0) {
+
+        //Its own group, so stopping it stops its compiler too.
+        setpgid(0, 0);
+        close(pipeEnds[0]);
+        RunPrecheck(students, pipeEnds[1]);
+        exit(0);
+    }
+
+    setpgid(precheckPId, precheckPId);
+    close(pipeEnds[1]);
+
+    precheck->fd     = pipeEnds[0];
+    precheck->length = 0;
+
+    return precheckPId;
+}
+
+void RunPrecheck(StudentList *students, int pipe) {
+
+    //Variable declarations.
+    char    message[LINE_SIZE];
+    int     end;
+    int     start;
+    int     index;
+    Student **batch;
+
+    //The grading reaches the end of the queue last, start there.
+    for (end = students->count; end > 0; end = start) {
+
+        start = end > PRECHECK_BATCH ? end - PRECHECK_BATCH : 0;
+        batch = &students->items[start];
+
+        //Most batches are fine, only a failed one is checked file by file.
+        if (CheckSyntax(batch, end - start)) {
+            continue;
+        }
+
+        for (index = end - 1; index >= start; index--) {
+
+            if (end - start > 1 && CheckSyntax(&students->items[index], 1)) {
+                continue;
+            }
+
+            sprintf(message, "%d\n", students->items[index]->index);
+
+            //Check if the coordinator stopped listening.
+            if (WriteToFile(pipe, message) < 0) {
+
+                close(pipe);
+
+                return;
+            }
+        }
+    }
+
+    close(pipe);
+}
+
+int CheckSyntax(Student **students, int count) {
+
+    //Variable declarations.
+    char  *args[PRECHECK_BATCH + 5];
+    char  sourcePaths[PRECHECK_BATCH][32];
+    int   sourceFiles[PRECHECK_BATCH];
+    int   index;
+    int   status;
+    int   nullFile;
+    int   isChecked = 1;
+    int   attempt   = 0;
+    pid_t checkPId  = -1;
+
+    //The C files inside archives have no .c name of their own.
+    args[0] = "gcc";
+    args[1] = "-fsyntax-only";
+    args[2] = "-x";
+    args[3] = "c";
+
+    for (index = 0; index < count; index++) {
+
+        sourceFiles[index] = -1;
+        args[index + 4]    = students[index]->cFilePath;
+
+        //A C file inside an archive is read through its memory file.
+        if (ArchivePathLength(students[index]->cFilePath) > 0) {
+
+            sourceFiles[index] = OpenStudentSource(students[index]);
+            sprintf(sourcePaths[index], "/proc/self/fd/%d",
+                    sourceFiles[index]);
+            args[index + 4] = sourcePaths[index];
+
+            //Check if the C file was unpacked, else the compile stage tells.
+            if (sourceFiles[index] < 0) {
+
+                isChecked = 0;
+            }
+        }
+    }
+
+    args[count + 4] = 0;
+
+    if (isChecked) {
+
+        do {
+
+            checkPId = fork();
+        } while (checkPId < 0 && ShouldRetry(&attempt));
+    }
+
+    if (checkPId == 0) {
+
+        //The compile stage shows the errors, the pre-check stays quiet.
+        nullFile = open("/dev/null", O_WRONLY);
+
+        if (nullFile >= 0) {
+
+            dup2(nullFile, 2);
+            close(nullFile);
+        }
+
+        //Let gcc inherit the memory files.
+        for (index = 0; index < count; index++) {
+
+            if (sourceFiles[index] >= 0) {
+
+                fcntl(sourceFiles[index], F_SETFD, 0);
+            }
+        }
+
+        execvp("gcc", args);
+
+        perror("Error: execution failed.\n");
+        exit(CHILD_EXEC_FAILED);
+    }
+
+    for (index = 0; index < count; index++) {
+
+        if (sourceFiles[index] >= 0) {
+
+            close(sourceFiles[index]);
+        }
+    }
+
+    //Check if fork succeeded, else the compile stage will find the errors.
+    if (checkPId < 0) {
+
+        return 1;
+    }
+
+    //Check if wait succeeded.
+    if (WaitForChildExec(checkPId, &status) < 0) {
+
+        return 1;
+    }
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int ReadPrecheck(LineReader *precheck, StudentList *students, Stats *stats) {
+
+    //Variable declarations.
+    char          line[LINE_SIZE];
+    int           finished = 0;
+    int           index;
+    int           stage;
+    struct pollfd pollPipe;
+    Student       *student;
+
+    pollPipe.fd     = precheck->fd;
+    pollPipe.events = POLLIN;
+
+    //Read only what already arrived.
+    while (precheck->fd >= 0 && poll(&pollPipe, 1, 0) > 0) {
+
+        //Check if the pre-check is done, the grading covers what it missed.
+        if (FillLineReader(precheck) <= 0) {
+
+            close(precheck->fd);
+            precheck->fd = -1;
+        }
+
+        while (NextLine(precheck, line)) {
+
+            index = atoi(line);
+
+            //Check that the index is legal.
+            if (index < 0 || index >= students->count) {
+                continue;
+            }
+
+            student = students->items[index];
+
+            //A worker already compiling the student will find the error.
+            if (student->isFinished || student->isDispatched) {
+                continue;
+            }
+
+            for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+                student->stageTimes[stage] = -1;
+            }
+
+            FinishStudent(student, VERDICT_COMPILATION_ERROR, stats);
+            stats->prechecked++;
+            finished++;
+        }
+    }
+
+    return finished;
+}
+
+void StopPrecheck(pid_t pid, LineReader *precheck) {
+
+    kill(-pid, SIGKILL);
+    waitpid(pid, 0, 0);
+
+    if (precheck->fd >= 0) {
+
+        close(precheck->fd);
+        precheck->fd = -1;
+    }
+}
+
+void LoadConfig(Options *options) {
+
+    //Variable declarations.
+    char   *line;
+    char   *next;
+    char   *key;
+    char   *value;
+    char   *end;
+    char   *keyNames[CONFIG_KEY_COUNT] = {"students", "input", "output",
+                                          "tests", "workers", "output_limit",
+                                          "stats", "history", "compare_mode",
+                                          "abs_eps", "rel_eps",
+                                          "distance_budget", "diff_feedback",
+                                          "precheck", "perf",
+                                          "compare_threads", "watch",
+                                          "watch_debounce", "affinity",
+                                          "plagiarism",
+                                          "plagiarism_threshold",
+                                          "plagiarism_common",
+                                          "plagiarism_starter"};
+    int    isSeen[CONFIG_KEY_COUNT] = {0};
+    int    isNamed    = -1;
+    int    lineNumber = 0;
+    int    keyIndex;
+    size_t size;
+
+    options->configContent = ReadWholeFile(options->configPath, &size);
+
+    for (line = options->configContent; line != 0; line = next) {
+
+        lineNumber++;
+        next = strchr(line, '\n');
+
+        if (next != 0) {
+
+            *next++ = '\0';
+        }
+
+        //Drop the spaces around the line.
+        while (*line == ' ' || *line == '\t') {
+
+            line++;
+        }
+
+        end = line + strlen(line);
+
+        while (end > line && (end[-1] == ' ' || end[-1] == '\t' ||
+                              end[-1] == '\r')) {
+
+            *--end = '\0';
+        }
+
+        //The first line tells the format apart.
+        if (isNamed < 0 && *line != '\0') {
+
+            isNamed = *line == '#' || strchr(line, '=') != 0;
+        }
+
+        //Check if the file has the old lines in order.
+        if (isNamed != 1) {
+
+            //An empty line ends the correct outputs.
+            if (*line == '\0' && lineNumber > 3) {
+                break;
+            }
+
+            if (lineNumber == 1) {
+
+                options->dirPath = line;
+
+            } else if (lineNumber == 2) {
+
+                options->inputPath = line;
+
+            } else if (options->outputCount < MAX_REFERENCES) {
+
+                options->outputPaths[options->outputCount++] = line;
+            }
+
+            continue;
+        }
+
+        //Skip empty lines and comments.
+        if (*line == '\0' || *line == '#') {
+            continue;
+        }
+
+        value = strchr(line, '=');
+
+        //Check that the line is a setting.
+        if (value == 0) {
+
+            fprintf(stderr, "Error: line %d of the configuration is not "
+                            "key = value.\n", lineNumber);
+            exit(1);
+        }
+
+        //Split the key from the value and drop the spaces around them.
+        key = line;
+        end = value;
+        *value++ = '\0';
+
+        while (end > key && (end[-1] == ' ' || end[-1] == '\t')) {
+
+            *--end = '\0';
+        }
+
+        while (*value == ' ' || *value == '\t') {
+
+            value++;
+        }
+
+        for (keyIndex = 0; keyIndex < CONFIG_KEY_COUNT; keyIndex++) {
+
+            if (strcmp(key, keyNames[keyIndex]) == 0) {
+                break;
+            }
+        }
+
+        //Check that the key is known.
+        if (keyIndex == CONFIG_KEY_COUNT) {
+
+            fprintf(stderr, "Error: line %d of the configuration has the "
+                            "unknown key %s.\n", lineNumber, key);
+            exit(1);
+        }
+
+        //Check that the key has a value.
+        if (*value == '\0') {
+
+            fprintf(stderr, "Error: line %d of the configuration has no "
+                            "value for %s.\n", lineNumber, key);
+            exit(1);
+        }
+
+        ApplyConfigKey(options, key, value, lineNumber, !isSeen[keyIndex]);
+        isSeen[keyIndex] = 1;
+    }
+
+    options->outputPaths[options->outputCount] = 0;
+}
+
+void ApplyConfigKey(Options *options, char *key, char *value, int lineNumber,
+                    int isFirst) {
+
+    //Only the correct outputs may be given more than once.
+    if (!isFirst && strcmp(key, "output") != 0) {
+
+        fprintf(stderr, "Error: line %d of the configuration gives %s "
+                        "again.\n", lineNumber, key);
+        exit(1);
+    }
+
+    if (strcmp(key, "students") == 0) {
+
+        options->dirPath = value;
+
+    } else if (strcmp(key, "input") == 0) {
+
+        options->inputPath = value;
+
+    } else if (strcmp(key, "output") == 0) {
+
+        //Check that there is room for another correct output.
+        if (options->outputCount == MAX_REFERENCES) {
+
+            fprintf(stderr, "Error: line %d of the configuration has more "
+                            "than %d outputs.\n", lineNumber, MAX_REFERENCES);
+            exit(1);
+        }
+
+        options->outputPaths[options->outputCount++] = value;
+
+    } else if (strcmp(key, "tests") == 0) {
+
+        if (options->testsPath == 0) {
+
+            options->testsPath = value;
+        }
+
+    } else if (strcmp(key, "workers") == 0) {
+
+        long workers = ParseConfigNumber(value, lineNumber, 1);
+
+        if (options->workers == 0) {
+
+            options->workers = (int) workers;
+        }
+
+    } else if (strcmp(key, "output_limit") == 0) {
+
+        long outputLimit = ParseConfigNumber(value, lineNumber, 1);
+
+        if (options->outputLimit == 0) {
+
+            options->outputLimit = outputLimit;
+        }
+
+    } else if (strcmp(key, "stats") == 0) {
+
+        if (options->statsPath == 0) {
+
+            options->statsPath = value;
+        }
+
+    } else if (strcmp(key, "history") == 0) {
+
+        options->historyPath = value;
+
+    } else if (strcmp(key, "compare_mode") == 0) {
+
+        AddCompareFlag(options, "--mode", value);
+
+    } else if (strcmp(key, "abs_eps") == 0) {
+
+        AddCompareFlag(options, "--abs-eps", value);
+
+    } else if (strcmp(key, "rel_eps") == 0) {
+
+        AddCompareFlag(options, "--rel-eps", value);
+
+    } else if (strcmp(key, "distance_budget") == 0) {
+
+        AddCompareFlag(options, "--distance-budget", value);
+        options->isDiffFeedback = 1;
+
+    } else if (strcmp(key, "diff_feedback") == 0) {
+
+        options->isDiffFeedback |= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "precheck") == 0) {
+
+        options->isPrecheck &= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "perf") == 0) {
+
+        options->isPerf |= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "compare_threads") == 0) {
+
+        AddCompareFlag(options, "--threads", value);
+
+    } else if (strcmp(key, "watch") == 0) {
+
+        options->isWatch |= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "watch_debounce") == 0) {
+
+        //The quiet period is given in milliseconds.
+        options->watchDebounce = ParseConfigNumber(value, lineNumber, 0) *
+                                 1000LL;
+
+    } else if (strcmp(key, "affinity") == 0) {
+
+        options->isAffinity |= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "plagiarism") == 0) {
+
+        options->isPlagiarism |= ParseConfigSwitch(value, lineNumber);
+
+    } else if (strcmp(key, "plagiarism_threshold") == 0) {
+
+        options->plagiarismThreshold = (int) ParseConfigNumber(value,
+                                                               lineNumber, 1);
+
+        //Check that the threshold is a percent.
+        if (options->plagiarismThreshold > 100) {
+
+            fprintf(stderr, "Error: line %d of the configuration has a "
+                            "threshold over 100.\n", lineNumber);
+            exit(1);
+        }
+
+    } else if (strcmp(key, "plagiarism_common") == 0) {
+
+        options->plagiarismCommon = (int) ParseConfigNumber(value, lineNumber,
+                                                            1);
+
+        //Check that the share is a percent.
+        if (options->plagiarismCommon > 100) {
+
+            fprintf(stderr, "Error: line %d of the configuration has a "
+                            "percent over 100.\n", lineNumber);
+            exit(1);
+        }
+
+    } else if (strcmp(key, "plagiarism_starter") == 0) {
+
+        options->plagiarismStarter = value;
+    }
+}
+
+long ParseConfigNumber(char *value, int lineNumber, long minimum) {
+
+    //Variable declarations.
+    char *end;
+    long number;
+
+    errno  = 0;
+    number = strtol(value, &end, 10);
+
+    //Check that the whole value is a legal number.
+    if (errno != 0 || *end != '\0' || number < minimum) {
+
+        fprintf(stderr, "Error: line %d of the configuration: %s is not a "
+                        "number of at least %ld.\n", lineNumber, value,
+                minimum);
+        exit(1);
+    }
+
+    return number;
+}
+
+int ParseConfigSwitch(char *value, int lineNumber) {
+
+    if (strcmp(value, "yes") == 0 || strcmp(value, "true") == 0 ||
+        strcmp(value, "1") == 0) {
+
+        return 1;
+    }
+
+    if (strcmp(value, "no") == 0 || strcmp(value, "false") == 0 ||
+        strcmp(value, "0") == 0) {
+
+        return 0;
+    }
+
+    fprintf(stderr, "Error: line %d of the configuration: %s is not yes or "
+                    "no.\n", lineNumber, value);
+    exit(1);
+}
+
+void AddCompareFlag(Options *options, char *flag, char *value) {
+
+    //Variable declarations.
+    int index;
+
+    for (index = 0; index < options->compareFlagCount; index += 2) {
+
+        //Check if the command line already gave the flag.
+        if (strcmp(options->compareFlags[index], flag) == 0) {
+
+            return;
+        }
+    }
+
+    //Check that there is room for the flag.
+    if (options->compareFlagCount + 2 > MAX_COMPARE_FLAGS) {
+
+        fprintf(stderr, "Error: too many comparison flags.\n");
+        exit(1);
+    }
+
+    options->compareFlags[options->compareFlagCount++] = flag;
+    options->compareFlags[options->compareFlagCount++] = value;
+    options->compareFlags[options->compareFlagCount]   = 0;
+}
+
+void ValidateOptions(Options *options) {
+
+    //Variable declarations.
+    char        *end;
+    char        *flag;
+    char        *value;
+    int         index;
+    struct stat pathStat;
+
+    //Check that the students directory is there.
+    if (options->dirPath == 0 || *options->dirPath == '\0' ||
+        stat(options->dirPath, &pathStat) < 0 ||
+        !S_ISDIR(pathStat.st_mode)) {
+
+        fprintf(stderr, "Error: the students directory %s is missing.\n",
+                options->dirPath != 0 ? options->dirPath : "");
+        exit(1);
+    }
+
+    //Check that the student paths built from it fit.
+    if (strlen(options->dirPath) >= MAX_SIZE / 2) {
+
+        fprintf(stderr, "Error: the students directory path is too long.\n");
+        exit(1);
+    }
+
+    //Check that there is something to run the students on.
+    if (options->testsPath == 0 &&
+        (options->inputPath == 0 || options->outputCount == 0)) {
+
+        fprintf(stderr, "Error: the configuration needs an input and an "
+                        "output, or tests.\n");
+        exit(1);
+    }
+
+    //The test case list is checked when it is read.
+    if (options->testsPath == 0) {
+
+        //Check that the input can be read.
+        if (access(options->inputPath, R_OK) < 0) {
+
+            fprintf(stderr, "Error: cannot read the input %s.\n",
+                    options->inputPath);
+            exit(1);
+        }
+
+        for (index = 0; index < options->outputCount; index++) {
+
+            //Check that the correct output can be read.
+            if (access(options->outputPaths[index], R_OK) < 0) {
+
+                fprintf(stderr, "Error: cannot read the output %s.\n",
+                        options->outputPaths[index]);
+                exit(1);
+            }
+        }
+    }
+
+    //The comparator would only find a bad flag once per student.
+    for (index = 0; index < options->compareFlagCount; index += 2) {
+
+        flag  = options->compareFlags[index];
+        value = options->compareFlags[index + 1];
+        errno = 0;
+
+        if (strcmp(flag, "--mode") == 0) {
+
+            //Check that the mode is known.
+            if (strcmp(value, "token") != 0 && strcmp(value, "numeric") != 0 &&
+                strcmp(value, "lines") != 0) {
+
+                fprintf(stderr, "Error: unknown comparison mode %s.\n", value);
+                exit(1);
+            }
+
+        } else if (strcmp(flag, "--distance-budget") == 0) {
+
+            //Check that the budget is a whole number.
+            if (strtol(value, &end, 10) < 0 || *end != '\0' || errno != 0) {
+
+                fprintf(stderr, "Error: illegal distance budget %s.\n", value);
+                exit(1);
+            }
+
+        } else if (strcmp(flag, "--threads") == 0) {
+
+            //Check that the amount of threads is a whole number, 0 for one
+            //per processor.
+            if (strtol(value, &end, 10) < 0 || *end != '\0' || errno != 0) {
+
+                fprintf(stderr, "Error: illegal amount of threads %s.\n",
+                        value);
+                exit(1);
+            }
+
+        } else if (strtod(value, &end) < 0 || *end != '\0' || errno != 0) {
+
+            fprintf(stderr, "Error: illegal epsilon %s.\n", value);
+            exit(1);
+        }
+    }
+
+    //Check that the starter file can be read.
+    if (options->plagiarismStarter != 0 &&
+        access(options->plagiarismStarter, R_OK) < 0) {
+
+        fprintf(stderr, "Error: cannot read the starter file %s.\n",
+                options->plagiarismStarter);
+        exit(1);
+    }
+
+    //Check that the comparator is there.
+    if (access("./comp.out", X_OK) < 0) {
+
+        fprintf(stderr, "Error: the comparator ./comp.out is missing.\n");
+        exit(1);
+    }
+
+    //Keep the history in the working directory by default.
+    if (options->historyPath == 0) {
+
+        options->historyPath = HISTORY_FILE;
+    }
+}
+
+int OpenCounter(int counter, pid_t pid) {
+
+    //Variable declarations.
+    static unsigned int       types[COUNTER_COUNT]   = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE};
+    static unsigned long long configs[COUNTER_COUNT] = {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_SW_TASK_CLOCK};
+    struct perf_event_attr    attributes;
+
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size           = sizeof(attributes);
+    attributes.type           = types[counter];
+    attributes.config         = configs[counter];
+    attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv     = 1;
+
+    //Count the student's program only, not its setup.
+    if (pid != 0) {
+
+        attributes.disabled       = 1;
+        attributes.enable_on_exec = 1;
+        attributes.inherit        = 1;
+    }
+
+    return (int) syscall(SYS_perf_event_open, &attributes, pid, -1, -1,
+                         PERF_FLAG_FD_CLOEXEC);
+}
+
+void ProbeCounters(Options *options) {
+
+    //Variable declarations.
+    static char *counterNames[COUNTER_COUNT] = {"instructions", "cycles",
+                                                "cache misses",
+                                                "branch misses", "task clock"};
+    int         counter;
+    int         counterFile;
+    int         isAny = 0;
+
+    for (counter = 0; counter < COUNTER_COUNT; counter++) {
+
+        counterFile = OpenCounter(counter, 0);
+
+        //Check if the counter can be opened here.
+        if (counterFile < 0) {
+
+            fprintf(stderr, "Warning: the %s counter is unavailable: %s.\n",
+                    counterNames[counter], strerror(errno));
+            options->isCounterAvailable[counter] = 0;
+            continue;
+        }
+
+        close(counterFile);
+        options->isCounterAvailable[counter] = 1;
+        isAny = 1;
+    }
+
+    //Check if there is anything left to measure.
+    if (!isAny) {
+
+        fprintf(stderr, "Warning: no counters, grading without them.\n");
+        options->isPerf = 0;
+    }
+}
+
+void ReadCounters(Student *student, int *counterFiles) {
+
+    //Variable declarations.
+    unsigned long long values[3];
+    int                counter;
+
+    for (counter = 0; counter < COUNTER_COUNT; counter++) {
+
+        if (counterFiles[counter] < 0) {
+            continue;
+        }
+
+        //Check if the value, its enabled time and running time were read.
+        if (read(counterFiles[counter], values, sizeof(values)) ==
+            sizeof(values)) {
+
+            //Scale up a counter that only ran part of the time.
+            if (values[2] > 0 && values[2] < values[1]) {
+
+                values[0] = (unsigned long long)
+                        ((double) values[0] * values[1] / values[2]);
+            }
+
+            if (student->counters[counter] < 0) {
+
+                student->counters[counter] = 0;
+            }
+
+            student->counters[counter] += (long long) values[0];
+        }
+
+        close(counterFiles[counter]);
+    }
+}
+
+void WriteResultsStore(StudentList *students, StudentList *unfound,
+                       Journal *journal, char *path) {
+
+    //Variable declarations.
+    static char        *verdictNames[VERDICT_MULTIPLE_DIRECTORIES + 1] = {
+            "", "GREAT_JOB", "SIMILLAR_OUTPUT", "BAD_OUTPUT",
+            "COMPILATION_ERROR", "TIMEOUT", "OUTPUT_LIMIT", "INTERNAL_ERROR",
+            "NO_C_FILE", "MULTIPLE_DIRECTORIES"};
+    char               tempPath[LINE_SIZE];
+    int                storeFile;
+    int                rowCount;
+    int                index;
+    int                stage;
+    int                verdict;
+    char               *field;
+    char               *names;
+    unsigned int       namesSize = 0;
+    unsigned int       *nameOffsets;
+    signed char        *grades;
+    unsigned char      *verdicts;
+    signed char        *depths;
+    long long          *times[STAGE_COUNT];
+    unsigned long long offset;
+    StoreHeader        header;
+    StoreRow           *rows;
+    Student            *student;
+
+    rowCount = students->count + unfound->count + journal->count;
+    rows     = (StoreRow *) malloc((rowCount + 1) * sizeof(StoreRow));
+
+    //Check if allocation worked.
+    if (rows == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //This run's students, with their group's times for duplicates.
+    for (index = 0; index < students->count + unfound->count; index++) {
+
+        student = index < students->count ? students->items[index] :
+                  unfound->items[index - students->count];
+
+        rows[index].name    = student->name;
+        rows[index].grade   = student->result.grade;
+        rows[index].verdict = student->verdict;
+        rows[index].depth   = student->depth;
+
+        for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+            rows[index].stageTimes[stage] = student->stageTimes[stage];
+        }
+    }
+
+    //The journal kept the grade and the feedback, whose first word is the
+    //verdict. Its fields were cut apart at the commas.
+    for (index = 0; index < journal->count; index++) {
+
+        StoreRow *row = &rows[students->count + unfound->count + index];
+
+        row->name    = journal->names[index];
+        field        = row->name + strlen(row->name) + 1;
+        row->grade   = atoi(field);
+        field       += strlen(field) + 1;
+        row->verdict = 0;
+        row->depth   = -1;
+
+        for (verdict = 1; verdict <= VERDICT_MULTIPLE_DIRECTORIES; verdict++) {
+
+            if (strcmp(field, verdictNames[verdict]) == 0) {
+
+                row->verdict = verdict;
+            }
+        }
+
+        for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+            row->stageTimes[stage] = -1;
+        }
+    }
+
+    qsort(rows, (size_t) rowCount, sizeof(StoreRow), CompareRows);
+
+    for (index = 0; index < rowCount; index++) {
+
+        namesSize += (unsigned int) strlen(rows[index].name) + 1;
+    }
+
+    nameOffsets = (unsigned int *) malloc((rowCount + 1) *
+                                          sizeof(unsigned int));
+    names       = (char *) malloc(namesSize + 1);
+    grades      = (signed char *) malloc(rowCount + 1);
+    verdicts    = (unsigned char *) malloc(rowCount + 1);
+    depths      = (signed char *) malloc(rowCount + 1);
+
+    for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+        times[stage] = (long long *) malloc((rowCount + 1) *
+                                            sizeof(long long));
+
+        //Check if allocation worked.
+        if (times[stage] == 0) {
+
+            perror("Error: malloc failed.\n");
+            exit(1);
+        }
+    }
+
+    //Check if allocation worked.
+    if (nameOffsets == 0 || names == 0 || grades == 0 || verdicts == 0 ||
+        depths == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Turn the rows into columns.
+    namesSize = 0;
+
+    for (index = 0; index < rowCount; index++) {
+
+        nameOffsets[index] = namesSize;
+        strcpy(names + namesSize, rows[index].name);
+        namesSize += (unsigned int) strlen(rows[index].name) + 1;
+
+        grades[index]   = (signed char) rows[index].grade;
+        verdicts[index] = (unsigned char) rows[index].verdict;
+        depths[index]   = (signed char) rows[index].depth;
+
+        for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+            times[stage][index] = rows[index].stageTimes[stage];
+        }
+    }
+
+    //Every column starts 8 byte aligned right after the one before it.
+    memset(&header, 0, sizeof(StoreHeader));
+    memcpy(header.magic, STORE_MAGIC, sizeof(header.magic));
+    header.rowCount  = (unsigned int) rowCount;
+    header.namesSize = namesSize;
+    offset           = (sizeof(StoreHeader) + 7) & ~7ULL;
+
+    header.columns[COLUMN_NAME_OFFSETS] = offset;
+    offset += (rowCount * sizeof(unsigned int) + 7) & ~7ULL;
+    header.columns[COLUMN_NAMES] = offset;
+    offset += (namesSize + 7) & ~7ULL;
+    header.columns[COLUMN_GRADES] = offset;
+    offset += (rowCount + 7) & ~7ULL;
+    header.columns[COLUMN_VERDICTS] = offset;
+    offset += (rowCount + 7) & ~7ULL;
+    header.columns[COLUMN_DEPTHS] = offset;
+    offset += (rowCount + 7) & ~7ULL;
+
+    for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+        header.columns[COLUMN_COMPILE_TIMES + stage] = offset;
+        offset += rowCount * sizeof(long long);
+    }
+
+    sprintf(tempPath, "%s.tmp", path);
+    storeFile = open(tempPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the store was opened.
+    if (storeFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    offset = 0;
+    WriteColumn(storeFile, &header, sizeof(StoreHeader), &offset);
+    WriteColumn(storeFile, nameOffsets, rowCount * sizeof(unsigned int),
+                &offset);
+    WriteColumn(storeFile, names, namesSize, &offset);
+    WriteColumn(storeFile, grades, (size_t) rowCount, &offset);
+    WriteColumn(storeFile, verdicts, (size_t) rowCount, &offset);
+    WriteColumn(storeFile, depths, (size_t) rowCount, &offset);
+
+    for (stage = 0; stage < STAGE_COUNT; stage++) {
+
+        WriteColumn(storeFile, times[stage], rowCount * sizeof(long long),
+                    &offset);
+        free(times[stage]);
+    }
+
+    //Check if the store was closed.
+    if (close(storeFile) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    //Readers that mapped the old store keep it until they unmap it.
+    if (rename(tempPath, path) < 0) {
+
+        perror("Error: failed to rename file.\n");
+        exit(1);
+    }
+
+    free(nameOffsets);
+    free(names);
+    free(grades);
+    free(verdicts);
+    free(depths);
+    free(rows);
+}
+
+int CompareRows(const void *first, const void *second) {
+
+    return strcmp(((StoreRow *) first)->name, ((StoreRow *) second)->name);
+}
+
+void WriteColumn(int file, void *column, size_t size,
+                 unsigned long long *offset) {
+
+    //Variable declarations.
+    static char padding[8] = {0};
+    size_t      written    = 0;
+    ssize_t     writeNum;
+
+    while (written < size) {
+
+        writeNum = write(file, (char *) column + written, size - written);
+
+        //Check that the column was written.
+        if (writeNum < 0) {
+
+            perror("Error: failed to write to file.\n");
+            exit(1);
+        }
+
+        written += (size_t) writeNum;
+    }
+
+    *offset += size;
+
+    //Check if the next column needs padding.
+    if (*offset % 8 != 0) {
+
+        size     = 8 - *offset % 8;
+        *offset += size;
+
+        //Check that the padding was written.
+        if (write(file, padding, size) != (ssize_t) size) {
+
+            perror("Error: failed to write to file.\n");
+            exit(1);
+        }
+    }
+}
+
+int ShouldRetry(int *attempt) {
+
+    //Variable declarations.
+    int             error = errno;
+    struct timespec sleepTime;
+
+    //Check if the failure may pass and there are attempts left.
+    if ((error != EINTR && error != EAGAIN && error != ENFILE &&
+         error != EMFILE && error != ENOMEM && error != ENOBUFS) ||
+        *attempt >= MAX_RETRIES) {
+
+        return 0;
+    }
+
+    //An interrupted call is made again at once.
+    if (error != EINTR) {
+
+        sleepTime.tv_sec  = ((long) RETRY_MIN_MICROS << *attempt) / 1000000;
+        sleepTime.tv_nsec = ((long) RETRY_MIN_MICROS << *attempt) % 1000000 *
+                            1000;
+        nanosleep(&sleepTime, 0);
+    }
+
+    (*attempt)++;
+    errno = error;
+
+    return 1;
+}
+
+void ReportChildError(int errorPipe) {
+
+    //Variable declarations.
+    int error = errno;
+
+    write(errorPipe, &error, sizeof(error));
+    _exit(CHILD_EXEC_FAILED);
+}
+
+int LocateStudent(Student *student, Options *options, Stats *stats,
+                  StudentList *unfound) {
+
+    //The student's results go to the files of its assignment.
+    student->options = options;
+
+    //Search for the student's C file.
+    student->cFilePath = FindCFile(options->dirPath, student);
+
+    //Check if the student could not be searched or read.
+    if (student->isInternalError ||
+        (student->cFilePath != 0 && HashSourceFile(student) < 0)) {
+
+        ApplyVerdict(student, VERDICT_INTERNAL_ERROR);
+        WriteStudentResult(student);
+
+        stats->verdicts[VERDICT_INTERNAL_ERROR]++;
+        stats->written++;
+        WriteStats(stats, 0);
+
+        //Keep the student for the results store.
+        AddStudent(unfound, student);
+
+        return 0;
+    }
+
+    //Check if C file was found.
+    if (student->cFilePath == 0) {
+
+        HandleNoCFile(student);
+
+        student->verdict = student->isMultipleDirectories ?
+                           VERDICT_MULTIPLE_DIRECTORIES : VERDICT_NO_C_FILE;
+
+        //Write student's result and count the student in the statistics.
+        if (WriteStudentResult(student) < 0) {
+
+            stats->verdicts[VERDICT_INTERNAL_ERROR]++;
+
+        } else if (student->isMultipleDirectories) {
+
+            stats->multipleDirectories++;
+
+        } else {
+
+            stats->noCFile++;
+        }
+
+        stats->written++;
+        WriteStats(stats, 0);
+
+        //Keep the student for the results store.
+        AddStudent(unfound, student);
+
+        return 0;
+    }
+
+    stats->located++;
+
+    return 1;
+}
+
+void StartWatch(Watcher *watcher, char *dirPath) {
+
+    watcher->dirs           = 0;
+    watcher->dirCount       = 0;
+    watcher->dirCapacity    = 0;
+    watcher->changes        = 0;
+    watcher->changeCount    = 0;
+    watcher->changeCapacity = 0;
+    watcher->fd             = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    //Check if the watch was created.
+    if (watcher->fd < 0) {
+
+        perror("Error: inotify_init1 failed.\n");
+        exit(1);
+    }
+
+    //The watch ends on these signals, read between the grading rounds.
+    sigemptyset(&watcher->signals);
+    sigaddset(&watcher->signals, SIGINT);
+    sigaddset(&watcher->signals, SIGTERM);
+    watcher->signalFd = signalfd(-1, &watcher->signals, SFD_CLOEXEC);
+
+    //Check if the signal descriptor was created.
+    if (watcher->signalFd < 0) {
+
+        perror("Error: signalfd failed.\n");
+        exit(1);
+    }
+
+    WatchTree(watcher, dirPath, 0);
+}
+
+void WatchTree(Watcher *watcher, char *path, char *name) {
+
+    //Variable declarations.
+    char          childPath[LINE_SIZE];
+    int           wd;
+    int           index;
+    DIR           *dir;
+    struct dirent *entry;
+
+    wd = inotify_add_watch(watcher->fd, path, WATCH_EVENTS | IN_ONLYDIR);
+
+    //Check if the directory was watched.
+    if (wd < 0) {
+
+        //A directory that went away meanwhile needs no watch.
+        if (errno == ENOENT || errno == ENOTDIR) {
+
+            return;
+        }
+
+        perror("Error: inotify_add_watch failed.\n");
+        exit(1);
+    }
+
+    //Check if the directory is watched already, with everything below it.
+    for (index = 0; index < watcher->dirCount; index++) {
+
+        if (watcher->dirs[index].wd == wd) {
+
+            return;
+        }
+    }
+
+    //Check if the list is full.
+    if (watcher->dirCount == watcher->dirCapacity) {
+
+        watcher->dirCapacity = watcher->dirCapacity == 0 ? 64 :
+                               watcher->dirCapacity * 2;
+        watcher->dirs        = (WatchedDir *) realloc(watcher->dirs,
+                                                      watcher->dirCapacity *
+                                                      sizeof(WatchedDir));
+
+        //Check if allocation worked.
+        if (watcher->dirs == 0) {
+
+            perror("Error: realloc failed.\n");
+            exit(1);
+        }
+    }
+
+    watcher->dirs[watcher->dirCount].wd   = wd;
+    watcher->dirs[watcher->dirCount].path = strdup(path);
+    watcher->dirs[watcher->dirCount].name = name != 0 ? strdup(name) : 0;
+    watcher->dirCount++;
+
+    dir = opendir(path);
+
+    //A directory that went away meanwhile has nothing below it.
+    if (dir == 0) {
+
+        return;
+    }
+
+    while ((entry = readdir(dir)) != 0) {
+
+        //Ignore inner directories.
+        if (strcmp(entry->d_name, ".") == 0 ||
+            strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        //Check that the path fits.
+        if (snprintf(childPath, LINE_SIZE, "%s/%s", path, entry->d_name) >=
+            LINE_SIZE) {
+            continue;
+        }
+
+        //Check if the entry is left over from an archive tool.
+        if (IsJunkEntry(entry->d_name, entry->d_type)) {
+            continue;
+        }
+
+        //Every directory of the main one is a student of its own.
+        if (IsEntryDirectory(childPath, entry->d_type)) {
+
+            WatchTree(watcher, childPath, name != 0 ? name : entry->d_name);
+        }
+    }
+
+    closedir(dir);
+}
+
+void ReadWatchEvents(Watcher *watcher, char *dirPath) {
+
+    //Variable declarations.
+    char                 buffer[WATCH_BUFFER_SIZE]
+            __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    char                 path[LINE_SIZE];
+    char                 *name;
+    ssize_t              length;
+    ssize_t              offset;
+    int                  index;
+    DIR                  *dir;
+    struct dirent        *entry;
+    struct inotify_event *event;
+
+    length = read(watcher->fd, buffer, WATCH_BUFFER_SIZE);
+
+    //Check if the events were read.
+    if (length < 0) {
+
+        if (errno == EAGAIN || errno == EINTR) {
+
+            return;
+        }
+
+        perror("Error: failed to read watch events.\n");
+        exit(1);
+    }
+
+    for (offset = 0; offset < length;
+         offset += sizeof(struct inotify_event) + event->len) {
+
+        event = (struct inotify_event *) (buffer + offset);
+
+        //Check if events were lost, then any student may have changed.
+        if (event->mask & IN_Q_OVERFLOW) {
+
+            dir = opendir(dirPath);
+
+            //Check if directory was opened.
+            if (dir == 0) {
+
+                perror("Error: failed to open directory.\n");
+                exit(1);
+            }
+
+            while ((entry = readdir(dir)) != 0) {
+
+                if (IsJunkEntry(entry->d_name, entry->d_type)) {
+                    continue;
+                }
+
+                //Watch the students that arrived unseen.
+                if (snprintf(path, LINE_SIZE, "%s/%s", dirPath,
+                             entry->d_name) < LINE_SIZE) {
+
+                    WatchTree(watcher, path, entry->d_name);
+                }
+
+                NoteChange(watcher, entry->d_name);
+            }
+
+            closedir(dir);
+            continue;
+        }
+
+        //Find the directory of the event.
+        for (index = 0; index < watcher->dirCount; index++) {
+
+            if (watcher->dirs[index].wd == event->wd) {
+                break;
+            }
+        }
+
+        if (index == watcher->dirCount) {
+            continue;
+        }
+
+        //Check if the directory is gone.
+        if (event->mask & IN_IGNORED) {
+
+            watcher->dirs[index].wd = -1;
+            continue;
+        }
+
+        //In the main directory only the students' own directories count.
+        name = watcher->dirs[index].name;
+
+        //A student hands in a directory or an archive.
+        if (name == 0 &&
+            (event->len == 0 || IsJunkEntry(event->name, DT_UNKNOWN) ||
+             (!(event->mask & IN_ISDIR) &&
+              ArchiveSuffixLength(event->name) == 0))) {
+            continue;
+        }
+
+        //A new directory gets watched with everything already in it.
+        if ((event->mask & IN_ISDIR) &&
+            (event->mask & (IN_CREATE | IN_MOVED_TO)) &&
+            snprintf(path, LINE_SIZE, "%s/%s", watcher->dirs[index].path,
+                     event->name) < LINE_SIZE) {
+
+            WatchTree(watcher, path, name != 0 ? name : event->name);
+        }
+
+        NoteChange(watcher, name != 0 ? name : event->name);
+    }
+}
+
+void NoteChange(Watcher *watcher, char *name) {
+
+    //Variable declarations.
+    int index;
+
+    //Check if the student is waiting already.
+    for (index = 0; index < watcher->changeCount; index++) {
+
+        if (strcmp(watcher->changes[index].name, name) == 0) {
+
+            watcher->changes[index].lastChange = NowMicros();
+
+            return;
+        }
+    }
+
+    //Check if the list is full.
+    if (watcher->changeCount == watcher->changeCapacity) {
+
+        watcher->changeCapacity = watcher->changeCapacity == 0 ? 64 :
+                                  watcher->changeCapacity * 2;
+        watcher->changes        = (Change *) realloc(watcher->changes,
+                                                     watcher->changeCapacity *
+                                                     sizeof(Change));
+
+        //Check if allocation worked.
+        if (watcher->changes == 0) {
+
+            perror("Error: realloc failed.\n");
+            exit(1);
+        }
+    }
+
+    watcher->changes[watcher->changeCount].name       = strdup(name);
+    watcher->changes[watcher->changeCount].lastChange = NowMicros();
+    watcher->changeCount++;
+}
+
+void WatchStudents(Watcher *watcher, Options *options, Stats *stats,
+                   StudentList *students, StudentList *unfound,
+                   Journal *journal) {
+
+    //Variable declarations.
+    char                    path[LINE_SIZE];
+    char                    *name;
+    int                     index;
+    int                     timeout;
+    int                     isStopped = 0;
+    int                     isChanged;
+    long long               now;
+    long long               wait;
+    LineReader              precheck;
+    StudentList             batch     = {0, 0, 0};
+    Student                 *student;
+    struct pollfd           pollFds[2];
+    struct signalfd_siginfo signalInfo;
+
+    //The rounds are too small for a syntax pre-check.
+    precheck.fd     = -1;
+    precheck.length = 0;
+
+    pollFds[0].fd     = watcher->fd;
+    pollFds[0].events = POLLIN;
+    pollFds[1].fd     = watcher->signalFd;
+    pollFds[1].events = POLLIN;
+
+    while (!isStopped) {
+
+        now     = NowMicros();
+        timeout = -1;
+
+        //Sleep until the next waiting student's files settle.
+        for (index = 0; index < watcher->changeCount; index++) {
+
+            wait = watcher->changes[index].lastChange +
+                   options->watchDebounce - now;
+            wait = wait > 0 ? wait / 1000 + 1 : 0;
+
+            if (timeout < 0 || wait < timeout) {
+
+                timeout = (int) wait;
+            }
+        }
+
+        //The ending signals wait in the signal descriptor while blocked. A
+        //signal during a round ends the run, and a resumed run goes on.
+        sigprocmask(SIG_BLOCK, &watcher->signals, 0);
+
+        //Check if waiting failed.
+        if (poll(pollFds, 2, timeout) < 0 && errno != EINTR) {
+
+            perror("Error: poll failed.\n");
+            exit(1);
+        }
+
+        //Check if the watch should end.
+        if (pollFds[1].revents & POLLIN) {
+
+            if (read(watcher->signalFd, &signalInfo, sizeof(signalInfo)) > 0) {
+
+                isStopped = 1;
+            }
+        }
+
+        if (pollFds[0].revents & POLLIN) {
+
+            ReadWatchEvents(watcher, options->dirPath);
+        }
+
+        sigprocmask(SIG_UNBLOCK, &watcher->signals, 0);
+
+        if (isStopped) {
+            break;
+        }
+
+        now       = NowMicros();
+        isChanged = 0;
+
+        //Take the students whose files settled.
+        for (index = 0; index < watcher->changeCount; index++) {
+
+            if (now - watcher->changes[index].lastChange <
+                options->watchDebounce) {
+                continue;
+            }
+
+            name                     = watcher->changes[index].name;
+            watcher->changes[index]  = watcher->changes[--watcher->changeCount];
+            index--;
+
+            //A student that was removed keeps the last result.
+            if (snprintf(path, LINE_SIZE, "%s/%s", options->dirPath, name) >=
+                LINE_SIZE || access(path, F_OK) < 0) {
+
+                free(name);
+                continue;
+            }
+
+            student = InitStudent(name, options->dirPath);
+            free(name);
+
+            //The new result takes the old one's place.
+            RemoveStudent(students, student->name);
+            RemoveStudent(unfound, student->name);
+            ForgetJournalName(journal, student->name);
+
+            stats->discovered++;
+            stats->regraded++;
+            isChanged = 1;
+
+            if (LocateStudent(student, options, stats, unfound)) {
+
+                AddStudent(&batch, student);
+            }
+        }
+
+        if (!isChanged) {
+            continue;
+        }
+
+        stats->pending = batch.count;
+
+        //Grade the round on the workers.
+        if (options->workers > 0) {
+
+            RunCoordinator(&batch, options, stats, &precheck);
+
+        } else {
+
+            for (index = 0; index < batch.count; index++) {
+
+                stats->pending--;
+                FinishStudent(batch.items[index],
+                              GradeStudent(batch.items[index], options),
+                              stats);
+            }
+        }
+
+        for (index = 0; index < batch.count; index++) {
+
+            AddStudent(students, batch.items[index]);
+        }
+
+        batch.count = 0;
+
+        //Put every student's new line where the old one was.
+        RewriteResultLines(options->resultsPath, 0);
+        RewriteResultLines(options->journalPath, 1);
+
+        WriteStats(stats, 1);
+        WriteResultsStore(students, unfound, journal, options->storePath);
+    }
+
+    free(batch.items);
+}
+
+void StopWatch(Watcher *watcher) {
+
+    //Variable declarations.
+    int index;
+
+    for (index = 0; index < watcher->dirCount; index++) {
+
+        free(watcher->dirs[index].path);
+        free(watcher->dirs[index].name);
+    }
+
+    for (index = 0; index < watcher->changeCount; index++) {
+
+        free(watcher->changes[index].name);
+    }
+
+    free(watcher->dirs);
+    free(watcher->changes);
+    close(watcher->fd);
+    close(watcher->signalFd);
+}
+
+void RemoveStudent(StudentList *list, char *name) {
+
+    //Variable declarations.
+    int index;
+
+    for (index = 0; index < list->count; index++) {
+
+        if (strcmp(list->items[index]->name, name) == 0) {
+
+            FreeStudent(list->items[index]);
+
+            //Keep the order of the rest.
+            memmove(&list->items[index], &list->items[index + 1],
+                    (list->count - index - 1) * sizeof(Student *));
+            list->count--;
+
+            return;
+        }
+    }
+}
+
+void ForgetJournalName(Journal *journal, char *name) {
+
+    //Variable declarations.
+    char **found;
+
+    //Check if there is anything to search.
+    if (journal->count == 0) {
+
+        return;
+    }
+
+    found = (char **) bsearch(&name, journal->names, (size_t) journal->count,
+                              sizeof(char *), CompareNames);
+
+    if (found != 0) {
+
+        memmove(found, found + 1,
+                (journal->names + journal->count - found - 1) *
+                sizeof(char *));
+        journal->count--;
+    }
+}
+
+void RewriteResultLines(char *path, int isSynced) {
+
+    //Variable declarations.
+    char       tempPath[LINE_SIZE];
+    char       *content;
+    char       *line;
+    char       *end;
+    int        count    = 0;
+    int        kept     = 0;
+    int        isFailed = 0;
+    int        start;
+    int        index;
+    int        file;
+    size_t     size;
+    ResultLine *lines;
+
+    content = ReadWholeFile(path, &size);
+    lines   = (ResultLine *) malloc((size / 2 + 1) * sizeof(ResultLine));
+
+    //Check if allocation worked.
+    if (lines == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+
+    //Only complete lines count, a torn last line is dropped.
+    for (line = content; (end = strchr(line, '\n')) != 0; line = end + 1) {
+
+        *end = '\0';
+
+        if (end == line) {
+            continue;
+        }
+
+        lines[count].line       = line;
+        lines[count].nameLength = strcspn(line, ",");
+        lines[count].position   = count;
+        count++;
+    }
+
+    //Every student's last line moves to the place of the first.
+    qsort(lines, (size_t) count, sizeof(ResultLine), CompareResultLines);
+
+    for (start = 0; start < count; start = index) {
+
+        index = start + 1;
+
+        //Find the end of the student's lines.
+        while (index < count &&
+               lines[index].nameLength == lines[start].nameLength &&
+               memcmp(lines[index].line, lines[start].line,
+                      lines[start].nameLength) == 0) {
+
+            index++;
+        }
+
+        lines[kept].line     = lines[index - 1].line;
+        lines[kept].position = lines[start].position;
+        kept++;
+    }
+
+    qsort(lines, (size_t) kept, sizeof(ResultLine), CompareLinePositions);
+
+    sprintf(tempPath, "%s.tmp", path);
+    file = open(tempPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+
+    //Check if the file was opened.
+    if (file < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    for (index = 0; index < kept; index++) {
+
+        isFailed |= WriteToFile(file, lines[index].line);
+        isFailed |= WriteToFile(file, "\n");
+    }
+
+    //Check if the lines were written, else the old file stays.
+    if (isFailed) {
+
+        fprintf(stderr, "Warning: failed to rewrite %s.\n", path);
+        close(file);
+        unlink(tempPath);
+        free(lines);
+        free(content);
+
+        return;
+    }
+
+    //Check if the lines reached the disk.
+    if (isSynced && fsync(file) < 0) {
+
+        perror("Error: failed to sync file.\n");
+        exit(1);
+    }
+
+    //Check if the file was closed.
+    if (close(file) < 0) {
+
+        perror("Error: failed to close file.\n");
+        exit(1);
+    }
+
+    //Readers see either the old file or the new one.
+    if (rename(tempPath, path) < 0) {
+
+        perror("Error: failed to rename file.\n");
+        exit(1);
+    }
+
+    free(lines);
+    free(content);
+}
+
+int CompareResultLines(const void *first, const void *second) {
+
+    //Variable declarations.
+    ResultLine *line1 = (ResultLine *) first;
+    ResultLine *line2 = (ResultLine *) second;
+    size_t     length;
+    int        order;
+
+    length = line1->nameLength < line2->nameLength ? line1->nameLength :
+             line2->nameLength;
+    order  = memcmp(line1->line, line2->line, length);
+
+    if (order != 0) {
+
+        return order;
+    }
+
+    if (line1->nameLength != line2->nameLength) {
+
+        return line1->nameLength < line2->nameLength ? -1 : 1;
+    }
+
+    return line1->position - line2->position;
+}
+
+int CompareLinePositions(const void *first, const void *second) {
+
+    return ((ResultLine *) first)->position -
+           ((ResultLine *) second)->position;
+}
+
+void OpenDirLister(DirLister *lister, char *path) {
+
+    lister->fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    //Check if the directory was opened.
+    if (lister->fd < 0) {
+
+        perror("Error: failed to open directory.\n");
+        exit(1);
+    }
+
+    lister->buffer = (char *) malloc(DIRENT_BUFFER_SIZE);
+    lister->names  = (char **) malloc((DIRENT_BUFFER_SIZE / DIRENT_MIN_SIZE) *
+                                      sizeof(char *));
+
+    //Check if allocation worked.
+    if (lister->buffer == 0 || lister->names == 0) {
+
+        perror("Error: malloc failed.\n");
+        exit(1);
+    }
+}
+
+int ReadEntryBatch(DirLister *lister) {
+
+    //Variable declarations.
+    long        length;
+    long        offset;
+    int         count = 0;
+    LinuxDirent *entry;
+
+    //A buffer of junk alone is no reason to stop.
+    while (count == 0) {
+
+        length = syscall(SYS_getdents64, lister->fd, lister->buffer,
+                         DIRENT_BUFFER_SIZE);
+
+        //Check if read from directory.
+        if (length < 0) {
+
+            perror("Error: failed to read from directory.\n");
+            exit(1);
+        }
+
+        //Check if reached the end of the directory.
+        if (length == 0) {
+            break;
+        }
+
+        for (offset = 0; offset < length; offset += entry->length) {
+
+            entry = (LinuxDirent *) (lister->buffer + offset);
+
+            if (!IsJunkEntry(entry->name, entry->type)) {
+
+                lister->names[count++] = entry->name;
+            }
+        }
+    }
+
+    return count;
+}
+
+void CloseDirLister(DirLister *lister) {
+
+    //Check if directory was closed.
+    if (close(lister->fd) < 0) {
+
+        perror("Error: failed to close directory.\n");
+        exit(1);
+    }
+
+    free(lister->buffer);
+    free(lister->names);
+}
+
+int IsJunkEntry(char *name, unsigned char type) {
+
+    //Check if the entry is the directory itself or its parent.
+    if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+
+        return 1;
+    }
+
+    //Check if the entry is an archive tool's metadata directory.
+    if (strcmp(name, "__MACOSX") == 0) {
+
+        return type == DT_DIR || type == DT_UNKNOWN;
+    }
+
+    //Check if the entry is a resource fork or a folder settings file.
+    if (strncmp(name, "._", 2) == 0 || strcmp(name, ".DS_Store") == 0) {
+
+        return type == DT_REG || type == DT_UNKNOWN;
+    }
+
+    return 0;
+}
+
+int IsEntryDirectory(char *path, unsigned char type) {
+
+    //A link is a directory if what it points to is one.
+    if (type == DT_UNKNOWN || type == DT_LNK) {
+
+        return IsDirectory(path);
+    }
+
+    return type == DT_DIR;
+}
+
+int ArchiveSuffixLength(char *name) {
+
+    //Variable declarations.
+    static char *suffixes[] = {".tar.gz", ".tgz", ".tar", ".zip", 0};
+    size_t      length      = strlen(name);
+    size_t      suffixLength;
+    int         index;
+
+    for (index = 0; suffixes[index] != 0; index++) {
+
+        suffixLength = strlen(suffixes[index]);
+
+        //The name must be more than the extension.
+        if (length > suffixLength &&
+            strcmp(name + length - suffixLength, suffixes[index]) == 0) {
+
+            return (int) suffixLength;
+        }
+    }
+
+    return 0;
+}
+
+int ArchivePathLength(char *path) {
+
+    //Variable declarations.
+    char        prefix[MAX_SIZE];
+    char        *slash;
+    size_t      length;
+    struct stat archiveStat;
+
+    for (slash = strchr(path, '/'); slash != 0; slash = strchr(slash + 1, '/')) {
+
+        length = (size_t) (slash - path);
+
+        //Check if the directory is named like an archive.
+        if (length == 0 || length >= MAX_SIZE) {
+            continue;
         }
 
-        //Copy next name.
-        strcpy(finalPath, nextFile);
+        memcpy(prefix, path, length);
+        prefix[length] = '\0';
+
+        if (ArchiveSuffixLength(prefix) > 0 && stat(prefix, &archiveStat) == 0 &&
+            S_ISREG(archiveStat.st_mode)) {
+
+            return (int) length;
+        }
     }
+
+    return 0;
 }
 
-void HandleNoCFile(Student *student) {
+int ListArchive(char *path, Archive *archive) {
 
-    //Set student's grade tp 0.
-    student->result.grade = 0;
+    //Variable declarations.
+    int file;
+    int retVal;
 
-    //Set the reason for the grade.
-    if (student->isMultipleDirectories) {
+    archive->members  = 0;
+    archive->count    = 0;
+    archive->capacity = 0;
 
-        strcat(student->result.feedback, ",MULTIPLE_DIRECTORIES");
+    //Check if the archive is a tar, which may be compressed.
+    if (strcmp(path + strlen(path) - 4, ".zip") != 0) {
 
-    } else {
+        archive->type = ARCHIVE_TAR;
 
-        strcat(student->result.feedback, ",NO_C_FILE");
+        return ListTar(path, archive);
+    }
+
+    archive->type = ARCHIVE_ZIP;
+    file          = open(path, O_RDONLY | O_CLOEXEC);
+
+    //Check if the archive was opened.
+    if (file < 0) {
+
+        perror(path);
+        return -1;
     }
+
+    retVal = ListZip(file, archive);
+    close(file);
+
+    return retVal;
 }
 
-int IsDirectory(char *path) {
+int ListZip(int file, Archive *archive) {
 
-    struct stat pathStat;
-    stat(path, &pathStat);
+    //Variable declarations.
+    unsigned char *tail;
+    unsigned char *directory;
+    unsigned char *entry;
+    long long     tailSize;
+    long long     directorySize;
+    long long     directoryOffset;
+    long long     position;
+    int           entries;
+    int           index;
+    size_t        nameLength;
+    struct stat   zipStat;
+
+    //Check the archive's size.
+    if (fstat(file, &zipStat) < 0 || zipStat.st_size < ZIP_END_SIZE) {
+
+        return -1;
+    }
 
-    return S_ISDIR(pathStat.st_mode);
+    //The end record is somewhere in the last bytes, before the comment.
+    tailSize = zipStat.st_size < ZIP_END_SIZE + ZIP_MAX_COMMENT ?
+               zipStat.st_size : ZIP_END_SIZE + ZIP_MAX_COMMENT;
+    tail     = (unsigned char *) malloc((size_t) tailSize);
+
+    //Check if allocation worked.
+    if (tail == 0) {
+
+        return -1;
+    }
+
+    //Check if the end of the archive was read.
+    if (pread(file, tail, (size_t) tailSize, zipStat.st_size - tailSize) !=
+        tailSize) {
+
+        free(tail);
+        return -1;
+    }
+
+    for (position = tailSize - ZIP_END_SIZE; position >= 0; position--) {
+
+        if (ReadLittleEndian(tail + position, 4) == 0x06054b50) {
+            break;
+        }
+    }
+
+    //Check if the end record was found.
+    if (position < 0) {
+
+        free(tail);
+        return -1;
+    }
+
+    entries         = (int) ReadLittleEndian(tail + position + 10, 2);
+    directorySize   = (long long) ReadLittleEndian(tail + position + 12, 4);
+    directoryOffset = (long long) ReadLittleEndian(tail + position + 16, 4);
+    free(tail);
+
+    //Check that the central directory is inside the archive.
+    if (directoryOffset + directorySize > zipStat.st_size) {
+
+        return -1;
+    }
+
+    //Read the whole central directory at once.
+    directory = (unsigned char *) malloc((size_t) directorySize + 1);
+
+    //Check if allocation worked.
+    if (directory == 0) {
+
+        return -1;
+    }
+
+    if (pread(file, directory, (size_t) directorySize, directoryOffset) !=
+        directorySize) {
+
+        free(directory);
+        return -1;
+    }
+
+    position = 0;
+
+    for (index = 0; index < entries; index++) {
+
+        entry = directory + position;
+
+        //Check that the entry is whole.
+        if (position + ZIP_ENTRY_SIZE > directorySize ||
+            ReadLittleEndian(entry, 4) != 0x02014b50) {
+
+            free(directory);
+            return -1;
+        }
+
+        nameLength = (size_t) ReadLittleEndian(entry + 28, 2);
+
+        if (position + ZIP_ENTRY_SIZE + (long long) nameLength >
+            directorySize) {
+
+            free(directory);
+            return -1;
+        }
+
+        //A directory's name ends with a slash.
+        AddArchiveMember(archive, (char *) entry + ZIP_ENTRY_SIZE, nameLength,
+                         nameLength > 0 &&
+                         entry[ZIP_ENTRY_SIZE + nameLength - 1] == '/',
+                         (long long) ReadLittleEndian(entry + 42, 4),
+                         (long long) ReadLittleEndian(entry + 20, 4),
+                         (int) ReadLittleEndian(entry + 10, 2));
+
+        position += ZIP_ENTRY_SIZE + nameLength +
+                    ReadLittleEndian(entry + 30, 2) +
+                    ReadLittleEndian(entry + 32, 2);
+    }
+
+    free(directory);
+
+    return 0;
 }
 
-int IsCFile(char *path) {
+int ListTar(char *path, Archive *archive) {
 
     //Variable declarations.
-    int length;
+    char      header[TAR_BLOCK];
+    char      name[LINE_SIZE];
+    char      longName[LINE_SIZE];
+    int       isLongName = 0;
+    int       index;
+    long long size;
+    long long checksum;
+    long long sum;
+    gzFile    tar;
+
+    //gzread reads a plain tar as it is.
+    tar = gzopen(path, "rb");
+
+    //Check if the archive was opened.
+    if (tar == 0) {
+
+        perror(path);
+        return -1;
+    }
 
-    length = strlen(path);
+    while (gzread(tar, header, TAR_BLOCK) == TAR_BLOCK) {
 
-    //Check if is a C file.
-    if (length > 2 && path[length - 1] == 'c' && path[length - 2] == '.') {
+        //Check if reached the empty blocks at the end.
+        if (header[0] == '\0') {
+            break;
+        }
 
-        return 1;
+        //The checksum counts its own field as spaces.
+        checksum = ReadOctal(header + 148, 8);
+        sum      = 0;
+
+        for (index = 0; index < TAR_BLOCK; index++) {
+
+            sum += index >= 148 && index < 156 ? ' ' :
+                   (unsigned char) header[index];
+        }
+
+        size = ReadOctal(header + 124, 12);
+
+        //Check that the header is whole.
+        if (checksum != sum || size < 0) {
+
+            gzclose(tar);
+            return -1;
+        }
+
+        //A long name comes as the data of its own header.
+        if (header[156] == 'L') {
+
+            if (size >= LINE_SIZE ||
+                gzread(tar, longName, (unsigned) size) != size ||
+                gzseek(tar, (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK,
+                       SEEK_CUR) < 0) {
+
+                gzclose(tar);
+                return -1;
+            }
+
+            longName[size] = '\0';
+            isLongName     = 1;
+            continue;
+        }
+
+        //A ustar name may be split into a prefix and a name.
+        if (isLongName) {
+
+            strcpy(name, longName);
+
+        } else if (header[345] != '\0') {
+
+            sprintf(name, "%.155s/%.100s", header + 345, header);
+
+        } else {
+
+            sprintf(name, "%.100s", header);
+        }
+
+        isLongName = 0;
+
+        //A file this big is not a C file, and skipping it would inflate it.
+        if (header[156] != '5' && size > ARCHIVE_MAX_SOURCE) {
+
+            fprintf(stderr, "Error: %s holds a file of %lld bytes.\n", path,
+                    size);
+            gzclose(tar);
+            return -1;
+        }
+
+        //Keep only the files and the directories.
+        if (header[156] == '0' || header[156] == '\0' || header[156] == '5') {
+
+            AddArchiveMember(archive, name, strlen(name), header[156] == '5',
+                             (long long) gztell(tar), size, 0);
+        }
+
+        //Check if skipped the data.
+        if (gzseek(tar, (size + TAR_BLOCK - 1) / TAR_BLOCK * TAR_BLOCK,
+                   SEEK_CUR) < 0) {
+
+            gzclose(tar);
+            return -1;
+        }
     }
 
+    gzclose(tar);
+
     return 0;
 }
 
-void WriteToFile(int file, char *message) {
+void AddArchiveMember(Archive *archive, char *name, size_t length,
+                      int isDirectory, long long offset, long long size,
+                      int method) {
 
     //Variable declarations.
-    int bytesWrote;
+    ArchiveMember *member;
 
-    bytesWrote = write(file, message, strlen(message));
+    //Drop the leading ./ and the trailing slash.
+    while (length >= 2 && name[0] == '.' && name[1] == '/') {
 
-    //Check that the message was written.
-    if (bytesWrote < 0) {
+        name   += 2;
+        length -= 2;
+    }
 
-        perror("Error: failed to write to file.\n");
-        exit(1);
+    while (length > 0 && name[length - 1] == '/') {
+
+        length--;
+    }
+
+    //Check if the entry is the archive's root.
+    if (length == 0) {
+
+        return;
     }
+
+    //Check if the list is full.
+    if (archive->count == archive->capacity) {
+
+        archive->capacity = archive->capacity == 0 ? 64 :
+                            archive->capacity * 2;
+        archive->members  = (ArchiveMember *) realloc(archive->members,
+                                                      archive->capacity *
+                                                      sizeof(ArchiveMember));
+
+        //Check if allocation worked.
+        if (archive->members == 0) {
+
+            perror("Error: realloc failed.\n");
+            exit(1);
+        }
+    }
+
+    member              = &archive->members[archive->count++];
+    member->name        = strndup(name, length);
+    member->isDirectory = isDirectory;
+    member->offset      = offset;
+    member->size        = size;
+    member->method      = method;
 }
 
-void ReadFromFile(int fileDesc, char *buffer) {
+void FreeArchive(Archive *archive) {
 
     //Variable declarations.
-    int counter = 0;
-    int stop    = 0;
-    int readNum = 0;
+    int index;
 
-    //Loop until end of file.
-    while (!stop) {
+    for (index = 0; index < archive->count; index++) {
 
-        readNum = read(fileDesc, &buffer[counter], 1);
+        free(archive->members[index].name);
+    }
 
-        //Check if read succeeded.
-        if (readNum < 0) {
+    free(archive->members);
+}
+
+char *FindArchiveCFile(char *archivePath, Student *student) {
+
+    //Variable declarations.
+    char    prefix[MAX_SIZE] = "";
+    char    child[MAX_SIZE];
+    char    nextDir[MAX_SIZE];
+    char    *rest;
+    char    *slash;
+    char    *cFilePath;
+    int     index;
+    int     dirCounter;
+    int     found;
+    size_t  prefixLength = 0;
+    size_t  childLength;
+    Archive archive;
+
+    //Check if the archive could be read, else only this student fails.
+    if (ListArchive(archivePath, &archive) < 0) {
+
+        fprintf(stderr, "Error: failed to read archive %s.\n", archivePath);
+        student->isInternalError = 1;
+
+        return 0;
+    }
+
+    //The archive's root is the student's directory.
+    student->depth = 0;
+
+    while (1) {
+
+        dirCounter = 0;
+        found      = -1;
+
+        //Find the entries right below the current directory.
+        for (index = 0; index < archive.count && found < 0; index++) {
+
+            rest = archive.members[index].name + prefixLength;
+
+            if (strncmp(archive.members[index].name, prefix, prefixLength) !=
+                0 || *rest == '\0') {
+                continue;
+            }
+
+            //Anything deeper makes its first directory a child too.
+            slash       = strchr(rest, '/');
+            childLength = slash != 0 ? (size_t) (slash - rest) : strlen(rest);
+
+            if (childLength >= MAX_SIZE) {
+                continue;
+            }
+
+            memcpy(child, rest, childLength);
+            child[childLength] = '\0';
+
+            //Ignore what archive tools left.
+            if (IsJunkEntry(child, slash != 0 ||
+                                   archive.members[index].isDirectory ?
+                                   DT_DIR : DT_REG)) {
+                continue;
+            }
+
+            if (slash == 0 && !archive.members[index].isDirectory) {
+
+                //Check if found the C file.
+                if (IsCFile(child)) {
+
+                    found = index;
+                }
+
+                continue;
+            }
+
+            //Count every directory once.
+            if (dirCounter == 0) {
+
+                strcpy(nextDir, child);
+                dirCounter = 1;
+
+            } else if (strcmp(nextDir, child) != 0) {
+
+                dirCounter = 2;
+            }
+        }
+
+        //Check if found the C file.
+        if (found >= 0) {
+
+            cFilePath = (char *) malloc(strlen(archivePath) +
+                                        strlen(archive.members[found].name) +
+                                        2);
+
+            //Check if allocation worked.
+            if (cFilePath == 0) {
+
+                student->isInternalError = 1;
+
+            } else {
+
+                sprintf(cFilePath, "%s/%s", archivePath,
+                        archive.members[found].name);
+            }
+
+            FreeArchive(&archive);
+
+            return cFilePath;
+        }
+
+        //Stop searching if more that on inner folder exists.
+        if (dirCounter > 1) {
+
+            student->isMultipleDirectories = 1;
+        }
+
+        //Check that the path fits.
+        if (dirCounter == 1 &&
+            prefixLength + strlen(nextDir) + 2 > MAX_SIZE) {
+
+            fprintf(stderr, "Error: path too long in %s.\n", student->name);
+            student->isInternalError = 1;
+            dirCounter               = 0;
+        }
+
+        if (dirCounter != 1) {
+
+            FreeArchive(&archive);
+
+            return 0;
+        }
+
+        //Go down into the only directory.
+        strcat(prefix, nextDir);
+        strcat(prefix, "/");
+        prefixLength = strlen(prefix);
+        student->depth++;
+    }
+}
+
+int OpenSourceFile(char *path) {
+
+    //Variable declarations.
+    char    archivePath[MAX_SIZE];
+    char    *memberName;
+    int     archiveLength;
+    int     sourceFile;
+    int     index;
+    Archive archive;
+
+    archiveLength = ArchivePathLength(path);
+
+    //Check if the C file is a plain file.
+    if (archiveLength == 0) {
+
+        return open(path, O_RDONLY | O_CLOEXEC);
+    }
+
+    memcpy(archivePath, path, (size_t) archiveLength);
+    archivePath[archiveLength] = '\0';
+    memberName                 = path + archiveLength + 1;
+
+    //Check if the archive could be read.
+    if (ListArchive(archivePath, &archive) < 0) {
+
+        return -1;
+    }
+
+    sourceFile = memfd_create("source.c", MFD_CLOEXEC);
+
+    //Check if the memory file was created.
+    if (sourceFile < 0) {
+
+        perror("Error: memfd_create failed.\n");
+        FreeArchive(&archive);
+
+        return -1;
+    }
+
+    for (index = 0; index < archive.count; index++) {
+
+        if (!archive.members[index].isDirectory &&
+            strcmp(archive.members[index].name, memberName) == 0) {
+            break;
+        }
+    }
+
+    //Check that the C file was unpacked, then read it from the start.
+    if (index == archive.count ||
+        ExtractMember(archivePath, &archive, &archive.members[index],
+                      sourceFile) < 0 ||
+        lseek(sourceFile, 0, SEEK_SET) < 0) {
+
+        fprintf(stderr, "Error: failed to unpack %s.\n", path);
+        close(sourceFile);
+        sourceFile = -1;
+    }
+
+    FreeArchive(&archive);
+
+    return sourceFile;
+}
+
+int OpenStudentSource(Student *student) {
+
+    //Variable declarations.
+    char sourcePath[32];
+
+    //Check if the C file was not unpacked.
+    if (student->sourceFile < 0) {
+
+        return OpenSourceFile(student->cFilePath);
+    }
+
+    sprintf(sourcePath, "/proc/self/fd/%d", student->sourceFile);
+
+    return open(sourcePath, O_RDONLY | O_CLOEXEC);
+}
+
+void RaiseFileLimit(void) {
+
+    //Variable declarations.
+    struct rlimit fileLimit;
 
-            perror("Error occurred while reading from file.\n");
-            exit(1);
-        }
+    //Check if the limit can be raised.
+    if (getrlimit(RLIMIT_NOFILE, &fileLimit) < 0 ||
+        fileLimit.rlim_cur == fileLimit.rlim_max) {
+        return;
+    }
 
-        //Check if there if a need to stop.
-        if ((readNum == 0) || (buffer[counter] == '\n')) {
+    fileLimit.rlim_cur = fileLimit.rlim_max;
 
-            buffer[counter] = '\0';
-            stop = 1;
-        }
+    //Check if the limit was raised, else only the big cohorts notice.
+    if (setrlimit(RLIMIT_NOFILE, &fileLimit) < 0) {
 
-        counter++;
+        fprintf(stderr, "Warning: failed to raise the open files limit.\n");
     }
 }
 
-int CompileStudentFile(Student *student) {
+int ExtractMember(char *archivePath, Archive *archive, ArchiveMember *member,
+                  int outFile) {
 
     //Variable declarations.
-    pid_t compilePId;
+    unsigned char header[ZIP_LOCAL_SIZE];
+    unsigned char input[HASH_BUFFER_SIZE];
+    unsigned char output[HASH_BUFFER_SIZE];
+    int           file;
+    int           result    = Z_OK;
+    int           retVal    = 0;
+    long long     offset;
+    long long     left;
+    long long     written   = 0;
+    ssize_t       readNum;
+    gzFile        tar;
+    z_stream      stream;
+
+    //A C file this big is not a C file, it is a zip bomb.
+    if (member->size > ARCHIVE_MAX_SOURCE) {
+
+        return -1;
+    }
 
-    compilePId = fork();
+    //A tar entry is stored as it is, gzread unpacks a .tar.gz around it.
+    if (archive->type == ARCHIVE_TAR) {
 
-    if (compilePId < 0) {
+        tar = gzopen(archivePath, "rb");
 
-        perror("Error: fork failed.\n");
-        exit(1);
-    }
+        //Check that the entry's data was reached.
+        if (tar == 0 || gzseek(tar, member->offset, SEEK_SET) < 0) {
 
-    if (compilePId == 0) {
+            if (tar != 0) {
 
-        char *args[] = {"gcc", student->cFilePath, "-o", "student.out", 0};
-        int  retExec;
+                gzclose(tar);
+            }
+
+            return -1;
+        }
 
-        retExec = execvp("gcc", args);
+        for (left = member->size; left > 0 && retVal == 0; left -= readNum) {
 
-        if (retExec == -1) {
+            readNum = gzread(tar, output, (unsigned) (left < HASH_BUFFER_SIZE ?
+                                                      left :
+                                                      HASH_BUFFER_SIZE));
 
-            perror("Error: execution failed.\n");
-            exit(1);
+            //Check that the data was read and written.
+            if (readNum <= 0 || write(outFile, output, (size_t) readNum) !=
+                                readNum) {
+
+                retVal = -1;
+            }
         }
-    } else {
 
-        return WaitForChildExec(&student->status.compileStatus);
+        gzclose(tar);
+
+        return retVal;
     }
-}
 
-int ExecuteStudentFile(Student *student, char *inputFilePath) {
+    file = open(archivePath, O_RDONLY | O_CLOEXEC);
 
-    //Variable declarations.
-    pid_t execPId;
+    //Check if the archive was opened.
+    if (file < 0) {
 
-    execPId = fork();
+        return -1;
+    }
 
-    //Check if fork succeeded.
-    if (execPId < 0) {
+    //The local header tells where the data starts.
+    if (pread(file, header, ZIP_LOCAL_SIZE, member->offset) != ZIP_LOCAL_SIZE ||
+        ReadLittleEndian(header, 4) != 0x04034b50 ||
+        (member->method != 0 && member->method != Z_DEFLATED)) {
 
-        perror("Error: fork failed.\n");
-        exit(1);
+        close(file);
+        return -1;
     }
 
-    if (execPId == 0) {
-
-        char *argsStudent[] = {"./student.out", inputFilePath,
-                               0};
+    offset = member->offset + ZIP_LOCAL_SIZE +
+             (long long) ReadLittleEndian(header + 26, 2) +
+             (long long) ReadLittleEndian(header + 28, 2);
 
-        //Variable declarations.
-        int  studentOutputFile;
-        int  inputFile;
-        int  execValue;
-        int  closeValue;
-        int  dupResult;
+    memset(&stream, 0, sizeof(z_stream));
 
-        studentOutputFile = open("studentOutput.txt",
-                                 O_CREAT | O_WRONLY, 777);
+    //Zip entries are raw deflate streams without a header.
+    if (member->method == Z_DEFLATED && inflateInit2(&stream, -MAX_WBITS) !=
+                                        Z_OK) {
 
-        //Check if studentOutputFile was opened.
-        if (studentOutputFile < 0) {
+        close(file);
+        return -1;
+    }
 
-            perror("Error: failed to open file.\n");
-            exit(1);
-        }
+    for (left = member->size; left > 0 && retVal == 0 &&
+                              result != Z_STREAM_END; left -= readNum) {
 
-        inputFile = open(inputFilePath, O_RDONLY);
+        readNum = pread(file, input, (size_t) (left < HASH_BUFFER_SIZE ?
+                                               left : HASH_BUFFER_SIZE),
+                        offset);
 
-        //Check if inputFile was opened.
-        if (inputFile < 0) {
+        //Check if read succeeded.
+        if (readNum <= 0) {
 
-            perror("Error: failed to open file.\n");
-            exit(1);
+            retVal = -1;
+            break;
         }
 
-        //Redirect input and output to files.
-        dupResult = dup2(inputFile, 0);
+        offset += readNum;
 
-        //Check if dup succeeded.
-        if (dupResult < 0) {
+        //Check if the data is stored as it is.
+        if (member->method == 0) {
 
-            perror("Error: dup2 failed.\n");
-            exit(1);
-        }
+            written += readNum;
 
-        dupResult = dup2(studentOutputFile, 1);
+            if (write(outFile, input, (size_t) readNum) != readNum) {
 
-        //Check if dup succeeded.
-        if (dupResult < 0) {
+                retVal = -1;
+            }
 
-            perror("Error: dup2 failed.\n");
-            exit(1);
+            continue;
         }
 
-        closeValue = close(studentOutputFile);
+        stream.next_in  = input;
+        stream.avail_in = (unsigned) readNum;
 
-        //Check if output file was closed.
-        if (closeValue < 0) {
+        //Inflate the whole chunk.
+        do {
 
-            perror("Error: failed to close file.\n");
-        }
+            stream.next_out  = output;
+            stream.avail_out = HASH_BUFFER_SIZE;
+            result           = inflate(&stream, Z_NO_FLUSH);
 
-        closeValue = close(inputFile);
+            //Check if the data is broken.
+            if (result != Z_OK && result != Z_STREAM_END) {
 
-        //Check if input file was closed.
-        if (closeValue < 0) {
+                retVal = -1;
+                break;
+            }
 
-            perror("Error: failed to close file.\n");
-        }
+            written += HASH_BUFFER_SIZE - stream.avail_out;
 
-        //Execute file.
-        execValue = execvp("./student.out", argsStudent);
+            //A C file this big is not a C file, it is a zip bomb.
+            if (written > ARCHIVE_MAX_SOURCE ||
+                write(outFile, output, HASH_BUFFER_SIZE - stream.avail_out) !=
+                (ssize_t) (HASH_BUFFER_SIZE - stream.avail_out)) {
 
-        //Check if execvp failed.
-        if (execValue == -1) {
+                retVal = -1;
+                break;
+            }
+        } while (stream.avail_out == 0 && result != Z_STREAM_END);
+    }
 
-            perror("Error: execution failed.\n");
-            exit(1);
+    //Check that a compressed entry ended where it should.
+    if (member->method == Z_DEFLATED) {
+
+        if (result != Z_STREAM_END) {
+
+            retVal = -1;
         }
-    } else {
 
-        //Variable declarations.
-        int exitStatus;
-        int timerStatus;
+        inflateEnd(&stream);
+    }
 
-        //Check for timeout.
-        student->isTimeOut = TimeoutHandler(execPId, &timerStatus);
+    close(file);
 
-        if (student->isTimeOut == 1) {
+    return retVal;
+}
 
-            //Wait for child process to finish.
-            return WaitForChildExec(&exitStatus);
+unsigned long long ReadLittleEndian(unsigned char *bytes, int size) {
 
-        } else {
+    //Variable declarations.
+    unsigned long long number = 0;
 
-            return 1;
-        }
+    while (size-- > 0) {
+
+        number = number << 8 | bytes[size];
     }
+
+    return number;
 }
 
-int CompareStudentFile(Student *student, char *correctOutput,
-                       char *studentOutput) {
+long long ReadOctal(char *field, int size) {
 
     //Variable declarations.
-    pid_t compPId;
+    long long number = 0;
+    int       index  = 0;
 
-    compPId = fork();
+    //Skip the padding before the digits.
+    while (index < size && field[index] == ' ') {
 
-    //Check if fork succeeded.
-    if(compPId == -1){
+        index++;
+    }
 
-        perror("Error: fork failed.\n");
-        exit(1);
+    //Check that there is a number.
+    if (index == size || field[index] < '0' || field[index] > '7') {
+
+        return -1;
     }
 
-    if (compPId == 0) {
+    while (index < size && field[index] >= '0' && field[index] <= '7') {
 
-        char *argsComp[] = {"./comp.out", correctOutput, studentOutput, 0};
-        int  compExec;
+        number = number * 8 + field[index++] - '0';
+    }
 
-        //Execute comparison.
-        compExec = execvp("./comp.out", argsComp);
+    return number;
+}
 
-        //Check if execution worked.
-        if (compExec == -1) {
+void PlanAffinity(Options *options) {
 
-            perror("Error: execution failed.\n");
-            exit(1);
-        }
+    //Variable declarations.
+    char      path[MAX_SIZE];
+    int       cpus[CPU_SETSIZE];
+    int       nodes[CPU_SETSIZE];
+    int       nodeFree[MAX_NODES];
+    int       count = 0;
+    int       slots = options->workers > 0 ? options->workers : 1;
+    int       slot;
+    int       cpu;
+    int       index;
+    int       best;
+    int       pass;
+    cpu_set_t allowed;
+    cpu_set_t taken;
+    cpu_set_t execCpus;
+    cpu_set_t siblings;
+    cpu_set_t nodeCpus;
+
+    //Check which cores the grader may use.
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) < 0) {
+
+        perror("Error: sched_getaffinity failed.\n");
+        options->isAffinity = 0;
+        return;
+    }
 
-    } else {
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
 
-        //Wait for child process to finish.
-        WaitForChildExec(&student->status.compareStatus);
+        if (CPU_ISSET(cpu, &allowed)) {
 
-        return WEXITSTATUS(student->status.compareStatus);
+            cpus[count]    = cpu;
+            nodes[count++] = CpuNode(cpu);
+        }
     }
-}
 
-int WaitForChildExec(int *status) {
+    //Check that a core is left for compiling after every slot got one.
+    if (count <= slots) {
 
-    //Variable declarations.
-    int waitVal;
+        fprintf(stderr, "Warning: %d cores are too few for %d execution "
+                        "slots and the compile jobs, running unpinned.\n",
+                count, slots);
+        options->isAffinity = 0;
+        return;
+    }
 
-    waitVal = wait(status);
+    options->cpuSlots = (CpuSlot *) malloc(slots * sizeof(CpuSlot));
 
-    if (waitVal == -1) {
+    //Check if allocation worked.
+    if (options->cpuSlots == 0) {
 
-        perror("Error: wait failed.\n");
+        perror("Error: malloc failed.\n");
         exit(1);
     }
 
-    //Check status.
-    if (WIFEXITED(*status)) {
+    CPU_ZERO(&taken);
+    CPU_ZERO(&execCpus);
 
-        //Check if execution succeeded.
-        if (WEXITSTATUS(*status) == 1) {
+    for (slot = 0; slot < slots; slot++) {
 
-            return 0;
+        //Count the cores every node still has free.
+        memset(nodeFree, 0, sizeof(nodeFree));
+
+        for (index = 0; index < count; index++) {
+
+            if (!CPU_ISSET(cpus[index], &taken)) {
+
+                nodeFree[nodes[index]]++;
+            }
         }
 
-        return 1;
-    }
-}
+        best = -1;
 
-void WriteStudentResult(Student *student) {
+        //Take a core of the freest node, sharing a hyper-threaded core only
+        //if there is no other choice.
+        for (pass = 0; pass < 2 && best < 0; pass++) {
 
-    //Variable declarations.
-    int  results;
-    int  closeValue;
-    char resultToWrite[MAX_SIZE];
+            for (index = 0; index < count; index++) {
 
-    //Open results file.
-    results = open("results.csv", O_APPEND | O_WRONLY, 777);
+                if (CPU_ISSET(cpus[index], pass == 0 ? &taken : &execCpus)) {
+                    continue;
+                }
 
-    //Check if results file was opened.
-    if (results < 0) {
+                if (best < 0 ||
+                    nodeFree[nodes[index]] >= nodeFree[nodes[best]]) {
 
-        perror("Error: failed to open file.\n");
-        exit(1);
-    }
+                    best = index;
+                }
+            }
+        }
 
-    //Check that the grade is not less a negative number.
-    if (student->result.grade < 0) {
+        options->cpuSlots[slot].execCpu = cpus[best];
+        options->cpuSlots[slot].node    = nodes[best];
+        CPU_SET(cpus[best], &execCpus);
+        CPU_SET(cpus[best], &taken);
 
-        student->result.grade = 0;
+        //The core's other hyper-threads are left idle too.
+        sprintf(path, CPU_SYSFS_PATH "/cpu%d/topology/thread_siblings_list",
+                cpus[best]);
+        ReadCpuList(path, &siblings);
+        CPU_OR(&taken, &taken, &siblings);
     }
 
-    //Create student result.
-    sprintf(resultToWrite, "%s,%d%s\n", student->name, student->result.grade,
-            student->result.feedback);
+    //Compile on the free cores, or next to the hyper-threads if none are.
+    CPU_XOR(&options->compilePool, &allowed, &taken);
+    CPU_AND(&options->compilePool, &options->compilePool, &allowed);
 
-    //Write result to file.
-    WriteToFile(results, resultToWrite);
+    if (CPU_COUNT(&options->compilePool) == 0) {
 
-    closeValue = close(results);
+        CPU_XOR(&options->compilePool, &allowed, &execCpus);
+    }
 
-    //Check if file was closed.
-    if (closeValue < 0) {
+    //Every slot compiles on its own node, if the node has cores left for it.
+    for (slot = 0; slot < slots; slot++) {
 
-        perror("Error: failed to close file.\n");
-        exit(1);
-    }
-}
+        CPU_ZERO(&nodeCpus);
 
-int TimeoutHandler(pid_t pid, int *status) {
+        for (index = 0; index < count; index++) {
 
-    //Variable declarations.
-    int counter = 5;
-    int waitResult;
+            if (nodes[index] == options->cpuSlots[slot].node) {
 
-    //Run until time runs out.
-    while (counter != 0) {
+                CPU_SET(cpus[index], &nodeCpus);
+            }
+        }
 
-        waitResult = waitpid(pid, status, WNOHANG);
+        CPU_AND(&options->cpuSlots[slot].compileCpus, &options->compilePool,
+                &nodeCpus);
 
-        //Check if waitpid worked.
-        if (waitResult < 0) {
+        if (CPU_COUNT(&options->cpuSlots[slot].compileCpus) == 0) {
 
-            perror("Error: waitpid failed.\n");
-            exit(1);
+            options->cpuSlots[slot].compileCpus = options->compilePool;
         }
+    }
+}
 
-        //Check if process status was changed.
-        if (waitResult == 0) {
+int CpuNode(int cpu) {
 
-            //Wait for a second.
-            sleep(1);
-            counter--;
+    //Variable declarations.
+    char          path[MAX_SIZE];
+    int           node = 0;
+    DIR           *dir;
+    struct dirent *entry;
 
-        } else {
+    sprintf(path, CPU_SYSFS_PATH "/cpu%d", cpu);
+    dir = opendir(path);
 
-            return 0;
-        }
+    //Check if the system tells the nodes.
+    if (dir == 0) {
+
+        return 0;
     }
 
-    int killResult;
+    while ((entry = readdir(dir)) != 0) {
 
-    //Stop the process due to timeout.
-    killResult = kill(pid, SIGKILL);
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+    }
 
-    //Check if kill worked.
-    if (killResult < 0) {
+    closedir(dir);
 
-        perror("Error: kill failed.\n");
-        exit(1);
+    //Check that the node fits the counts.
+    if (node < 0 || node >= MAX_NODES) {
+
+        return 0;
     }
 
-    return 1;
+    return node;
 }
 
-Student *InitStudent(struct dirent *studentDirent, char *dirPath) {
+void ReadCpuList(char *path, cpu_set_t *cpus) {
 
     //Variable declarations.
-    Student *student;
+    char    list[LINE_SIZE];
+    char    *position;
+    char    *end;
+    int     listFile;
+    long    first;
+    long    last;
+    ssize_t readNum;
 
-    student = (Student *) malloc(sizeof(Student));
+    CPU_ZERO(cpus);
+    listFile = open(path, O_RDONLY | O_CLOEXEC);
 
-    //Check if allocation worked.
-    if (student == 0) {
+    //Check if the list is there.
+    if (listFile < 0) {
 
-        perror("Error: malloc failed.\n");
-        exit(1);
+        return;
     }
 
-    //Initialize student members.
-    student->dirent   = studentDirent;
-    student->name     = studentDirent->d_name;
-    student->homePath = dirPath;
-    student->depth    = -1;
-    strcpy(student->result.feedback, "\0");
-    student->isMultipleDirectories = 0;
-    student->isTimeOut             = 0;
-
-    return student;
-}
+    readNum = read(listFile, list, LINE_SIZE - 1);
+    close(listFile);
 
-void FreeStudent(Student *student) {
+    if (readNum <= 0) {
 
-    free(student->cFilePath);
-    free(student);
-}
+        return;
+    }
 
-void HandleCompilationError(Student *student) {
+    list[readNum] = '\0';
+    position      = list;
 
-    //Set student's grade tp 0.
-    student->result.grade = 0;
-    strcat(student->result.feedback, ",COMPILATION_ERROR");
-    WriteStudentResult(student);
-    FreeStudent(student);
-}
+    //Every item is a cpu or a range of cpus.
+    while (1) {
 
-void HandleTimeout(Student *student) {
+        first = strtol(position, &end, 10);
 
-    //Variable declarations.
-    int unlinkResult;
+        //Check if the list ended.
+        if (end == position) {
+            break;
+        }
 
-    //Set student's grade tp 0.
-    student->result.grade = 0;
-    strcat(student->result.feedback, ",TIMEOUT");
-    WriteStudentResult(student);
-    FreeStudent(student);
+        last = first;
 
-    //Unlink student's output file.
-    unlinkResult = unlink("studentOutput.txt");
+        if (*end == '-') {
 
-    //Check if unlinked file.
-    if (unlinkResult < 0) {
+            position = end + 1;
+            last     = strtol(position, &end, 10);
+        }
 
-        perror("Error: failed to unlink file.\n");
-        exit(1);
-    }
-}
+        for (; first <= last && first < CPU_SETSIZE; first++) {
 
-void HandleComparisonResult(Student *student, int compareResult) {
+            if (first >= 0) {
 
-    switch (compareResult) {
+                CPU_SET((int) first, cpus);
+            }
+        }
 
-        case 1:
-            strcat(student->result.feedback, ",GREAT_JOB");
+        if (*end != ',') {
             break;
+        }
 
-        case 2:
-            //Set student's grade grade - 30.
-            student->result.grade -= 30;
-            strcat(student->result.feedback, ",SIMILLAR_OUTPUT");
-            break;
+        position = end + 1;
+    }
+}
 
-        case 3:
-            //Set student's grade tp 0.
-            student->result.grade = 0;
-            strcat(student->result.feedback, ",BAD_OUTPUT");
-            break;
+void PinProcess(cpu_set_t *cpus) {
 
-        default:
-            break;
-    }
+    //Check if the system allows the cores, a pinned grader is only faster.
+    if (sched_setaffinity(0, sizeof(cpu_set_t), cpus) < 0) {
 
-    //Check C file's depth.
-    if (student->depth > 0) {
-        strcat(student->result.feedback, ",WRONG_DIRECTORY");
+        fprintf(stderr, "Warning: failed to pin to the cores: %s.\n",
+                strerror(errno));
     }
 }
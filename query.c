@@ -0,0 +1,474 @@
+/******************************************
+* Student name: Danny Perov
+* Student ID: 318810637
+* Course Exercise Group: 05
+* Exercise name: Exercise 1
+******************************************/
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "store.h"
+
+#define STAGE_COUNT 3
+#define VERDICT_COUNT 10
+
+//Holds the mapped results store, every column points into the mapping.
+typedef struct {
+
+    //The mapping.
+    char *data;
+
+    //Size of the mapping.
+    size_t size;
+
+    //Amount of students.
+    int rowCount;
+
+    //Offsets of the names in the names column.
+    unsigned int *nameOffsets;
+
+    //The names, each ending with a null byte, sorted.
+    char *names;
+
+    //Grades.
+    signed char *grades;
+
+    //Verdict codes.
+    unsigned char *verdicts;
+
+    //Depths to the C files, -1 if unknown.
+    signed char *depths;
+
+    //Time every stage took in microseconds, -1 if unknown.
+    long long *stageTimes[STAGE_COUNT];
+} Store;
+
+//Holds what the rows must match.
+typedef struct {
+
+    //Verdict code, -1 for any.
+    int verdict;
+
+    //Lowest grade.
+    int minGrade;
+
+    //Highest grade.
+    int maxGrade;
+
+    //Slowest stage time in microseconds of a matching row, -1 for any.
+    long long minStageTime;
+
+    //Stage the time applies to.
+    int stage;
+
+    //Boolean print only the amount of matching rows.
+    int isCount;
+
+    //Boolean print the amount of rows of every verdict and their mean grade.
+    int isSummary;
+
+    //Name of the only student to print, 0 for every student.
+    char *name;
+} Query;
+
+/**
+ * function name: OpenStore.
+ * The input: path, store.
+ * The output: void.
+ * The function operation: Maps the results store and checks that every
+ * column is inside the file, and that every name starts and ends inside
+ * the names column.
+*/
+void OpenStore(char *path, Store *store);
+
+/**
+ * function name: FindName.
+ * The input: store, name.
+ * The output: the student's row, -1 if missing.
+ * The function operation: Searches the sorted names column.
+*/
+int FindName(Store *store, char *name);
+
+/**
+ * function name: IsRowMatching.
+ * The input: store, query, row.
+ * The output: 1 if the row matches, else 0.
+ * The function operation: Checks the query's columns on one row, reading
+ * only the columns the query uses.
+*/
+int IsRowMatching(Store *store, Query *query, int row);
+
+/**
+ * function name: PrintRow.
+ * The input: store, row.
+ * The output: void.
+ * The function operation: Prints a row in the results file's order.
+*/
+void PrintRow(Store *store, int row);
+
+/**
+ * function name: ParseVerdict.
+ * The input: verdict name.
+ * The output: verdict code.
+ * The function operation: Finds the code of a verdict, stops the run if
+ * there is no such verdict.
+*/
+int ParseVerdict(char *name);
+
+//Verdict names by code, as in the results file.
+static char *verdictNames[VERDICT_COUNT] = {"UNKNOWN", "GREAT_JOB",
+                                            "SIMILLAR_OUTPUT", "BAD_OUTPUT",
+                                            "COMPILATION_ERROR", "TIMEOUT",
+                                            "OUTPUT_LIMIT", "INTERNAL_ERROR",
+                                            "NO_C_FILE",
+                                            "MULTIPLE_DIRECTORIES"};
+
+int main(int argc, char *argv[]) {
+
+    //Variable declarations.
+    static char *stageNames[STAGE_COUNT] = {"compile", "execute", "compare"};
+    Store       store;
+    Query       query;
+    int         index;
+    int         row;
+    int         matches = 0;
+    int         verdictRows[VERDICT_COUNT]   = {0};
+    long long   verdictGrades[VERDICT_COUNT] = {0};
+
+    //Check that the store was given.
+    if (argc < 2) {
+
+        fprintf(stderr, "Usage: %s results.col [--verdict NAME] "
+                        "[--min-grade N] [--max-grade N] "
+                        "[--slower-than MS --stage compile|execute|compare] "
+                        "[--name NAME] [--count] [--summary]\n", argv[0]);
+        exit(1);
+    }
+
+    query.verdict      = -1;
+    query.minGrade     = 0;
+    query.maxGrade     = 100;
+    query.minStageTime = -1;
+    query.stage        = 1;
+    query.isCount      = 0;
+    query.isSummary    = 0;
+    query.name         = 0;
+
+    for (index = 2; index < argc; index++) {
+
+        if (strcmp(argv[index], "--verdict") == 0 && index + 1 < argc) {
+
+            query.verdict = ParseVerdict(argv[++index]);
+
+        } else if (strcmp(argv[index], "--min-grade") == 0 &&
+                   index + 1 < argc) {
+
+            query.minGrade = atoi(argv[++index]);
+
+        } else if (strcmp(argv[index], "--max-grade") == 0 &&
+                   index + 1 < argc) {
+
+            query.maxGrade = atoi(argv[++index]);
+
+        } else if (strcmp(argv[index], "--slower-than") == 0 &&
+                   index + 1 < argc) {
+
+            query.minStageTime = atoll(argv[++index]) * 1000;
+
+        } else if (strcmp(argv[index], "--stage") == 0 && index + 1 < argc) {
+
+            index++;
+
+            for (query.stage = 0; query.stage < STAGE_COUNT; query.stage++) {
+
+                if (strcmp(argv[index], stageNames[query.stage]) == 0) {
+                    break;
+                }
+            }
+
+            //Check that the stage is known.
+            if (query.stage == STAGE_COUNT) {
+
+                fprintf(stderr, "Error: unknown stage %s.\n", argv[index]);
+                exit(1);
+            }
+
+        } else if (strcmp(argv[index], "--name") == 0 && index + 1 < argc) {
+
+            query.name = argv[++index];
+
+        } else if (strcmp(argv[index], "--count") == 0) {
+
+            query.isCount = 1;
+
+        } else if (strcmp(argv[index], "--summary") == 0) {
+
+            query.isSummary = 1;
+
+        } else {
+
+            fprintf(stderr, "Error: unknown parameter %s.\n", argv[index]);
+            exit(1);
+        }
+    }
+
+    OpenStore(argv[1], &store);
+
+    //A name is found by a binary search, the rest by scanning the columns.
+    if (query.name != 0) {
+
+        row = FindName(&store, query.name);
+
+        if (row >= 0 && IsRowMatching(&store, &query, row)) {
+
+            PrintRow(&store, row);
+            matches++;
+        }
+
+    } else {
+
+        for (row = 0; row < store.rowCount; row++) {
+
+            if (!IsRowMatching(&store, &query, row)) {
+                continue;
+            }
+
+            matches++;
+
+            //Check if only the totals are wanted.
+            if (query.isCount) {
+                continue;
+            }
+
+            if (query.isSummary) {
+
+                verdictRows[store.verdicts[row] % VERDICT_COUNT]++;
+                verdictGrades[store.verdicts[row] % VERDICT_COUNT] +=
+                        store.grades[row];
+                continue;
+            }
+
+            PrintRow(&store, row);
+        }
+    }
+
+    if (query.isCount) {
+
+        printf("%d\n", matches);
+
+    } else if (query.isSummary) {
+
+        for (index = 0; index < VERDICT_COUNT; index++) {
+
+            if (verdictRows[index] == 0) {
+                continue;
+            }
+
+            printf("%s,%d,%.1f\n", verdictNames[index], verdictRows[index],
+                   (double) verdictGrades[index] / verdictRows[index]);
+        }
+    }
+
+    munmap(store.data, store.size);
+
+    return 0;
+}
+
+void OpenStore(char *path, Store *store) {
+
+    //Variable declarations.
+    int                storeFile;
+    int                column;
+    int                row;
+    unsigned long long sizes[COLUMN_COUNT];
+    StoreHeader        *header;
+    struct stat        storeStat;
+
+    storeFile = open(path, O_RDONLY);
+
+    //Check if the store was opened.
+    if (storeFile < 0) {
+
+        perror("Error: failed to open file.\n");
+        exit(1);
+    }
+
+    //Check the store's size.
+    if (fstat(storeFile, &storeStat) < 0) {
+
+        perror("Error: failed to stat file.\n");
+        exit(1);
+    }
+
+    //Check that the store has a header.
+    if ((size_t) storeStat.st_size < sizeof(StoreHeader)) {
+
+        fprintf(stderr, "Error: %s is not a results store.\n", path);
+        exit(1);
+    }
+
+    store->size = (size_t) storeStat.st_size;
+    store->data = (char *) mmap(0, store->size, PROT_READ, MAP_SHARED,
+                                storeFile, 0);
+
+    //Check if the store was mapped.
+    if (store->data == MAP_FAILED) {
+
+        perror("Error: mmap failed.\n");
+        exit(1);
+    }
+
+    close(storeFile);
+    header = (StoreHeader *) store->data;
+
+    //Check that the file is a store of this version.
+    if (memcmp(header->magic, STORE_MAGIC, sizeof(header->magic)) != 0) {
+
+        fprintf(stderr, "Error: %s is not a results store.\n", path);
+        exit(1);
+    }
+
+    store->rowCount = (int) header->rowCount;
+
+    sizes[COLUMN_NAME_OFFSETS] = header->rowCount * sizeof(unsigned int);
+    sizes[COLUMN_NAMES]        = header->namesSize;
+    sizes[COLUMN_GRADES]       = header->rowCount;
+    sizes[COLUMN_VERDICTS]     = header->rowCount;
+    sizes[COLUMN_DEPTHS]       = header->rowCount;
+
+    for (column = COLUMN_COMPILE_TIMES; column < COLUMN_COUNT; column++) {
+
+        sizes[column] = header->rowCount * sizeof(long long);
+    }
+
+    for (column = 0; column < COLUMN_COUNT; column++) {
+
+        //Check that the column is inside the file.
+        if (header->columns[column] > store->size ||
+            sizes[column] > store->size - header->columns[column]) {
+
+            fprintf(stderr, "Error: %s is cut short.\n", path);
+            exit(1);
+        }
+    }
+
+    store->nameOffsets = (unsigned int *)
+            (store->data + header->columns[COLUMN_NAME_OFFSETS]);
+    store->names       = store->data + header->columns[COLUMN_NAMES];
+    store->grades      = (signed char *)
+            (store->data + header->columns[COLUMN_GRADES]);
+    store->verdicts    = (unsigned char *)
+            (store->data + header->columns[COLUMN_VERDICTS]);
+    store->depths      = (signed char *)
+            (store->data + header->columns[COLUMN_DEPTHS]);
+
+    for (column = 0; column < STAGE_COUNT; column++) {
+
+        store->stageTimes[column] = (long long *)
+                (store->data + header->columns[COLUMN_COMPILE_TIMES + column]);
+    }
+
+    //Check that the last name ends inside the names column.
+    if (store->rowCount > 0 && (header->namesSize == 0 ||
+                                store->names[header->namesSize - 1] != '\0')) {
+
+        fprintf(stderr, "Error: %s has broken names.\n", path);
+        exit(1);
+    }
+
+    for (row = 0; row < store->rowCount; row++) {
+
+        //Check that the name starts inside the names column.
+        if (store->nameOffsets[row] >= header->namesSize) {
+
+            fprintf(stderr, "Error: %s has broken names.\n", path);
+            exit(1);
+        }
+    }
+}
+
+int FindName(Store *store, char *name) {
+
+    //Variable declarations.
+    int low  = 0;
+    int high = store->rowCount - 1;
+    int middle;
+    int order;
+
+    while (low <= high) {
+
+        middle = low + (high - low) / 2;
+        order  = strcmp(name, store->names + store->nameOffsets[middle]);
+
+        if (order == 0) {
+
+            return middle;
+        }
+
+        if (order < 0) {
+
+            high = middle - 1;
+
+        } else {
+
+            low = middle + 1;
+        }
+    }
+
+    return -1;
+}
+
+int IsRowMatching(Store *store, Query *query, int row) {
+
+    //Check the narrow columns first, they are the cheapest to scan.
+    if (query->verdict >= 0 && store->verdicts[row] != query->verdict) {
+
+        return 0;
+    }
+
+    if (store->grades[row] < query->minGrade ||
+        store->grades[row] > query->maxGrade) {
+
+        return 0;
+    }
+
+    if (query->minStageTime >= 0 &&
+        store->stageTimes[query->stage][row] < query->minStageTime) {
+
+        return 0;
+    }
+
+    return 1;
+}
+
+void PrintRow(Store *store, int row) {
+
+    printf("%s,%d,%s,%d,%lld,%lld,%lld\n",
+           store->names + store->nameOffsets[row], store->grades[row],
+           verdictNames[store->verdicts[row] % VERDICT_COUNT],
+           store->depths[row], store->stageTimes[0][row],
+           store->stageTimes[1][row], store->stageTimes[2][row]);
+}
+
+int ParseVerdict(char *name) {
+
+    //Variable declarations.
+    int verdict;
+
+    for (verdict = 0; verdict < VERDICT_COUNT; verdict++) {
+
+        if (strcmp(name, verdictNames[verdict]) == 0) {
+
+            return verdict;
+        }
+    }
+
+    fprintf(stderr, "Error: unknown verdict %s.\n", name);
+    exit(1);
+}
@@ -0,0 +1,42 @@
+/******************************************
+* Student name: Danny Perov
+* Student ID: 318810637
+* Course Exercise Group: 05
+* Exercise name: Exercise 1
+******************************************/
+
+#ifndef STORE_H
+#define STORE_H
+
+//The results store's format, written by the grader and read by the query
+//tool. Changing it means changing STORE_MAGIC.
+#define STORE_MAGIC "EX1COLS2"
+
+//Columns of the results store, each one an array with a value per student.
+#define COLUMN_NAME_OFFSETS 0
+#define COLUMN_NAMES 1
+#define COLUMN_GRADES 2
+#define COLUMN_VERDICTS 3
+#define COLUMN_DEPTHS 4
+#define COLUMN_COMPILE_TIMES 5
+#define COLUMN_EXECUTE_TIMES 6
+#define COLUMN_COMPARE_TIMES 7
+#define COLUMN_COUNT 8
+
+//Starts the results store, the columns follow at the given offsets.
+typedef struct {
+
+    //STORE_MAGIC, which holds the format's version.
+    char magic[8];
+
+    //Amount of students.
+    unsigned int rowCount;
+
+    //Size of the names column in bytes.
+    unsigned int namesSize;
+
+    //Offset of every column from the start of the file.
+    unsigned long long columns[COLUMN_COUNT];
+} StoreHeader;
+
+#endif